@@ -0,0 +1,291 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/VmdBatchImportCommandlet.h"
+
+#include "Vmd/MotionDataAsset.h"
+#include "Vmd/VmdMotionImporter.h"
+#include "UeMmdHelper.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/FileManager.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Tasks/Task.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+
+#if WITH_EDITOR
+namespace VmdBatchImportCommandletPrivate
+{
+    /** One source file, decode fields are written by a worker, the rest on game thread */
+    struct FBatchItem
+    {
+        FString FilePath;
+        FString PackageName;
+        FString AssetName;
+        int64 FileSize = 0;
+
+        FVmdMotionImportResult Result;
+        bool bImported = false;
+        bool bSaved = false;
+
+        double DecodeSeconds = 0.0;
+        double ApplySeconds = 0.0;
+        double SaveSeconds = 0.0;
+    };
+
+    /** Characters not allowed in package or object names become '_' */
+    static FString SanitizeName(FString InName)
+    {
+        for (TCHAR& IterChar : InName)
+        {
+            if (FCString::Strchr(INVALID_LONGPACKAGE_CHARACTERS INVALID_OBJECTNAME_CHARACTERS, IterChar))
+            {
+                IterChar = TEXT('_');
+            }
+        }
+        return InName;
+    }
+
+    /** File name turned into an asset name */
+    static FString MakeAssetName(const FString& InFilePath)
+    {
+        return SanitizeName(FPaths::GetBaseFilename(InFilePath));
+    }
+
+    /** Package path of a file, subdirectories below source dir are mirrored below destination path */
+    static FString MakePackagePath(const FString& InFilePath, const FString& InSourceDir, const FString& InDestPath)
+    {
+        /** Trailing slash makes source taken as a directory */
+        FString TstrRelative = InFilePath;
+        FPaths::MakePathRelativeTo(TstrRelative, *(InSourceDir / TEXT("")));
+
+        TArray<FString> TsDirs;
+        FPaths::GetPath(TstrRelative).ParseIntoArray(TsDirs, TEXT("/"));
+
+        FString TstrPath = InDestPath;
+        for (const FString& IterDir : TsDirs)
+        {
+            TstrPath /= SanitizeName(IterDir);
+        }
+        return TstrPath;
+    }
+
+    static void DecodeItem(FBatchItem& InOutItem, bool bInUseCache)
+    {
+        const double TfStart = FPlatformTime::Seconds();
+        InOutItem.bImported = FVmdMotionImporter::ImportFromFile(InOutItem.FilePath, InOutItem.Result, bInUseCache, [](float) { return true; });
+        InOutItem.DecodeSeconds = FPlatformTime::Seconds() - TfStart;
+    }
+
+    /** Load or create the asset of an item, apply its result and save the package */
+    static void ApplyAndSaveItem(FBatchItem& InOutItem)
+    {
+        check(IsInGameThread());
+
+        const double TfApplyStart = FPlatformTime::Seconds();
+        UPackage* TpPackage = FPackageName::DoesPackageExist(InOutItem.PackageName)
+            ? LoadPackage(nullptr, *InOutItem.PackageName, LOAD_None)
+            : CreatePackage(*InOutItem.PackageName);
+        if (!TpPackage)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("UVmdBatchImportCommandlet::ApplyAndSaveItem: Bad package, name=%s"), *InOutItem.PackageName);
+            return;
+        }
+        TpPackage->FullyLoad();
+
+        UMotionDataAsset* TpAsset = FindObject<UMotionDataAsset>(TpPackage, *InOutItem.AssetName);
+        if (!TpAsset)
+        {
+            if (FindObject<UObject>(TpPackage, *InOutItem.AssetName))
+            {
+                UE_LOG(LogMmdHelper, Warning, TEXT("UVmdBatchImportCommandlet::ApplyAndSaveItem: Name used by other class, package=%s"), *InOutItem.PackageName);
+                return;
+            }
+            TpAsset = NewObject<UMotionDataAsset>(TpPackage, *InOutItem.AssetName, RF_Public | RF_Standalone);
+        }
+
+        TpAsset->SetMotionPath(InOutItem.FilePath);
+        TpAsset->ApplyImportResult(MoveTemp(InOutItem.Result));
+        InOutItem.Result.Reset();
+        TpPackage->MarkPackageDirty();
+        InOutItem.ApplySeconds = FPlatformTime::Seconds() - TfApplyStart;
+
+        const double TfSaveStart = FPlatformTime::Seconds();
+        const FString TstrPackageFile = FPackageName::LongPackageNameToFilename(InOutItem.PackageName, FPackageName::GetAssetPackageExtension());
+
+        FSavePackageArgs TsSaveArgs;
+        TsSaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+        TsSaveArgs.SaveFlags = SAVE_NoError;
+        InOutItem.bSaved = UPackage::SavePackage(TpPackage, TpAsset, *TstrPackageFile, TsSaveArgs);
+        InOutItem.SaveSeconds = FPlatformTime::Seconds() - TfSaveStart;
+
+        if (!InOutItem.bSaved)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("UVmdBatchImportCommandlet::ApplyAndSaveItem: Failed save package, file=%s"), *TstrPackageFile);
+        }
+    }
+}
+#endif
+
+UVmdBatchImportCommandlet::UVmdBatchImportCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UVmdBatchImportCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+    using namespace VmdBatchImportCommandletPrivate;
+
+    FString TstrSourceDir;
+    FString TstrDestPath = TEXT("/Game/Motions");
+    if (!FParse::Value(*Params, TEXT("Source="), TstrSourceDir) || !IFileManager::Get().DirectoryExists(*TstrSourceDir))
+    {
+        UE_LOG(LogMmdHelper, Error, TEXT("UVmdBatchImportCommandlet::Main: Bad source dir, usage: -run=VmdBatchImport -Source=<Dir> -Dest=/Game/Motions [-Recursive] [-NoCache] [-Batch=N]"));
+        return 1;
+    }
+    FParse::Value(*Params, TEXT("Dest="), TstrDestPath);
+    TstrDestPath.RemoveFromEnd(TEXT("/"));
+
+    const bool bRecursive = FParse::Param(*Params, TEXT("Recursive"));
+    const bool bUseCache = !FParse::Param(*Params, TEXT("NoCache"));
+
+    /** Files decoded ahead of game thread, bounds memory held by decoded results */
+    int32 TiBatchSize = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads()) * 2;
+    FParse::Value(*Params, TEXT("Batch="), TiBatchSize);
+    TiBatchSize = FMath::Max(1, TiBatchSize);
+
+    TArray<FString> TsFiles;
+    if (bRecursive)
+    {
+        IFileManager::Get().FindFilesRecursive(TsFiles, *TstrSourceDir, TEXT("*.vmd"), true, false);
+    }
+    else
+    {
+        IFileManager::Get().FindFiles(TsFiles, *(TstrSourceDir / TEXT("*.vmd")), true, false);
+        for (FString& IterFile : TsFiles)
+        {
+            IterFile = TstrSourceDir / IterFile;
+        }
+    }
+    TsFiles.Sort();
+
+    /** Package names are checked before any decode, so a bad destination fails early */
+    const FString TstrFullSourceDir = FPaths::ConvertRelativePathToFull(TstrSourceDir);
+    TArray<FBatchItem> TsItems;
+    TsItems.Reserve(TsFiles.Num());
+
+    /** Names that only differ by removed characters or letter case still collide, package names compare case insensitive */
+    TMap<FString, int32> TsPackageItems;
+    TsPackageItems.Reserve(TsFiles.Num());
+    for (const FString& IterFile : TsFiles)
+    {
+        FBatchItem& TrItem = TsItems.AddDefaulted_GetRef();
+        TrItem.FilePath = FPaths::ConvertRelativePathToFull(IterFile);
+        TrItem.AssetName = MakeAssetName(IterFile);
+        TrItem.PackageName = MakePackagePath(TrItem.FilePath, TstrFullSourceDir, TstrDestPath) / TrItem.AssetName;
+        TrItem.FileSize = IFileManager::Get().FileSize(*TrItem.FilePath);
+
+        FText TsReason;
+        if (!FPackageName::IsValidLongPackageName(TrItem.PackageName, false, &TsReason))
+        {
+            UE_LOG(LogMmdHelper, Error, TEXT("UVmdBatchImportCommandlet::Main: Bad package name, name=%s reason=%s"), *TrItem.PackageName, *TsReason.ToString());
+            return 1;
+        }
+
+        if (const int32* TpOtherIndex = TsPackageItems.Find(TrItem.PackageName))
+        {
+            UE_LOG(LogMmdHelper, Error, TEXT("UVmdBatchImportCommandlet::Main: Duplicate package name, name=%s first=%s second=%s"),
+                *TrItem.PackageName,
+                *TsItems[*TpOtherIndex].FilePath,
+                *TrItem.FilePath
+            );
+            return 1;
+        }
+        TsPackageItems.Add(TrItem.PackageName, TsItems.Num() - 1);
+    }
+
+    UE_LOG(LogMmdHelper, Display, TEXT("UVmdBatchImportCommandlet::Main: Import, files=%d source=%s dest=%s batch=%d cache=%d"),
+        TsItems.Num(), *TstrSourceDir, *TstrDestPath, TiBatchSize, bUseCache ? 1 : 0);
+
+    auto LaunchDecode = [&TsItems, bUseCache](int32 InBegin, int32 InEnd)
+        {
+            return UE::Tasks::Launch(UE_SOURCE_LOCATION, [&TsItems, bUseCache, InBegin, InEnd]()
+                {
+                    ParallelFor(InEnd - InBegin, [&](int32 InIndex)
+                        {
+                            DecodeItem(TsItems[InBegin + InIndex], bUseCache);
+                        }, EParallelForFlags::Unbalanced);
+                });
+        };
+
+    /** Next batch is decoded by workers while game thread applies and saves the current one */
+    const double TfStart = FPlatformTime::Seconds();
+    UE::Tasks::FTask TsDecodeTask = LaunchDecode(0, FMath::Min(TiBatchSize, TsItems.Num()));
+    for (int32 TiBegin = 0; TiBegin < TsItems.Num(); TiBegin += TiBatchSize)
+    {
+        const int32 TiEnd = FMath::Min(TiBegin + TiBatchSize, TsItems.Num());
+        TsDecodeTask.Wait();
+        if (TiEnd < TsItems.Num())
+        {
+            TsDecodeTask = LaunchDecode(TiEnd, FMath::Min(TiEnd + TiBatchSize, TsItems.Num()));
+        }
+
+        for (int32 Idx = TiBegin; Idx < TiEnd; ++Idx)
+        {
+            FBatchItem& TrItem = TsItems[Idx];
+            if (!TrItem.bImported)
+            {
+                UE_LOG(LogMmdHelper, Warning, TEXT("UVmdBatchImportCommandlet::Main: Bad vmd file, path=%s"), *TrItem.FilePath);
+                continue;
+            }
+            ApplyAndSaveItem(TrItem);
+        }
+    }
+    const double TfWallSeconds = FPlatformTime::Seconds() - TfStart;
+
+    /** Summary */
+    int32 TiSavedNum = 0;
+    int64 TiTotalBytes = 0;
+    double TfDecodeSum = 0.0;
+    double TfGameThreadSum = 0.0;
+    for (const FBatchItem& IterItem : TsItems)
+    {
+        UE_LOG(LogMmdHelper, Display, TEXT("  %-8s decode=%8.2f ms apply=%8.2f ms save=%8.2f ms size=%8lld KB %s"),
+            IterItem.bSaved ? TEXT("Ok") : (IterItem.bImported ? TEXT("NotSaved") : TEXT("Failed")),
+            IterItem.DecodeSeconds * 1000.0,
+            IterItem.ApplySeconds * 1000.0,
+            IterItem.SaveSeconds * 1000.0,
+            IterItem.FileSize / 1024,
+            *IterItem.FilePath
+        );
+
+        TiSavedNum += IterItem.bSaved ? 1 : 0;
+        TiTotalBytes += IterItem.FileSize;
+        TfDecodeSum += IterItem.DecodeSeconds;
+        TfGameThreadSum += IterItem.ApplySeconds + IterItem.SaveSeconds;
+    }
+
+    const double TfSafeWall = FMath::Max(TfWallSeconds, UE_DOUBLE_SMALL_NUMBER);
+    UE_LOG(LogMmdHelper, Display, TEXT("UVmdBatchImportCommandlet::Main: Done, saved=%d failed=%d wall=%.2f s decodeSum=%.2f s gameThreadSum=%.2f s throughput=%.2f MB/s %.2f files/s"),
+        TiSavedNum,
+        TsItems.Num() - TiSavedNum,
+        TfWallSeconds,
+        TfDecodeSum,
+        TfGameThreadSum,
+        TiTotalBytes / (1024.0 * 1024.0) / TfSafeWall,
+        TsItems.Num() / TfSafeWall
+    );
+
+    return TiSavedNum == TsItems.Num() ? 0 : 1;
+#else
+    UE_LOG(LogMmdHelper, Error, TEXT("UVmdBatchImportCommandlet::Main: Saving packages needs an editor build"));
+    return 1;
+#endif
+}
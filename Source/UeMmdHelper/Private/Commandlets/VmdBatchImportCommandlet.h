@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VmdBatchImportCommandlet.generated.h"
+
+/**
+ * Import every vmd file of a directory into motion data assets, creating or updating them
+ * Files are decoded on worker threads, assets are applied and saved on game thread
+ * With -Recursive, subdirectories of source are mirrored below destination, files that would share a package fail the run before import
+ *
+ * Usage:
+ *  UnrealEditor-Cmd <Project> -run=VmdBatchImport -Source=<Dir> -Dest=/Game/Motions [-Recursive] [-NoCache] [-Batch=N] -nullrhi
+ */
+UCLASS()
+class UVmdBatchImportCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UVmdBatchImportCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
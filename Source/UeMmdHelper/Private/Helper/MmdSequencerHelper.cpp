@@ -3,11 +3,22 @@
 #include "MmdSequencerHelper.h"
 
 #include "UeMmdHelper.h"
+#include "Vmd/MotionDataAsset.h"
 #include "LevelSequence.h"
 #include "MovieSceneCommonHelpers.h"
 #include "MovieScene.h"
+#include "VmdCore/VmdCameraMath.h"
+#include "VmdCore/VmdBezier.h"
+#include "Vmd/VmdBezierBatch.h"
+#include "Algo/Transform.h"
 
 
+namespace MmdSequencerHelperPrivate
+{
+    /** Longest segment sampled frame by frame, an hour at 30 fps, longer ones are broken or hand edited keys */
+    static constexpr int64 MaxSampledSpan = 30 * 60 * 60;
+}
+
 FGuid UMmdSequencerHelper::BindActorToLevelSequence(AActor* InActor, class ULevelSequence* InLevelSequence)
 {
     FGuid TsActorBinding;
@@ -95,17 +106,135 @@ FGuid UMmdSequencerHelper::BindComponentToLevelSequence(class UActorComponent* C
     return ComponentBinding;
 }
 
+FGuid UMmdSequencerHelper::FindBindingInLevelSequence(UObject* InObject, ULevelSequence* InLevelSequence)
+{
+    FGuid TsBinding;
+
+#if WITH_EDITOR
+    if (!IsValid(InObject) || !IsValid(InLevelSequence))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("UMmdSequencerHelper::FindBindingInLevelSequence: Bad object or LevelSequence"));
+        return TsBinding;
+    }
+
+    TSharedRef<const UE::MovieScene::FSharedPlaybackState> SharedPlaybackState = MovieSceneHelpers::CreateTransientSharedPlaybackState(InObject, InLevelSequence);
+    TsBinding = InLevelSequence->FindBindingFromObject(InObject, SharedPlaybackState);
+#endif
+    return TsBinding;
+}
+
 FTransform UMmdSequencerHelper::GetConvertedCameraTrans(const FTransform& InBaseTrans, const FVector& InOffset, const FRotator& InRot, const float InDistance)
 {
-    /** Add relative transform on basic */
-    const FVector TsTransformedLoc = InBaseTrans.TransformPosition(InOffset);
-    const FQuat TsTansformedRot = InBaseTrans.TransformRotation(InRot.Quaternion());
+    const FQuat TsBaseRot = InBaseTrans.GetRotation();
+    const FVector TsBaseLoc = InBaseTrans.GetLocation();
+    const FVector TsBaseScale = InBaseTrans.GetScale3D();
+
+    VmdCore::FRigidTransform TsBase;
+    TsBase.Rotation = { TsBaseRot.X, TsBaseRot.Y, TsBaseRot.Z, TsBaseRot.W };
+    TsBase.Translation = { TsBaseLoc.X, TsBaseLoc.Y, TsBaseLoc.Z };
+    TsBase.Scale = { TsBaseScale.X, TsBaseScale.Y, TsBaseScale.Z };
+
+    /** Math is done in VmdCore, so it can be checked without the engine */
+    const VmdCore::FRigidTransform TsResult = VmdCore::ConvertCameraTransform(TsBase,
+        { InOffset.X, InOffset.Y, InOffset.Z },
+        { InRot.Pitch, InRot.Yaw, InRot.Roll },
+        InDistance
+    );
+
+    return FTransform(
+        FQuat(TsResult.Rotation.X, TsResult.Rotation.Y, TsResult.Rotation.Z, TsResult.Rotation.W),
+        FVector(TsResult.Translation.X, TsResult.Translation.Y, TsResult.Translation.Z)
+    );
+}
 
-    /** Move transform on direction */
-    const FVector TfrDirection = TsTansformedRot.Vector();
-    const FVector FinalPosition = TsTransformedLoc + TfrDirection * InDistance;
+void UMmdSequencerHelper::ConvertCameraFrames(TConstArrayView<FVmdCameraFrameData> InFrames, const FTransform& InCenterTrans, const float InDistScaleBias, TArray<FTransform>& OutTransforms)
+{
+    OutTransforms.Reset(InFrames.Num());
+    for (const FVmdCameraFrameData& IterCameraFrame : InFrames)
+    {
+        const FVector TfvCenterOffset = FVector(IterCameraFrame.Location.Z, IterCameraFrame.Location.X, IterCameraFrame.Location.Y) * InDistScaleBias;
+        const FRotator TfrRot = FRotator(-IterCameraFrame.Rotate.X, -IterCameraFrame.Rotate.Y, IterCameraFrame.Rotate.Z);
+        const float TfCameraLen = IterCameraFrame.Length * InDistScaleBias;
 
-    return FTransform(TsTansformedRot, FinalPosition);
+        OutTransforms.Add(GetConvertedCameraTrans(InCenterTrans, TfvCenterOffset, TfrRot, TfCameraLen));
+    }
+}
+
+void UMmdSequencerHelper::SampleCameraFrames(TConstArrayView<FVmdCameraFrameData> InFrames, TArray<FVmdCameraFrameData>& OutFrames, TArray<float>& OutViewAngles)
+{
+    using namespace VmdCore;
+    using namespace MmdSequencerHelperPrivate;
+
+    /** Spans in 64 bit, frames are unsigned and may be out of order or far apart */
+    auto GetSpan = [&InFrames](int32 InIndex) { return InIndex > 0 ? (int64)InFrames[InIndex].Frame - (int64)InFrames[InIndex - 1].Frame : 0; };
+
+    int64 TiSampleNum = InFrames.Num();
+    for (int32 Idx = 1; Idx < InFrames.Num(); ++Idx)
+    {
+        const int64 TiSpan = GetSpan(Idx);
+        if (TiSpan > MaxSampledSpan || TiSpan < 0)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("UMmdSequencerHelper::SampleCameraFrames: Bad segment span, keys joined without easing, begin=%u end=%u limit=%lld"),
+                InFrames[Idx - 1].Frame,
+                InFrames[Idx].Frame,
+                MaxSampledSpan
+            );
+        }
+        else if (TiSpan > 1)
+        {
+            TiSampleNum += TiSpan - 1;
+        }
+    }
+
+    if (TiSampleNum > MAX_int32)
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("UMmdSequencerHelper::SampleCameraFrames: Too many samples, keys kept without easing, samples=%lld"), TiSampleNum);
+        OutFrames.Reset();
+        OutFrames.Append(InFrames.GetData(), InFrames.Num());
+        OutViewAngles.Reset();
+        Algo::Transform(InFrames, OutViewAngles, [](const FVmdCameraFrameData& InFrame) { return (float)InFrame.ViewingAngle; });
+        return;
+    }
+
+    OutFrames.Reset((int32)TiSampleNum);
+    OutViewAngles.Reset((int32)TiSampleNum);
+
+    /** All six channels of a segment are eased at the same progress, so they are solved together, the batch is refilled per segment */
+    FVmdBezierBatch TsCurves;
+    float TsEased[(int32)ECameraCurve::Num];
+    auto Ease = [&TsEased](ECameraCurve InChannel) { return (double)TsEased[(int32)InChannel]; };
+
+    for (int32 Idx = 0; Idx < InFrames.Num(); ++Idx)
+    {
+        const FVmdCameraFrameData& TrEnd = InFrames[Idx];
+        const int32 TiSpan = (int32)FMath::Clamp<int64>(GetSpan(Idx), 0, MaxSampledSpan + 1);
+
+        /** Keys one frame apart are a cut, nothing is eased between them */
+        if (TiSpan > 1 && TiSpan <= MaxSampledSpan)
+        {
+            const FVmdCameraFrameData& TrBegin = InFrames[Idx - 1];
+
+            TsCurves.Reset((int32)ECameraCurve::Num);
+            TsCurves.AddCameraCurves(TrEnd.Interpolation);
+
+            for (int32 Step = 1; Step < TiSpan; ++Step)
+            {
+                TsCurves.Evaluate((float)Step / TiSpan, TsEased);
+
+                FVmdCameraFrameData& TrSample = OutFrames.Add_GetRef(TrBegin);
+                TrSample.Frame = TrBegin.Frame + Step;
+                TrSample.Location.X = FMath::Lerp(TrBegin.Location.X, TrEnd.Location.X, Ease(ECameraCurve::X));
+                TrSample.Location.Y = FMath::Lerp(TrBegin.Location.Y, TrEnd.Location.Y, Ease(ECameraCurve::Y));
+                TrSample.Location.Z = FMath::Lerp(TrBegin.Location.Z, TrEnd.Location.Z, Ease(ECameraCurve::Z));
+                TrSample.Rotate = FMath::Lerp(TrBegin.Rotate, TrEnd.Rotate, Ease(ECameraCurve::Rotation));
+                TrSample.Length = (float)FMath::Lerp((double)TrBegin.Length, (double)TrEnd.Length, Ease(ECameraCurve::Distance));
+                OutViewAngles.Add((float)FMath::Lerp((double)TrBegin.ViewingAngle, (double)TrEnd.ViewingAngle, Ease(ECameraCurve::ViewAngle)));
+            }
+        }
+
+        OutFrames.Add(TrEnd);
+        OutViewAngles.Add((float)TrEnd.ViewingAngle);
+    }
 }
 
 ECameraProjectionMode::Type UMmdSequencerHelper::ConvertFromVmdCameraPerspective(const uint8 InVal)
@@ -20,9 +20,22 @@ public:
     static FGuid BindActorToLevelSequence(class AActor* InActor, class ULevelSequence* InLevelSequence);
     static FGuid BindComponentToLevelSequence(class UActorComponent* InComponent, class ULevelSequence* InLevelSequence);
 
+    /** Existing binding of an actor or component, invalid guid if it is not bound, nothing is added to the sequence */
+    static FGuid FindBindingInLevelSequence(class UObject* InObject, class ULevelSequence* InLevelSequence);
+
     /** Convert track camera transforms from frame data */
     static FTransform GetConvertedCameraTrans(const FTransform& InBaseTrans, const FVector& InOffset, const FRotator& InRot, const float InDistance);
 
+    /** Camera transform of each vmd camera frame, in frame order */
+    static void ConvertCameraFrames(TConstArrayView<struct FVmdCameraFrameData> InFrames, const FTransform& InCenterTrans, const float InDistScaleBias, TArray<FTransform>& OutTransforms);
+
+    /**
+     * Camera state at every whole frame from first to last key, eased by the interpolation curves of each segment like MMD playback
+     * View angle is eased into OutViewAngles, the integer ViewingAngle of samples between keys is not used
+     * Segments over an hour long, or keys out of order, are joined without samples and logged
+     */
+    static void SampleCameraFrames(TConstArrayView<struct FVmdCameraFrameData> InFrames, TArray<struct FVmdCameraFrameData>& OutFrames, TArray<float>& OutViewAngles);
+
     /** Convert projection mode from raw data */
     static ECameraProjectionMode::Type ConvertFromVmdCameraPerspective(const uint8 InVal);
 };
@@ -0,0 +1,910 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/**
+ * Console commands for measuring vmd import performance
+ * Run them in editor console or with `-ExecCmds` in a commandlet
+ *
+ * Stage timings as json on a generated corpus:
+ *  MmdHelper.Bench.Stages Synthetic Bones=200000 Faces=50000 Sjis=0.8 Iterations=20 Json=Saved/VmdBench/Result.json
+ */
+
+#include "UeMmdHelper.h"
+#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdBoneColumns.h"
+#include "Vmd/VmdNameInterner.h"
+#include "Vmd/VmdFileView.h"
+#include "Vmd/VmdMotionImporter.h"
+#include "Vmd/MotionDataAsset.h"
+#include "Helper/MmdSequencerHelper.h"
+#include "Helper/VmdSyntheticGenerator.h"
+#include "Miscs/SjisToUnicode.h"
+#include "VmdCore/VmdBezier.h"
+#include "Vmd/VmdBezierBatch.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Curves/RichCurve.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/ObjectReader.h"
+#include "Serialization/ObjectWriter.h"
+#include "UObject/Package.h"
+
+#if WITH_EDITOR
+#include "Channels/MovieSceneDoubleChannel.h"
+#endif
+
+/** Bench and verify commands and the generator they use are development only */
+#if !UE_BUILD_SHIPPING
+
+
+namespace VmdBenchmark
+{
+    template<typename FrameType>
+    static bool IsSameFrames(const TArray<FrameType>& A, const TArray<FrameType>& B)
+    {
+        /** Both paths zero frames before filling, so padding bytes are comparable */
+        return A.Num() == B.Num() && FMemory::Memcmp(A.GetData(), B.GetData(), A.Num() * sizeof(FrameType)) == 0;
+    }
+
+    static bool IsSameIkFrames(const TArray<FVmdIkFrame>& A, const TArray<FVmdIkFrame>& B)
+    {
+        if (A.Num() != B.Num())
+        {
+            return false;
+        }
+
+        for (int32 Idx = 0; Idx < A.Num(); ++Idx)
+        {
+            if (A[Idx].Frame != B[Idx].Frame || A[Idx].Show != B[Idx].Show || !IsSameFrames(A[Idx].IkInfos, B[Idx].IkInfos))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool IsSameData(const FVmdData& A, const FVmdData& B)
+    {
+        const FVmdBoneTracks& TrTracksA = A.GetTrackData();
+        const FVmdBoneTracks& TrTracksB = B.GetTrackData();
+
+        return FMemory::Memcmp(&A.GetVmdHeader(), &B.GetVmdHeader(), sizeof(FVmdHeader)) == 0
+            && IsSameFrames(TrTracksA.BoneFrames, TrTracksB.BoneFrames)
+            && IsSameFrames(TrTracksA.FaceFrames, TrTracksB.FaceFrames)
+            && IsSameFrames(TrTracksA.CameraFrames, TrTracksB.CameraFrames)
+            && IsSameFrames(TrTracksA.LightFrames, TrTracksB.LightFrames)
+            && IsSameFrames(TrTracksA.SelfShadowFrames, TrTracksB.SelfShadowFrames)
+            && IsSameIkFrames(TrTracksA.IkFrames, TrTracksB.IkFrames);
+    }
+
+    /** Average seconds per run of InFunc */
+    template<typename FuncType>
+    static double TimeRuns(int32 InIterations, FuncType&& InFunc)
+    {
+        const double TfStart = FPlatformTime::Seconds();
+        for (int32 Idx = 0; Idx < InIterations; ++Idx)
+        {
+            InFunc();
+        }
+        return (FPlatformTime::Seconds() - TfStart) / InIterations;
+    }
+
+    static void BenchLoad(const TArray<FString>& InArgs)
+    {
+        if (InArgs.Num() < 1)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchLoad: Usage: MmdHelper.Bench.Load <VmdFile> [Iterations]"));
+            return;
+        }
+
+        const FString& TrFilePath = InArgs[0];
+        const int32 TiIterations = InArgs.Num() > 1 ? FMath::Max(1, FCString::Atoi(*InArgs[1])) : 10;
+
+        /** Check both paths agree before timing them */
+        {
+            FVmdData TsArchiveData;
+            FVmdDataHelper::LoadVmdDataFromFile(TrFilePath, TsArchiveData);
+
+            FVmdFileView TsView;
+            if (!TsView.Open(TrFilePath))
+            {
+                UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchLoad: Bad vmd file, path=%s"), *TrFilePath);
+                return;
+            }
+
+            FVmdData TsViewData;
+            TsViewData.ReadFromView(TsView);
+            if (!IsSameData(TsArchiveData, TsViewData))
+            {
+                UE_LOG(LogMmdHelper, Error, TEXT("VmdBenchmark::BenchLoad: Result mismatch between archive and view, path=%s"), *TrFilePath);
+                return;
+            }
+        }
+
+        const double TfArchiveTime = TimeRuns(TiIterations, [&]()
+            {
+                FVmdData TsData;
+                FVmdDataHelper::LoadVmdDataFromFile(TrFilePath, TsData);
+            });
+
+        const double TfViewCopyTime = TimeRuns(TiIterations, [&]()
+            {
+                FVmdFileView TsView;
+                TsView.Open(TrFilePath);
+
+                FVmdData TsData;
+                TsData.ReadFromView(TsView, false/*bInParallel*/);
+            });
+
+        const double TfViewParallelCopyTime = TimeRuns(TiIterations, [&]()
+            {
+                FVmdFileView TsView;
+                TsView.Open(TrFilePath);
+
+                FVmdData TsData;
+                TsData.ReadFromView(TsView, true/*bInParallel*/);
+            });
+
+        /** What the importer pays: open and touch every record in place */
+        uint64 TiChecksum = 0;
+        const double TfViewInPlaceTime = TimeRuns(TiIterations, [&]()
+            {
+                FVmdFileView TsView;
+                TsView.Open(TrFilePath);
+
+                for (const FVmdRawBoneRecord& IterRecord : TsView.GetBoneFrames())
+                {
+                    TiChecksum += IterRecord.Frame;
+                }
+                for (const FVmdRawFaceRecord& IterRecord : TsView.GetFaceFrames())
+                {
+                    TiChecksum += IterRecord.Frame;
+                }
+                for (const FVmdRawCameraRecord& IterRecord : TsView.GetCameraFrames())
+                {
+                    TiChecksum += IterRecord.Frame;
+                }
+                for (const FVmdRawLightRecord& IterRecord : TsView.GetLightFrames())
+                {
+                    TiChecksum += IterRecord.Frame;
+                }
+                for (const FVmdRawSelfShadowRecord& IterRecord : TsView.GetSelfShadowFrames())
+                {
+                    TiChecksum += IterRecord.Frame;
+                }
+                for (FVmdIkRecordIterator IterRecord = TsView.GetIkFrames(); IterRecord; ++IterRecord)
+                {
+                    TiChecksum += IterRecord.GetRecord().Frame;
+                }
+            });
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchLoad: path=%s iterations=%d checksum=%llu"), *TrFilePath, TiIterations, TiChecksum);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Archive:        %8.3f ms"), TfArchiveTime * 1000.0);
+        UE_LOG(LogMmdHelper, Display, TEXT("  View + copy:    %8.3f ms (x%.2f)"), TfViewCopyTime * 1000.0, TfArchiveTime / FMath::Max(TfViewCopyTime, UE_DOUBLE_SMALL_NUMBER));
+        UE_LOG(LogMmdHelper, Display, TEXT("  View + parallel:%8.3f ms (x%.2f) workers=%d"), TfViewParallelCopyTime * 1000.0, TfArchiveTime / FMath::Max(TfViewParallelCopyTime, UE_DOUBLE_SMALL_NUMBER), FTaskGraphInterface::Get().GetNumWorkerThreads());
+        UE_LOG(LogMmdHelper, Display, TEXT("  View in place:  %8.3f ms (x%.2f)"), TfViewInPlaceTime * 1000.0, TfArchiveTime / FMath::Max(TfViewInPlaceTime, UE_DOUBLE_SMALL_NUMBER));
+    }
+
+    static bool IsSameBoneFrames(const TArray<FVmdBoneFrame>& InFrames, const FVmdBoneFrameColumns& InColumns)
+    {
+        if (InFrames.Num() != InColumns.Num())
+        {
+            return false;
+        }
+
+        for (int32 Idx = 0; Idx < InFrames.Num(); ++Idx)
+        {
+            const FVmdBoneFrame& TrFrame = InFrames[Idx];
+            const FVector3f& TrPosition = InColumns.Positions[Idx];
+            const FQuat4f& TrRotation = InColumns.Rotations[Idx];
+
+            if (TrFrame.Frame != InColumns.Frames[Idx]
+                || TrFrame.Position[0] != TrPosition.X || TrFrame.Position[1] != TrPosition.Y || TrFrame.Position[2] != TrPosition.Z
+                || TrFrame.Quaternion[0] != TrRotation.X || TrFrame.Quaternion[1] != TrRotation.Y
+                || TrFrame.Quaternion[2] != TrRotation.Z || TrFrame.Quaternion[3] != TrRotation.W
+                || FMemory::Memcmp(TrFrame.Bezier, InColumns.GetInterpolation(Idx).GetData(), sizeof(TrFrame.Bezier)) != 0
+                || FVmdDataHelper::ConvertFromMmdName(TrFrame.Name, sizeof(TrFrame.Name)) != InColumns.Names[InColumns.NameIds[Idx]])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static void BenchBoneUnpack(const TArray<FString>& InArgs)
+    {
+        if (InArgs.Num() < 1)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchBoneUnpack: Usage: MmdHelper.Bench.BoneUnpack <VmdFile> [Iterations]"));
+            return;
+        }
+
+        const FString& TrFilePath = InArgs[0];
+        const int32 TiIterations = InArgs.Num() > 1 ? FMath::Max(1, FCString::Atoi(*InArgs[1])) : 10;
+
+        FVmdFileView TsView;
+        if (!TsView.Open(TrFilePath))
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchBoneUnpack: Bad vmd file, path=%s"), *TrFilePath);
+            return;
+        }
+
+        FVmdData TsRowData;
+        FVmdBoneFrameColumns TsColumns;
+        const double TfRowTime = TimeRuns(TiIterations, [&]() { TsRowData.ReadFromView(TsView, false/*bInParallel*/); });
+        const double TfColumnTime = TimeRuns(TiIterations, [&]() { TsColumns.UnpackFrom(TsView.GetBoneFrames(), false/*bInParallel*/); });
+        const double TfParallelColumnTime = TimeRuns(TiIterations, [&]() { TsColumns.UnpackFrom(TsView.GetBoneFrames(), true/*bInParallel*/); });
+
+        if (!IsSameBoneFrames(TsRowData.GetTrackData().BoneFrames, TsColumns))
+        {
+            UE_LOG(LogMmdHelper, Error, TEXT("VmdBenchmark::BenchBoneUnpack: Result mismatch between rows and columns, path=%s"), *TrFilePath);
+            return;
+        }
+
+        /** Single channel sweep, the access pattern of bake stages */
+        FVector3f TsRowSum = FVector3f::ZeroVector;
+        const double TfRowSweepTime = TimeRuns(TiIterations, [&]()
+            {
+                for (const FVmdBoneFrame& IterFrame : TsRowData.GetTrackData().BoneFrames)
+                {
+                    TsRowSum += FVector3f(IterFrame.Position[0], IterFrame.Position[1], IterFrame.Position[2]);
+                }
+            });
+
+        FVector3f TsColumnSum = FVector3f::ZeroVector;
+        const double TfColumnSweepTime = TimeRuns(TiIterations, [&]()
+            {
+                for (const FVector3f& IterPosition : TsColumns.Positions)
+                {
+                    TsColumnSum += IterPosition;
+                }
+            });
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchBoneUnpack: path=%s frames=%d names=%d iterations=%d sum=%s/%s"),
+            *TrFilePath, TsColumns.Num(), TsColumns.Names.Num(), TiIterations, *TsRowSum.ToString(), *TsColumnSum.ToString());
+        UE_LOG(LogMmdHelper, Display, TEXT("  Unpack rows:    %8.3f ms"), TfRowTime * 1000.0);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Unpack columns: %8.3f ms"), TfColumnTime * 1000.0);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Unpack columns parallel: %8.3f ms"), TfParallelColumnTime * 1000.0);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Sweep rows:     %8.3f ms"), TfRowSweepTime * 1000.0);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Sweep columns:  %8.3f ms (x%.2f)"), TfColumnSweepTime * 1000.0, TfRowSweepTime / FMath::Max(TfColumnSweepTime, UE_DOUBLE_SMALL_NUMBER));
+    }
+
+    static void Generate(const TArray<FString>& InArgs)
+    {
+        if (InArgs.Num() < 1)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::Generate: Usage: MmdHelper.Bench.Generate <OutFile> [Bones=N] [BoneNames=N] [Faces=N] [FaceNames=N] [Cameras=N] [Zipf=S] [Sjis=R] [Seed=N] ..."));
+            return;
+        }
+
+        FVmdSyntheticConfig TsConfig;
+        TsConfig.ParseFrom(*FString::Join(InArgs, TEXT(" ")));
+
+        if (!FVmdSyntheticGenerator::GenerateToFile(TsConfig, InArgs[0]))
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::Generate: Failed write file, path=%s"), *InArgs[0]);
+            return;
+        }
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::Generate: path=%s %s"), *InArgs[0], *TsConfig.ToString());
+    }
+
+    /**
+     * Open the file named by first argument
+     * `Synthetic` generates a corpus into Saved from the generator options in arguments, named by its config so repeated runs reuse it
+     */
+    static bool OpenBenchFile(const TArray<FString>& InArgs, FString& OutFilePath, FString& OutConfig, FVmdFileView& OutView)
+    {
+        OutFilePath = InArgs[0];
+        OutConfig.Reset();
+        if (OutFilePath == TEXT("Synthetic"))
+        {
+            FVmdSyntheticConfig TsConfig;
+            TsConfig.ParseFrom(*FString::Join(InArgs, TEXT(" ")));
+            OutConfig = TsConfig.ToString();
+
+            OutFilePath = FPaths::ProjectSavedDir() / TEXT("VmdBench") / FString::Printf(TEXT("Synthetic_%08x.vmd"), GetTypeHash(OutConfig));
+            if (!IFileManager::Get().FileExists(*OutFilePath) && !FVmdSyntheticGenerator::GenerateToFile(TsConfig, OutFilePath))
+            {
+                UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::OpenBenchFile: Failed write synthetic file, path=%s"), *OutFilePath);
+                return false;
+            }
+        }
+
+        return OutView.Open(OutFilePath);
+    }
+
+    struct FStageTiming
+    {
+        const TCHAR* Name;
+        double AvgSeconds;
+        double MinSeconds;
+    };
+
+    /** Min is kept besides average, it is less noisy for tracking trends */
+    template<typename FuncType>
+    static FStageTiming TimeStage(const TCHAR* InName, int32 InIterations, FuncType&& InFunc)
+    {
+        FStageTiming TsTiming = { InName, 0.0, TNumericLimits<double>::Max() };
+        for (int32 Idx = 0; Idx < InIterations; ++Idx)
+        {
+            const double TfStart = FPlatformTime::Seconds();
+            InFunc();
+            const double TfTime = FPlatformTime::Seconds() - TfStart;
+
+            TsTiming.AvgSeconds += TfTime / InIterations;
+            TsTiming.MinSeconds = FMath::Min(TsTiming.MinSeconds, TfTime);
+        }
+        return TsTiming;
+    }
+
+    /** Camera keys of SyncCameraMotion into detached channels, without level sequence */
+    static void AddCameraKeys(TConstArrayView<FVmdCameraFrameData> InFrames, bool bInLinear)
+    {
+        TArray<FTransform> TsTransforms;
+        UMmdSequencerHelper::ConvertCameraFrames(InFrames, FTransform::Identity, 10.0f, TsTransforms);
+
+#if WITH_EDITOR
+        const FFrameRate TsDisplayRate(30, 1);
+        const FFrameRate TsTickResolution(24000, 1);
+
+        FMovieSceneDoubleChannel TsChannels[6];
+        for (int32 FrameIdx = 0; FrameIdx < TsTransforms.Num(); ++FrameIdx)
+        {
+            const FFrameNumber TsCurFrame = FFrameRate::TransformTime(FFrameNumber((int32)InFrames[FrameIdx].Frame), TsDisplayRate, TsTickResolution).GetFrame();
+            const FVector TsLocation = TsTransforms[FrameIdx].GetLocation();
+            const FRotator TfrRot = TsTransforms[FrameIdx].GetRotation().Rotator();
+            const double TsValues[6] = { TsLocation.X, TsLocation.Y, TsLocation.Z, TfrRot.Roll, TfrRot.Pitch, TfrRot.Yaw };
+
+            for (int32 Channel = 0; Channel < 6; ++Channel)
+            {
+                if (bInLinear)
+                {
+                    TsChannels[Channel].AddLinearKey(TsCurFrame, TsValues[Channel]);
+                }
+                else
+                {
+                    TsChannels[Channel].AddCubicKey(TsCurFrame, TsValues[Channel]);
+                }
+            }
+        }
+#endif
+    }
+
+    static void BenchStages(const TArray<FString>& InArgs)
+    {
+        if (InArgs.Num() < 1)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchStages: Usage: MmdHelper.Bench.Stages <VmdFile|Synthetic> [Iterations=N] [Json=OutFile] [generator options]"));
+            return;
+        }
+
+        const FString TstrArgs = FString::Join(InArgs, TEXT(" "));
+        int32 TiIterations = 10;
+        FParse::Value(*TstrArgs, TEXT("Iterations="), TiIterations);
+        TiIterations = FMath::Max(1, TiIterations);
+
+        FString TstrFilePath;
+        FString TstrConfig;
+        FVmdFileView TsView;
+        if (!OpenBenchFile(InArgs, TstrFilePath, TstrConfig, TsView))
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchStages: Bad vmd file, path=%s"), *TstrFilePath);
+            return;
+        }
+
+        TArray<FStageTiming> TsTimings;
+
+        TsTimings.Add(TimeStage(TEXT("FileRead"), TiIterations, [&]()
+            {
+                TArray64<uint8> TsBytes;
+                FFileHelper::LoadFileToArray(TsBytes, *TstrFilePath);
+            }));
+
+        TsTimings.Add(TimeStage(TEXT("Decode"), TiIterations, [&]()
+            {
+                FVmdData TsData;
+                TsData.ReadFromView(TsView);
+            }));
+
+        int32 TiNameChars = 0;
+        TsTimings.Add(TimeStage(TEXT("NameConvert"), TiIterations, [&]()
+            {
+                for (const FVmdRawBoneRecord& IterRecord : TsView.GetBoneFrames())
+                {
+                    TiNameChars += FVmdDataHelper::ConvertFromMmdName(IterRecord.Name, sizeof(IterRecord.Name)).Len();
+                }
+                for (const FVmdRawFaceRecord& IterRecord : TsView.GetFaceFrames())
+                {
+                    TiNameChars += FVmdDataHelper::ConvertFromMmdName(IterRecord.Name, sizeof(IterRecord.Name)).Len();
+                }
+            }));
+
+        /** Same names through one column pass per section, each distinct name decoded once */
+        int32 TiUniqueNames = 0;
+        TsTimings.Add(TimeStage(TEXT("NameColumns"), TiIterations, [&]()
+            {
+                FVmdNameColumn TsNames;
+                TsNames.DecodeFrom(TsView.GetBoneFrames());
+                TiUniqueNames += TsNames.Names.Num();
+                TsNames.DecodeFrom(TsView.GetFaceFrames());
+                TiUniqueNames += TsNames.Names.Num();
+            }));
+
+        /** Stream read, name grouping, filter and sort done by LoadFromVmdFile */
+        FVmdMotionImportResult TsResult;
+        TsTimings.Add(TimeStage(TEXT("Import"), TiIterations, [&]()
+            {
+                FVmdMotionImporter::ImportFromVmd(TstrFilePath, TsResult, [](float) { return true; });
+            }));
+
+        /** Optional key reduction of ApplyImportResult, on copies so later stages see the imported keys */
+        int32 TiReducedKeys = 0;
+        TsTimings.Add(TimeStage(TEXT("MorphReduce"), TiIterations, [&]()
+            {
+                for (const FVmdMorphTrackData& IterTrack : TsResult.MorphTracks)
+                {
+                    FVmdMorphTrackData TsTrack = IterTrack;
+                    TiReducedKeys += TsTrack.ReduceKeys(0.001f);
+                }
+            }));
+
+        /** Curve building of PushMorphToAnimation, without animation data controller */
+        int32 TiMorphKeys = 0;
+        TsTimings.Add(TimeStage(TEXT("MorphCurves"), TiIterations, [&]()
+            {
+                for (int32 TrackIdx = 0; TrackIdx < TsResult.MorphTracks.Num(); ++TrackIdx)
+                {
+                    FRichCurve TsCurve;
+                    UMotionDataAsset::BuildMorphCurve(TsResult.MorphTracks[TrackIdx], 30.0f, TNumericLimits<float>::Max(), false, NAME_None, TsCurve);
+                    TiMorphKeys += TsCurve.GetNumKeys();
+                }
+            }));
+
+        /** Key generation of SyncCameraMotion with the default bBakeInterpolation, eased samples at every frame joined linearly */
+        int32 TiBakedFrames = 0;
+        TsTimings.Add(TimeStage(TEXT("CameraKeys"), TiIterations, [&]()
+            {
+                TArray<FVmdCameraFrameData> TsBakedFrames;
+                TArray<float> TsViewAngles;
+                UMmdSequencerHelper::SampleCameraFrames(TsResult.CameraFrames, TsBakedFrames, TsViewAngles);
+                AddCameraKeys(TsBakedFrames, true/*bInLinear*/);
+                TiBakedFrames += TsBakedFrames.Num();
+            }));
+
+        /** Same without baking, cubic keys on the raw vmd keys */
+        TsTimings.Add(TimeStage(TEXT("CameraKeysRaw"), TiIterations, [&]()
+            {
+                AddCameraKeys(TsResult.CameraFrames, false/*bInLinear*/);
+            }));
+
+        FString TstrJson;
+        TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> TpWriter = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&TstrJson);
+        TpWriter->WriteObjectStart();
+        TpWriter->WriteValue(TEXT("file"), TstrFilePath);
+        TpWriter->WriteValue(TEXT("synthetic"), TstrConfig);
+        TpWriter->WriteValue(TEXT("fileSize"), TsView.GetFileSize());
+        TpWriter->WriteValue(TEXT("iterations"), TiIterations);
+        TpWriter->WriteValue(TEXT("workers"), FTaskGraphInterface::Get().GetNumWorkerThreads());
+
+        TpWriter->WriteObjectStart(TEXT("counts"));
+        TpWriter->WriteValue(TEXT("bone"), TsView.GetBoneFrames().Num());
+        TpWriter->WriteValue(TEXT("face"), TsView.GetFaceFrames().Num());
+        TpWriter->WriteValue(TEXT("camera"), TsView.GetCameraFrames().Num());
+        TpWriter->WriteValue(TEXT("light"), TsView.GetLightFrames().Num());
+        TpWriter->WriteValue(TEXT("selfShadow"), TsView.GetSelfShadowFrames().Num());
+        TpWriter->WriteValue(TEXT("ik"), TsView.GetIkFrameNum());
+        TpWriter->WriteValue(TEXT("cameraBaked"), TiBakedFrames / TiIterations);
+        TpWriter->WriteValue(TEXT("morphTrack"), TsResult.MorphTracks.Num());
+        TpWriter->WriteValue(TEXT("morphKey"), TiMorphKeys / TiIterations);
+        TpWriter->WriteValue(TEXT("morphKeyReduced"), TiReducedKeys / TiIterations);
+        TpWriter->WriteValue(TEXT("nameChar"), TiNameChars / TiIterations);
+        TpWriter->WriteValue(TEXT("uniqueName"), TiUniqueNames / TiIterations);
+        TpWriter->WriteObjectEnd();
+
+        TpWriter->WriteObjectStart(TEXT("stages"));
+        for (const FStageTiming& IterTiming : TsTimings)
+        {
+            TpWriter->WriteObjectStart(IterTiming.Name);
+            TpWriter->WriteValue(TEXT("avgMs"), IterTiming.AvgSeconds * 1000.0);
+            TpWriter->WriteValue(TEXT("minMs"), IterTiming.MinSeconds * 1000.0);
+            TpWriter->WriteObjectEnd();
+        }
+        TpWriter->WriteObjectEnd();
+
+        TpWriter->WriteObjectEnd();
+        TpWriter->Close();
+
+        FString TstrJsonPath;
+        if (FParse::Value(*TstrArgs, TEXT("Json="), TstrJsonPath))
+        {
+            FFileHelper::SaveStringToFile(TstrJson, *TstrJsonPath);
+            UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchStages: Written, json=%s"), *TstrJsonPath);
+        }
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchStages: %s"), *TstrJson);
+    }
+
+    static void BenchSjis(const TArray<FString>& InArgs)
+    {
+        if (InArgs.Num() < 1)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchSjis: Usage: MmdHelper.Bench.Sjis <VmdFile|Synthetic> [Iterations=N] [generator options]"));
+            return;
+        }
+
+        int32 TiIterations = 10;
+        FParse::Value(*FString::Join(InArgs, TEXT(" ")), TEXT("Iterations="), TiIterations);
+        TiIterations = FMath::Max(1, TiIterations);
+
+        FString TstrFilePath;
+        FString TstrConfig;
+        FVmdFileView TsView;
+        if (!OpenBenchFile(InArgs, TstrFilePath, TstrConfig, TsView))
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchSjis: Bad vmd file, path=%s"), *TstrFilePath);
+            return;
+        }
+
+        /** Fixed width name fields of every bone and face record, the reference decoder needs terminated copies */
+        constexpr int32 TiFieldSize = sizeof(FVmdRawBoneRecord::Name);
+        TArray<char> TsFields;
+        for (const FVmdRawBoneRecord& IterRecord : TsView.GetBoneFrames())
+        {
+            TsFields.Append(IterRecord.Name, TiFieldSize);
+            TsFields.Add(0);
+        }
+        for (const FVmdRawFaceRecord& IterRecord : TsView.GetFaceFrames())
+        {
+            TsFields.Append(IterRecord.Name, TiFieldSize);
+            TsFields.Add(0);
+        }
+        const int32 TiNameNum = TsFields.Num() / (TiFieldSize + 1);
+
+        for (int32 Idx = 0; Idx < TiNameNum; ++Idx)
+        {
+            const char* TpName = TsFields.GetData() + Idx * (TiFieldSize + 1);
+            char16_t TsBuffer[TiFieldSize];
+            const std::u16string TsReference = saba::ConvertSjisToU16StringReference(TpName);
+            const size_t TiLen = saba::ConvertSjisToU16Buffer(TpName, TiFieldSize, TsBuffer, TiFieldSize);
+            if (TsReference != saba::ConvertSjisToU16String(TpName) || TsReference != std::u16string(TsBuffer, TiLen))
+            {
+                UE_LOG(LogMmdHelper, Error, TEXT("VmdBenchmark::BenchSjis: Result mismatch, index=%d"), Idx);
+                return;
+            }
+        }
+
+        size_t TiChars = 0;
+        const double TfReferenceTime = TimeRuns(TiIterations, [&]()
+            {
+                for (int32 Idx = 0; Idx < TiNameNum; ++Idx)
+                {
+                    TiChars += saba::ConvertSjisToU16StringReference(TsFields.GetData() + Idx * (TiFieldSize + 1)).size();
+                }
+            });
+
+        const double TfStringTime = TimeRuns(TiIterations, [&]()
+            {
+                for (int32 Idx = 0; Idx < TiNameNum; ++Idx)
+                {
+                    TiChars += saba::ConvertSjisToU16String(TsFields.GetData() + Idx * (TiFieldSize + 1)).size();
+                }
+            });
+
+        const double TfBufferTime = TimeRuns(TiIterations, [&]()
+            {
+                char16_t TsBuffer[TiFieldSize];
+                for (int32 Idx = 0; Idx < TiNameNum; ++Idx)
+                {
+                    TiChars += saba::ConvertSjisToU16Buffer(TsFields.GetData() + Idx * (TiFieldSize + 1), TiFieldSize, TsBuffer, TiFieldSize);
+                }
+            });
+
+        /** Decoded names encoded back into fixed width fields, as a vmd writer would */
+        TArray<char16_t> TsDecoded;
+        TArray<int32> TsDecodedLens;
+        TsDecoded.SetNumUninitialized(TiNameNum * TiFieldSize);
+        TsDecodedLens.SetNumUninitialized(TiNameNum);
+        for (int32 Idx = 0; Idx < TiNameNum; ++Idx)
+        {
+            TsDecodedLens[Idx] = (int32)saba::ConvertSjisToU16Buffer(TsFields.GetData() + Idx * (TiFieldSize + 1), TiFieldSize, TsDecoded.GetData() + Idx * TiFieldSize, TiFieldSize);
+        }
+
+        size_t TiEncodedBytes = 0;
+        const double TfEncodeTime = TimeRuns(TiIterations, [&]()
+            {
+                char TsField[TiFieldSize];
+                for (int32 Idx = 0; Idx < TiNameNum; ++Idx)
+                {
+                    TiEncodedBytes += saba::ConvertU16ToSjisBuffer(TsDecoded.GetData() + Idx * TiFieldSize, TsDecodedLens[Idx], TsField, TiFieldSize).written;
+                }
+            });
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchSjis: path=%s names=%d iterations=%d chars=%llu %s"),
+            *TstrFilePath, TiNameNum, TiIterations, (uint64)TiChars, *TstrConfig);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Two pass string:    %8.3f ms"), TfReferenceTime * 1000.0);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Single pass string: %8.3f ms (x%.2f)"), TfStringTime * 1000.0, TfReferenceTime / FMath::Max(TfStringTime, UE_DOUBLE_SMALL_NUMBER));
+        UE_LOG(LogMmdHelper, Display, TEXT("  Bounded buffer:     %8.3f ms (x%.2f)"), TfBufferTime * 1000.0, TfReferenceTime / FMath::Max(TfBufferTime, UE_DOUBLE_SMALL_NUMBER));
+        UE_LOG(LogMmdHelper, Display, TEXT("  Encode to field:    %8.3f ms (bytes=%llu)"), TfEncodeTime * 1000.0, (uint64)TiEncodedBytes);
+    }
+
+    static void VerifySjisTable()
+    {
+        const uint32 TiChecksum = saba::ComputeSjisTableChecksum();
+        if (!saba::VerifySjisTable())
+        {
+            UE_LOG(LogMmdHelper, Error, TEXT("VmdBenchmark::VerifySjisTable: Table does not match generated checksum or does not round trip, checksum=%08x"), TiChecksum);
+            return;
+        }
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::VerifySjisTable: All byte pairs match and every encoded char decodes back, checksum=%08x"), TiChecksum);
+    }
+
+    static void BenchCompact(const TArray<FString>& InArgs)
+    {
+        if (InArgs.Num() < 1)
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchCompact: Usage: MmdHelper.Bench.Compact <VmdFile|Synthetic> [Iterations=N] [generator options]"));
+            return;
+        }
+
+        int32 TiIterations = 10;
+        FParse::Value(*FString::Join(InArgs, TEXT(" ")), TEXT("Iterations="), TiIterations);
+        TiIterations = FMath::Max(1, TiIterations);
+
+        FString TstrFilePath;
+        FString TstrConfig;
+        FVmdFileView TsView;
+        FVmdMotionImportResult TsResult;
+        if (!OpenBenchFile(InArgs, TstrFilePath, TstrConfig, TsView) || !FVmdMotionImporter::ImportFromVmd(TstrFilePath, TsResult, [](float) { return true; }))
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("VmdBenchmark::BenchCompact: Bad vmd file, path=%s"), *TstrFilePath);
+            return;
+        }
+
+        UMotionDataAsset* TpSource = NewObject<UMotionDataAsset>(GetTransientPackage());
+        TpSource->ApplyImportResult(MoveTemp(TsResult));
+
+        int32 TiMorphKeys = 0;
+        for (const TPair<FString, FVmdMorphTrackData>& IterTrack : TpSource->GetMorphTracks())
+        {
+            TiMorphKeys += IterTrack.Value.Frames.Num();
+        }
+
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchCompact: path=%s iterations=%d morphTracks=%d morphKeys=%d cameraFrames=%d %s"),
+            *TstrFilePath, TiIterations, TpSource->GetMorphTracks().Num(), TiMorphKeys, TpSource->GetCameraFrames().Num(), *TstrConfig);
+
+        for (const bool bCompact : { false, true })
+        {
+            TpSource->SetUseCompactStorage(bCompact);
+
+            TArray<uint8> TsBytes;
+            const double TfSaveTime = TimeRuns(TiIterations, [&]()
+                {
+                    TsBytes.Reset();
+                    FObjectWriter TsWriter(TpSource, TsBytes);
+                });
+
+            UMotionDataAsset* TpLoaded = NewObject<UMotionDataAsset>(GetTransientPackage());
+            const double TfLoadTime = TimeRuns(TiIterations, [&]()
+                {
+                    FObjectReader TsReader(TpLoaded, TsBytes);
+                });
+
+            /** Compact tracks are decoded on first access, timed apart from load */
+            const double TfDecodeStart = FPlatformTime::Seconds();
+            const TMap<FString, FVmdMorphTrackData>& TrLoadedTracks = TpLoaded->GetMorphTracks();
+            const double TfDecodeTime = FPlatformTime::Seconds() - TfDecodeStart;
+
+            bool bSameFrames = TrLoadedTracks.Num() == TpSource->GetMorphTracks().Num() && TpLoaded->GetCameraFrames().Num() == TpSource->GetCameraFrames().Num();
+            float TfMaxFactorError = 0.0f;
+            for (const TPair<FString, FVmdMorphTrackData>& IterTrack : TpSource->GetMorphTracks())
+            {
+                const FVmdMorphTrackData* TpLoadedTrack = TrLoadedTracks.Find(IterTrack.Key);
+                if (!TpLoadedTrack || TpLoadedTrack->Frames.Num() != IterTrack.Value.Frames.Num())
+                {
+                    bSameFrames = false;
+                    continue;
+                }
+
+                for (int32 Idx = 0; Idx < IterTrack.Value.Frames.Num(); ++Idx)
+                {
+                    bSameFrames &= TpLoadedTrack->Frames[Idx].Frame == IterTrack.Value.Frames[Idx].Frame;
+                    TfMaxFactorError = FMath::Max(TfMaxFactorError, FMath::Abs(TpLoadedTrack->Frames[Idx].Factor - IterTrack.Value.Frames[Idx].Factor));
+                }
+            }
+
+            UE_LOG(LogMmdHelper, Display, TEXT("  %-8s bytes=%8d save=%8.3f ms load=%8.3f ms decode=%8.3f ms sameFrames=%d maxFactorError=%g"),
+                bCompact ? TEXT("Compact") : TEXT("Tagged"),
+                TsBytes.Num(),
+                TfSaveTime * 1000.0,
+                TfLoadTime * 1000.0,
+                TfDecodeTime * 1000.0,
+                bSameFrames ? 1 : 0,
+                TfMaxFactorError
+            );
+        }
+    }
+
+    static void BenchBezier(const TArray<FString>& InArgs)
+    {
+        using namespace VmdCore;
+
+        const FString TstrArgs = FString::Join(InArgs, TEXT(" "));
+        int32 TiCurveNum = 1024;
+        int32 TiSampleNum = 256;
+        int32 TiIterations = 10;
+        int32 TiSeed = 1;
+        FParse::Value(*TstrArgs, TEXT("Curves="), TiCurveNum);
+        FParse::Value(*TstrArgs, TEXT("Samples="), TiSampleNum);
+        FParse::Value(*TstrArgs, TEXT("Iterations="), TiIterations);
+        FParse::Value(*TstrArgs, TEXT("Seed="), TiSeed);
+        TiCurveNum = FMath::Max(1, TiCurveNum);
+        TiSampleNum = FMath::Max(1, TiSampleNum);
+        TiIterations = FMath::Max(1, TiIterations);
+
+        /** Random control bytes like the synthetic generator writes, MMD default curve first */
+        FRandomStream TsRandom(TiSeed);
+        TArray<FBezierCurve> TsCurves;
+        TsCurves.Add(MakeBezierCurve(20, 20, 107, 107));
+        while (TsCurves.Num() < TiCurveNum)
+        {
+            TsCurves.Add(MakeBezierCurve(TsRandom.RandRange(0, 127), TsRandom.RandRange(0, 127), TsRandom.RandRange(0, 127), TsRandom.RandRange(0, 127)));
+        }
+
+        TArray<float> TsXs;
+        TsXs.SetNumUninitialized(TiSampleNum);
+        for (float& IterX : TsXs)
+        {
+            IterX = TsRandom.FRand();
+        }
+
+        TArray<FBezierTable> TsTables;
+        TsTables.SetNum(TsCurves.Num());
+        const double TfBuildTime = TimeRuns(TiIterations, [&]()
+            {
+                for (int32 Idx = 0; Idx < TsCurves.Num(); ++Idx)
+                {
+                    TsTables[Idx].Build(TsCurves[Idx]);
+                }
+            });
+
+        double TfMaxNewtonError = 0.0;
+        double TfMaxTableError = 0.0;
+        double TfSumNewtonError = 0.0;
+        double TfSumTableError = 0.0;
+        for (int32 CurveIdx = 0; CurveIdx < TsCurves.Num(); ++CurveIdx)
+        {
+            for (const float IterX : TsXs)
+            {
+                const double TfReference = EvaluateBezierReference(TsCurves[CurveIdx], IterX);
+                const double TfNewtonError = FMath::Abs(EvaluateBezier(TsCurves[CurveIdx], IterX) - TfReference);
+                const double TfTableError = FMath::Abs(TsTables[CurveIdx].Evaluate(IterX) - TfReference);
+                TfMaxNewtonError = FMath::Max(TfMaxNewtonError, TfNewtonError);
+                TfMaxTableError = FMath::Max(TfMaxTableError, TfTableError);
+                TfSumNewtonError += TfNewtonError;
+                TfSumTableError += TfTableError;
+            }
+        }
+
+        /** Sum of results keeps evaluations from being optimized away */
+        float TfSink = 0.0f;
+        const double TfNewtonTime = TimeRuns(TiIterations, [&]()
+            {
+                for (const FBezierCurve& IterCurve : TsCurves)
+                {
+                    for (const float IterX : TsXs)
+                    {
+                        TfSink += EvaluateBezier(IterCurve, IterX);
+                    }
+                }
+            });
+
+        const double TfTableTime = TimeRuns(TiIterations, [&]()
+            {
+                for (const FBezierTable& IterTable : TsTables)
+                {
+                    for (const float IterX : TsXs)
+                    {
+                        TfSink += IterTable.Evaluate(IterX);
+                    }
+                }
+            });
+
+        /** All curves at the same progress, like the channels of every bone in one tick */
+        FVmdBezierBatch TsBatch;
+        TsBatch.Reset(TsCurves.Num());
+        for (const FBezierCurve& IterCurve : TsCurves)
+        {
+            TsBatch.Add(IterCurve);
+        }
+
+        TArray<float> TsBatchValues;
+        TsBatchValues.SetNumUninitialized(TsCurves.Num());
+        double TfMaxBatchError = 0.0;
+        double TfSumBatchError = 0.0;
+        for (const float IterX : TsXs)
+        {
+            TsBatch.Evaluate(IterX, TsBatchValues);
+            for (int32 CurveIdx = 0; CurveIdx < TsCurves.Num(); ++CurveIdx)
+            {
+                const double TfBatchError = FMath::Abs(TsBatchValues[CurveIdx] - EvaluateBezierReference(TsCurves[CurveIdx], IterX));
+                TfMaxBatchError = FMath::Max(TfMaxBatchError, TfBatchError);
+                TfSumBatchError += TfBatchError;
+            }
+        }
+
+        const double TfBatchTime = TimeRuns(TiIterations, [&]()
+            {
+                for (const float IterX : TsXs)
+                {
+                    TsBatch.Evaluate(IterX, TsBatchValues);
+                    TfSink += TsBatchValues[0] + TsBatchValues.Last();
+                }
+            });
+
+        const double TfEvalNum = (double)TsCurves.Num() * TsXs.Num();
+        UE_LOG(LogMmdHelper, Display, TEXT("VmdBenchmark::BenchBezier: curves=%d samples=%d iterations=%d sink=%f"), TsCurves.Num(), TsXs.Num(), TiIterations, TfSink);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Newton      %8.2f ns/eval maxError=%g avgError=%g"), TfNewtonTime * 1.0e9 / TfEvalNum, TfMaxNewtonError, TfSumNewtonError / TfEvalNum);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Table       %8.2f ns/eval maxError=%g avgError=%g"), TfTableTime * 1.0e9 / TfEvalNum, TfMaxTableError, TfSumTableError / TfEvalNum);
+        UE_LOG(LogMmdHelper, Display, TEXT("  Batch       %8.2f ns/eval maxError=%g avgError=%g lanes=%d"), TfBatchTime * 1.0e9 / TfEvalNum, TfMaxBatchError, TfSumBatchError / TfEvalNum, FVmdBezierBatch::LaneNum);
+        UE_LOG(LogMmdHelper, Display, TEXT("  TableBuild  %8.2f ns/curve"), TfBuildTime * 1.0e9 / TsCurves.Num());
+    }
+}
+
+
+static FAutoConsoleCommand GVmdBenchLoadCommand(
+    TEXT("MmdHelper.Bench.Load"),
+    TEXT("Compare FArchive and mapped view loading of a vmd file. Usage: MmdHelper.Bench.Load <VmdFile> [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::BenchLoad)
+);
+
+static FAutoConsoleCommand GVmdBenchBoneUnpackCommand(
+    TEXT("MmdHelper.Bench.BoneUnpack"),
+    TEXT("Compare row and column decoding of vmd bone frames. Usage: MmdHelper.Bench.BoneUnpack <VmdFile> [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::BenchBoneUnpack)
+);
+
+static FAutoConsoleCommand GVmdBenchGenerateCommand(
+    TEXT("MmdHelper.Bench.Generate"),
+    TEXT("Write a synthetic vmd file. Usage: MmdHelper.Bench.Generate <OutFile> [Bones=N] [BoneNames=N] [Faces=N] [FaceNames=N] [Cameras=N] [Lights=N] [Shadows=N] [Iks=N] [IkNames=N] [MaxFrame=N] [Zipf=S] [Sjis=R] [Seed=N]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::Generate)
+);
+
+static FAutoConsoleCommand GVmdBenchStagesCommand(
+    TEXT("MmdHelper.Bench.Stages"),
+    TEXT("Time each import stage and print json. Usage: MmdHelper.Bench.Stages <VmdFile|Synthetic> [Iterations=N] [Json=OutFile] [generator options]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::BenchStages)
+);
+
+static FAutoConsoleCommand GVmdBenchSjisCommand(
+    TEXT("MmdHelper.Bench.Sjis"),
+    TEXT("Compare two pass and simd single pass sjis name decoding, and time encoding names back. Usage: MmdHelper.Bench.Sjis <VmdFile|Synthetic> [Iterations=N] [generator options]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::BenchSjis)
+);
+
+static FAutoConsoleCommand GVmdBenchCompactCommand(
+    TEXT("MmdHelper.Bench.Compact"),
+    TEXT("Compare saved size and load time of motion data asset with tagged and compact track storage. Usage: MmdHelper.Bench.Compact <VmdFile|Synthetic> [Iterations=N] [generator options]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::BenchCompact)
+);
+
+static FAutoConsoleCommand GVmdBenchBezierCommand(
+    TEXT("MmdHelper.Bench.Bezier"),
+    TEXT("Time and check accuracy of vmd interpolation curve evaluation, newton solve, table and vector batch. Usage: MmdHelper.Bench.Bezier [Curves=N] [Samples=N] [Iterations=N] [Seed=N]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&VmdBenchmark::BenchBezier)
+);
+
+static FAutoConsoleCommand GVmdSjisVerifyCommand(
+    TEXT("MmdHelper.Sjis.Verify"),
+    TEXT("Check sjis conversion of all 64K byte pairs against the checksum generated with the table, and that every encoded char decodes back"),
+    FConsoleCommandDelegate::CreateStatic(&VmdBenchmark::VerifySjisTable)
+);
+
+#endif
@@ -0,0 +1,251 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdSyntheticGenerator.h"
+
+#include "Vmd/VmdRawRecords.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Algo/BinarySearch.h"
+#include "Math/RandomStream.h"
+
+#if !UE_BUILD_SHIPPING
+
+
+namespace VmdSyntheticGeneratorPrivate
+{
+    /** Raw sjis names with a sampler following the configured distribution */
+    struct FNamePool
+    {
+    public:
+        TArray<TArray<char>> Names;
+        TArray<float> Cdf;
+
+    public:
+        FNamePool(int32 InNum, int32 InFieldSize, const TCHAR* InPrefix, float InZipf, float InSjisRatio, FRandomStream& InRandom)
+        {
+            InNum = FMath::Max(InNum, 1);
+            Names.SetNum(InNum);
+            Cdf.SetNumUninitialized(InNum);
+
+            float TfSum = 0.0f;
+            for (int32 Idx = 0; Idx < InNum; ++Idx)
+            {
+                TArray<char>& TrName = Names[Idx];
+                if (InRandom.FRand() < InSjisRatio)
+                {
+                    /** A few katakana (0x8340 - 0x8396) then index, the way most model bones and morphs are named */
+                    const int32 TiCharNum = InRandom.RandRange(1, 4);
+                    for (int32 CharIdx = 0; CharIdx < TiCharNum; ++CharIdx)
+                    {
+                        int32 TiTrail = InRandom.RandRange(0x40, 0x96);
+                        TiTrail += TiTrail == 0x7F ? 1 : 0;
+                        TrName.Add((char)0x83);
+                        TrName.Add((char)TiTrail);
+                    }
+                }
+                else
+                {
+                    for (const TCHAR* TpChar = InPrefix; *TpChar; ++TpChar)
+                    {
+                        TrName.Add((char)*TpChar);
+                    }
+                }
+
+                /** Index keeps names distinct, name may fill the whole field without terminator */
+                const FString TstrIndex = FString::FromInt(Idx);
+                for (const TCHAR IterChar : TstrIndex)
+                {
+                    TrName.Add((char)IterChar);
+                }
+                TrName.SetNumZeroed(InFieldSize);
+
+                TfSum += InZipf > 0.0f ? 1.0f / FMath::Pow((float)(Idx + 1), InZipf) : 1.0f;
+                Cdf[Idx] = TfSum;
+            }
+
+            for (float& IterValue : Cdf)
+            {
+                IterValue /= TfSum;
+            }
+        }
+
+        const char* Sample(FRandomStream& InRandom) const
+        {
+            const int32 TiIndex = FMath::Min(Algo::LowerBound(Cdf, InRandom.FRand()), Cdf.Num() - 1);
+            return Names[TiIndex].GetData();
+        }
+    };
+
+    template<typename RecordType>
+    static void AppendRecord(TArray64<uint8>& OutBytes, const RecordType& InRecord)
+    {
+        OutBytes.Append(reinterpret_cast<const uint8*>(&InRecord), sizeof(RecordType));
+    }
+
+    static void AppendCount(TArray64<uint8>& OutBytes, int32 InCount)
+    {
+        OutBytes.Append(reinterpret_cast<const uint8*>(&InCount), sizeof(InCount));
+    }
+}
+
+void FVmdSyntheticConfig::ParseFrom(const TCHAR* InArgs)
+{
+    FParse::Value(InArgs, TEXT("Bones="), BoneFrames);
+    FParse::Value(InArgs, TEXT("BoneNames="), BoneNames);
+    FParse::Value(InArgs, TEXT("Faces="), FaceFrames);
+    FParse::Value(InArgs, TEXT("FaceNames="), FaceNames);
+    FParse::Value(InArgs, TEXT("Cameras="), CameraFrames);
+    FParse::Value(InArgs, TEXT("Lights="), LightFrames);
+    FParse::Value(InArgs, TEXT("Shadows="), SelfShadowFrames);
+    FParse::Value(InArgs, TEXT("Iks="), IkFrames);
+    FParse::Value(InArgs, TEXT("IkNames="), IkNames);
+    FParse::Value(InArgs, TEXT("MaxFrame="), MaxFrame);
+    FParse::Value(InArgs, TEXT("Zipf="), NameZipf);
+    FParse::Value(InArgs, TEXT("Sjis="), SjisRatio);
+    FParse::Value(InArgs, TEXT("Seed="), Seed);
+
+    for (int32* IterCount : { &BoneFrames, &BoneNames, &FaceFrames, &FaceNames, &CameraFrames, &LightFrames, &SelfShadowFrames, &IkFrames, &IkNames, &MaxFrame })
+    {
+        *IterCount = FMath::Max(*IterCount, 0);
+    }
+}
+
+FString FVmdSyntheticConfig::ToString() const
+{
+    return FString::Printf(TEXT("Bones=%d BoneNames=%d Faces=%d FaceNames=%d Cameras=%d Lights=%d Shadows=%d Iks=%d IkNames=%d MaxFrame=%d Zipf=%.2f Sjis=%.2f Seed=%d"),
+        BoneFrames, BoneNames, FaceFrames, FaceNames, CameraFrames, LightFrames, SelfShadowFrames, IkFrames, IkNames, MaxFrame, NameZipf, SjisRatio, Seed);
+}
+
+void FVmdSyntheticGenerator::Generate(const FVmdSyntheticConfig& InConfig, TArray64<uint8>& OutBytes)
+{
+    using namespace VmdSyntheticGeneratorPrivate;
+
+    FRandomStream TsRandom(InConfig.Seed);
+    const int32 TiMaxFrame = FMath::Max(InConfig.MaxFrame, 0);
+
+    const FNamePool TsBoneNames(InConfig.BoneNames, sizeof(FVmdRawBoneRecord::Name), TEXT("Bone"), InConfig.NameZipf, InConfig.SjisRatio, TsRandom);
+    const FNamePool TsFaceNames(InConfig.FaceNames, sizeof(FVmdRawFaceRecord::Name), TEXT("Face"), InConfig.NameZipf, InConfig.SjisRatio, TsRandom);
+    const FNamePool TsIkNames(InConfig.IkNames, sizeof(FVmdRawIkInfo::Name), TEXT("Ik"), 0.0f, InConfig.SjisRatio, TsRandom);
+
+    const int64 TiIkBytes = (int64)InConfig.IkFrames * GetVmdIkRecordSize(InConfig.IkNames);
+    OutBytes.Reset(sizeof(FVmdRawHeader)
+        + (int64)InConfig.BoneFrames * sizeof(FVmdRawBoneRecord)
+        + (int64)InConfig.FaceFrames * sizeof(FVmdRawFaceRecord)
+        + (int64)InConfig.CameraFrames * sizeof(FVmdRawCameraRecord)
+        + (int64)InConfig.LightFrames * sizeof(FVmdRawLightRecord)
+        + (int64)InConfig.SelfShadowFrames * sizeof(FVmdRawSelfShadowRecord)
+        + TiIkBytes
+        + (int32)EVmdSection::Num * sizeof(int32));
+
+    FVmdRawHeader TsHeader;
+    FMemory::Memzero(TsHeader);
+    FMemory::Memcpy(TsHeader.MagicHeader, VmdMagicHeader, sizeof(VmdMagicHeader));
+    FCStringAnsi::Strncpy(TsHeader.TargetModelName, "Synthetic", sizeof(TsHeader.TargetModelName));
+    AppendRecord(OutBytes, TsHeader);
+
+    AppendCount(OutBytes, InConfig.BoneFrames);
+    for (int32 Idx = 0; Idx < InConfig.BoneFrames; ++Idx)
+    {
+        FVmdRawBoneRecord TsRecord;
+        FMemory::Memcpy(TsRecord.Name, TsBoneNames.Sample(TsRandom), sizeof(TsRecord.Name));
+        TsRecord.Frame = TsRandom.RandRange(0, TiMaxFrame);
+
+        const FQuat4f TsRotation = FQuat4f(FRotator3f(TsRandom.FRandRange(-90.0f, 90.0f), TsRandom.FRandRange(-180.0f, 180.0f), TsRandom.FRandRange(-180.0f, 180.0f)));
+        TsRecord.Position[0] = TsRandom.FRandRange(-10.0f, 10.0f);
+        TsRecord.Position[1] = TsRandom.FRandRange(-10.0f, 10.0f);
+        TsRecord.Position[2] = TsRandom.FRandRange(-10.0f, 10.0f);
+        TsRecord.Quaternion[0] = TsRotation.X;
+        TsRecord.Quaternion[1] = TsRotation.Y;
+        TsRecord.Quaternion[2] = TsRotation.Z;
+        TsRecord.Quaternion[3] = TsRotation.W;
+
+        for (int32 ByteIdx = 0; ByteIdx < UE_ARRAY_COUNT(TsRecord.Interpolation); ++ByteIdx)
+        {
+            TsRecord.Interpolation[ByteIdx] = (uint8)TsRandom.RandRange(0, 127);
+        }
+        AppendRecord(OutBytes, TsRecord);
+    }
+
+    AppendCount(OutBytes, InConfig.FaceFrames);
+    for (int32 Idx = 0; Idx < InConfig.FaceFrames; ++Idx)
+    {
+        FVmdRawFaceRecord TsRecord;
+        FMemory::Memcpy(TsRecord.Name, TsFaceNames.Sample(TsRandom), sizeof(TsRecord.Name));
+        TsRecord.Frame = TsRandom.RandRange(0, TiMaxFrame);
+        TsRecord.Factor = TsRandom.FRand();
+        AppendRecord(OutBytes, TsRecord);
+    }
+
+    AppendCount(OutBytes, InConfig.CameraFrames);
+    for (int32 Idx = 0; Idx < InConfig.CameraFrames; ++Idx)
+    {
+        FVmdRawCameraRecord TsRecord;
+        FMemory::Memzero(TsRecord);
+        TsRecord.Frame = TsRandom.RandRange(0, TiMaxFrame);
+        TsRecord.Length = TsRandom.FRandRange(-50.0f, -10.0f);
+        TsRecord.Location[0] = TsRandom.FRandRange(-5.0f, 5.0f);
+        TsRecord.Location[1] = TsRandom.FRandRange(5.0f, 15.0f);
+        TsRecord.Location[2] = TsRandom.FRandRange(-5.0f, 5.0f);
+        TsRecord.Rotate[0] = TsRandom.FRandRange(-0.5f, 0.5f);
+        TsRecord.Rotate[1] = TsRandom.FRandRange(-PI, PI);
+        TsRecord.Rotate[2] = TsRandom.FRandRange(-0.2f, 0.2f);
+        for (int32 ByteIdx = 0; ByteIdx < UE_ARRAY_COUNT(TsRecord.Interpolation); ++ByteIdx)
+        {
+            TsRecord.Interpolation[ByteIdx] = (uint8)TsRandom.RandRange(0, 127);
+        }
+        TsRecord.ViewingAngle = TsRandom.RandRange(20, 60);
+        TsRecord.Perspective = TsRandom.FRand() < 0.95f ? 0 : 1;
+        AppendRecord(OutBytes, TsRecord);
+    }
+
+    AppendCount(OutBytes, InConfig.LightFrames);
+    for (int32 Idx = 0; Idx < InConfig.LightFrames; ++Idx)
+    {
+        FVmdRawLightRecord TsRecord;
+        TsRecord.Frame = TsRandom.RandRange(0, TiMaxFrame);
+        TsRecord.Color[0] = TsRandom.FRand();
+        TsRecord.Color[1] = TsRandom.FRand();
+        TsRecord.Color[2] = TsRandom.FRand();
+        TsRecord.Position[0] = TsRandom.FRandRange(-1.0f, 1.0f);
+        TsRecord.Position[1] = TsRandom.FRandRange(-1.0f, 1.0f);
+        TsRecord.Position[2] = TsRandom.FRandRange(-1.0f, 1.0f);
+        AppendRecord(OutBytes, TsRecord);
+    }
+
+    AppendCount(OutBytes, InConfig.SelfShadowFrames);
+    for (int32 Idx = 0; Idx < InConfig.SelfShadowFrames; ++Idx)
+    {
+        FVmdRawSelfShadowRecord TsRecord;
+        TsRecord.Frame = TsRandom.RandRange(0, TiMaxFrame);
+        TsRecord.Mode = (uint8)TsRandom.RandRange(0, 2);
+        TsRecord.Distance = TsRandom.FRandRange(0.0f, 0.1f);
+        AppendRecord(OutBytes, TsRecord);
+    }
+
+    AppendCount(OutBytes, InConfig.IkFrames);
+    for (int32 Idx = 0; Idx < InConfig.IkFrames; ++Idx)
+    {
+        FVmdRawIkRecord TsRecord;
+        TsRecord.Frame = TsRandom.RandRange(0, TiMaxFrame);
+        TsRecord.Show = TsRandom.FRand() < 0.9f ? 1 : 0;
+        TsRecord.IkCount = InConfig.IkNames;
+        AppendRecord(OutBytes, TsRecord);
+
+        for (int32 InfoIdx = 0; InfoIdx < InConfig.IkNames; ++InfoIdx)
+        {
+            FVmdRawIkInfo TsInfo;
+            FMemory::Memcpy(TsInfo.Name, TsIkNames.Names[InfoIdx].GetData(), sizeof(TsInfo.Name));
+            TsInfo.Enable = TsRandom.FRand() < 0.8f ? 1 : 0;
+            AppendRecord(OutBytes, TsInfo);
+        }
+    }
+}
+
+bool FVmdSyntheticGenerator::GenerateToFile(const FVmdSyntheticConfig& InConfig, const FString& InFilePath)
+{
+    TArray64<uint8> TsBytes;
+    Generate(InConfig, TsBytes);
+    return FFileHelper::SaveArrayToFile(TsBytes, *InFilePath);
+}
+
+#endif
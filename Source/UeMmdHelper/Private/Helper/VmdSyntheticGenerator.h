@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Development only, used by the bench commands and automation tests */
+#if !UE_BUILD_SHIPPING
+
+
+/** Shape of a generated vmd file */
+struct FVmdSyntheticConfig
+{
+public:
+    int32 BoneFrames = 100000;
+    int32 BoneNames = 200;
+    int32 FaceFrames = 50000;
+    int32 FaceNames = 80;
+    int32 CameraFrames = 5000;
+    int32 LightFrames = 100;
+    int32 SelfShadowFrames = 100;
+    int32 IkFrames = 100;
+
+    /** Ik states in each ik frame */
+    int32 IkNames = 8;
+
+    /** Last frame number, frames are spread over [0, MaxFrame] */
+    int32 MaxFrame = 10000;
+
+    /** Exponent of zipf distribution of name usage, 0 for uniform */
+    float NameZipf = 1.0f;
+
+    /** Part of names made of multi byte sjis characters, the others are ascii */
+    float SjisRatio = 0.5f;
+
+    int32 Seed = 0x4D4D44;
+
+public:
+    /**
+     * Read Key=Value pairs, unknown keys are ignored
+     * Keys: Bones BoneNames Faces FaceNames Cameras Lights Shadows Iks IkNames MaxFrame Zipf Sjis Seed
+     */
+    void ParseFrom(const TCHAR* InArgs);
+
+    FString ToString() const;
+};
+
+namespace FVmdSyntheticGenerator
+{
+    /** Build a valid vmd file in memory, same config and seed always give the same bytes */
+    void Generate(const FVmdSyntheticConfig& InConfig, TArray64<uint8>& OutBytes);
+
+    bool GenerateToFile(const FVmdSyntheticConfig& InConfig, const FString& InFilePath);
+}
+
+#endif
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+#
+# Generates SjisToUnicodeTable.inl, the double byte part of the sjis to unicode table,
+# and UnicodeToSjisTable.inl, the reverse table used by the encoder.
+#
+# Double byte codes are stored in a two level page table: each lead byte owns PAGES_PER_LEAD
+# page slots, identical pages (most of all the empty ones) are stored once.
+# Values come from the cp932 codec, which is what the original saba table was made of.
+#
+# The reverse table is made of the forward rules, so every encoded char decodes back to itself.
+# It is paged the same way on the unicode basic plane, chars decoded from several codes encode
+# to the one the cp932 codec picks.
+#
+# Usage: python3 SjisTableGen.py [output directory]
+#
+
+import os
+import sys
+
+LEAD_RANGES = [(0x81, 0x9F), (0xE0, 0xEF)]
+TRAIL_BEGIN = 0x40
+TRAIL_END = 0xFC
+PAGE_SHIFT = 5
+PAGE_SIZE = 1 << PAGE_SHIFT
+PAGES_PER_LEAD = (TRAIL_END - TRAIL_BEGIN + 1 + PAGE_SIZE - 1) // PAGE_SIZE
+INVALID = 0xFFFF
+
+UNICODE_PAGE_SHIFT = 6
+UNICODE_PAGE_SIZE = 1 << UNICODE_PAGE_SHIFT
+UNICODE_PAGE_NUM = 0x10000 >> UNICODE_PAGE_SHIFT
+UNREPRESENTABLE = 0
+
+
+def decode_double(lead, trail):
+    try:
+        text = bytes([lead, trail]).decode('cp932')
+    except UnicodeDecodeError:
+        return INVALID
+    return ord(text) if len(text) == 1 else INVALID
+
+
+def leads():
+    for begin, end in LEAD_RANGES:
+        for lead in range(begin, end + 1):
+            yield lead
+
+
+def convert_char(ch1, ch2):
+    # Same rules as saba::ConvertSjisToU16Char, returns (unicode, consumed bytes)
+    if ch1 <= 0x7E:
+        return ch1, 1
+    if 0xA1 <= ch1 <= 0xDF:
+        return 0xFF61 + ch1 - 0xA1, 1
+    if any(begin <= ch1 <= end for begin, end in LEAD_RANGES) and TRAIL_BEGIN <= ch2 <= TRAIL_END:
+        return decode_double(ch1, ch2), 2
+    return INVALID, 1
+
+
+def checksum():
+    # FNV-1a over (unicode low, unicode high, consumed bytes) of every byte pair
+    value = 0x811C9DC5
+    for ch1 in range(256):
+        for ch2 in range(256):
+            unicode, length = convert_char(ch1, ch2)
+            for byte in (unicode & 0xFF, unicode >> 8, length):
+                value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def build_pages():
+    pages = []
+    page_ids = {}
+    page_index = []
+    for lead in leads():
+        row = [decode_double(lead, trail) for trail in range(TRAIL_BEGIN, TRAIL_END + 1)]
+        row += [INVALID] * (PAGES_PER_LEAD * PAGE_SIZE - len(row))
+        for begin in range(0, len(row), PAGE_SIZE):
+            page = tuple(row[begin:begin + PAGE_SIZE])
+            if page not in page_ids:
+                page_ids[page] = len(pages)
+                pages.append(page)
+            page_index.append(page_ids[page])
+    return pages, page_index
+
+
+def build_reverse():
+    # Unicode to every code decoding to it, single byte codes are below 0x100
+    codes = {}
+    for ch1 in range(1, 256):
+        unicode, length = convert_char(ch1, 0)
+        if length == 1 and unicode != INVALID:
+            codes.setdefault(unicode, []).append(ch1)
+    for lead in leads():
+        for trail in range(TRAIL_BEGIN, TRAIL_END + 1):
+            unicode = decode_double(lead, trail)
+            if unicode != INVALID:
+                codes.setdefault(unicode, []).append(lead << 8 | trail)
+
+    reverse = {}
+    for unicode, candidates in codes.items():
+        preferred = int.from_bytes(chr(unicode).encode('cp932'), 'big')
+        reverse[unicode] = preferred if preferred in candidates else min(candidates)
+    return reverse
+
+
+def build_reverse_pages():
+    reverse = build_reverse()
+    pages = []
+    page_ids = {}
+    page_index = []
+    for begin in range(0, 0x10000, UNICODE_PAGE_SIZE):
+        page = tuple(reverse.get(unicode, UNREPRESENTABLE) for unicode in range(begin, begin + UNICODE_PAGE_SIZE))
+        if page not in page_ids:
+            page_ids[page] = len(pages)
+            pages.append(page)
+        page_index.append(page_ids[page])
+    return pages, page_index, len(reverse)
+
+
+def write_lines(path, lines):
+    with open(path, 'w', newline='\n') as file:
+        file.write('\n'.join(lines))
+
+
+def write_reverse_table(path):
+    pages, page_index, char_num = build_reverse_pages()
+    assert len(pages) <= 0x10000, 'page index no longer fits uint16_t'
+
+    lines = [
+        '//',
+        '// Generated by SjisTableGen.py, do not edit.',
+        '// Unicode to sjis (cp932), %d chars in %d pages of %d chars, %d bytes.' % (
+            char_num, len(pages), UNICODE_PAGE_SIZE, len(pages) * UNICODE_PAGE_SIZE * 2 + len(page_index) * 2),
+        '//',
+        '',
+        'namespace',
+        '{',
+        '    const int UnicodePageShift = %d;' % UNICODE_PAGE_SHIFT,
+        '    const int UnicodePageMask = %d;' % (UNICODE_PAGE_SIZE - 1),
+        '',
+        '    // Single byte codes are below 0x100, double byte codes are lead << 8 | trail, 0 is unrepresentable',
+        '    const uint16_t UnicodeToSjisUnrepresentable = 0x%04X;' % UNREPRESENTABLE,
+        '',
+        '    // Page of each unicode >> UnicodePageShift',
+        '    const uint16_t UnicodePageIndex[%d] =' % len(page_index),
+        '    {',
+    ]
+    for begin in range(0, len(page_index), 16):
+        lines.append('        ' + ' '.join('%d,' % v for v in page_index[begin:begin + 16]))
+    lines += [
+        '    };',
+        '',
+        '    const uint16_t UnicodePages[%d][%d] =' % (len(pages), UNICODE_PAGE_SIZE),
+        '    {',
+    ]
+    for page in pages:
+        lines.append('        {')
+        for begin in range(0, UNICODE_PAGE_SIZE, 8):
+            lines.append('            ' + ' '.join('0x%04X,' % v for v in page[begin:begin + 8]))
+        lines.append('        },')
+    lines += [
+        '    };',
+        '}',
+        '',
+    ]
+    write_lines(path, lines)
+
+
+def write_table(path):
+    pages, page_index = build_pages()
+    assert len(pages) <= 256, 'page index no longer fits uint8_t'
+
+    lines = [
+        '//',
+        '// Generated by SjisTableGen.py, do not edit.',
+        '// Double byte sjis (cp932) to unicode, %d pages of %d chars, %d bytes.' % (
+            len(pages), PAGE_SIZE, len(pages) * PAGE_SIZE * 2 + len(page_index)),
+        '//',
+        '',
+        'namespace',
+        '{',
+        '    const int SjisPageShift = %d;' % PAGE_SHIFT,
+        '    const int SjisPageMask = %d;' % (PAGE_SIZE - 1),
+        '    const int SjisPagesPerLead = %d;' % PAGES_PER_LEAD,
+        '',
+        '    // Checksum of ConvertSjisToU16Char over all 64K byte pairs, see SjisTableGen.py',
+        '    const uint32_t SjisTableChecksum = 0x%08X;' % checksum(),
+        '',
+        '    // Page of each lead byte (0x81-0x9F, 0xE0-0xEF) and trail byte >> SjisPageShift',
+        '    const uint8_t SjisPageIndex[%d] =' % len(page_index),
+        '    {',
+    ]
+    for begin in range(0, len(page_index), PAGES_PER_LEAD):
+        lines.append('        ' + ' '.join('%d,' % v for v in page_index[begin:begin + PAGES_PER_LEAD]))
+    lines += [
+        '    };',
+        '',
+        '    const uint16_t SjisPages[%d][%d] =' % (len(pages), PAGE_SIZE),
+        '    {',
+    ]
+    for page in pages:
+        lines.append('        {')
+        for begin in range(0, PAGE_SIZE, 8):
+            lines.append('            ' + ' '.join('0x%04X,' % v for v in page[begin:begin + 8]))
+        lines.append('        },')
+    lines += [
+        '    };',
+        '}',
+        '',
+    ]
+
+    write_lines(path, lines)
+
+
+def main():
+    output = sys.argv[1] if len(sys.argv) > 1 else os.path.dirname(os.path.abspath(__file__))
+    write_table(os.path.join(output, 'SjisToUnicodeTable.inl'))
+    write_reverse_table(os.path.join(output, 'UnicodeToSjisTable.inl'))
+
+
+if __name__ == '__main__':
+    main()
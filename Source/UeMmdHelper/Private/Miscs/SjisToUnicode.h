@@ -6,6 +6,7 @@
 #ifndef SABA_MODEL_MMD_SJISTOUNICODE_H_
 #define SABA_MODEL_MMD_SJISTOUNICODE_H_
 
+#include <cstdint>
 #include <string>
 
 namespace saba
@@ -13,6 +14,34 @@ namespace saba
     char16_t ConvertSjisToU16Char(int ch);
     std::u16string ConvertSjisToU16String(const char* sjisCode);
     std::u32string ConvertSjisToU32String(const char* sjisCode);
+
+    // Original two pass scalar conversion, kept to verify and benchmark the single pass decoder.
+    std::u16string ConvertSjisToU16StringReference(const char* sjisCode);
+
+    // Checksum of every byte pair conversion, compared with the one generated with the table.
+    uint32_t ComputeSjisTableChecksum();
+    bool VerifySjisTable();
+
+    // Decode at most sjisLen bytes, stops at terminator, a lead byte at the end is decoded as invalid.
+    // Returns count of chars written to outBuffer, never more than outLen.
+    size_t ConvertSjisToU16Buffer(const char* sjisCode, size_t sjisLen, char16_t* outBuffer, size_t outLen);
+
+    // Sjis code of a char, single byte codes are below 0x100, double byte codes are lead << 8 | trail.
+    // Returns 0 when the char has no code, every returned code decodes back to the char.
+    uint16_t ConvertU16ToSjisChar(char16_t ch);
+
+    struct SjisEncodeResult
+    {
+        size_t written = 0;         // Bytes written, no terminator is written
+        size_t consumed = 0;        // Chars of input consumed
+        size_t unrepresentable = 0; // Chars written as replacement
+        bool truncated = false;     // Input did not fit, the rest is not consumed
+    };
+
+    // Encode at most u16Len chars, stops at terminator. Chars without a code are written as replacement,
+    // a surrogate pair counts as one char. A double byte code is never split at the end of outBuffer.
+    SjisEncodeResult ConvertU16ToSjisBuffer(const char16_t* u16Str, size_t u16Len, char* outBuffer, size_t outLen, char replacement = '?');
+    std::string ConvertU16ToSjisString(const std::u16string& u16Str, size_t* outUnrepresentable = nullptr);
 }
 
 #endif // !SABA_MODEL_MMD_SJISTOUNICODE_H_
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdBezierBatch.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace VmdBezierBatchTestPrivate
+{
+    /** Same bounds as the core suite, x control points at 0 or 127 flatten x(t) at an end and loosen y */
+    static constexpr double InteriorTolerance = 5.0e-5;
+    static constexpr double ExtremeTolerance = 5.0e-4;
+
+    struct FCurveCase
+    {
+        uint8 Bytes[4];
+        VmdCore::FBezierCurve Curve;
+    };
+
+    /** Cycles through random, linear and extreme curves so every register holds a mix of them */
+    FCurveCase MakeCurveCase(FRandomStream& InRandom, int32 InIndex)
+    {
+        FCurveCase TsCase;
+        switch (InIndex % 5)
+        {
+        case 0:
+            /** Keys without interpolation write all zero bytes */
+            TsCase = { { 0, 0, 0, 0 } };
+            break;
+        case 1:
+        {
+            const uint8 TiP1 = (uint8)InRandom.RandRange(0, 127);
+            const uint8 TiP2 = (uint8)InRandom.RandRange(0, 127);
+            TsCase = { { TiP1, TiP1, TiP2, TiP2 } };
+            break;
+        }
+        case 2:
+            TsCase = { { (uint8)(InRandom.RandRange(0, 1) * 127), (uint8)(InRandom.RandRange(0, 1) * 127), (uint8)(InRandom.RandRange(0, 1) * 127), (uint8)(InRandom.RandRange(0, 1) * 127) } };
+            break;
+        default:
+            TsCase = { { (uint8)InRandom.RandRange(0, 127), (uint8)InRandom.RandRange(0, 127), (uint8)InRandom.RandRange(0, 127), (uint8)InRandom.RandRange(0, 127) } };
+            break;
+        }
+
+        TsCase.Curve = VmdCore::MakeBezierCurve(TsCase.Bytes[0], TsCase.Bytes[1], TsCase.Bytes[2], TsCase.Bytes[3]);
+        return TsCase;
+    }
+
+    double GetTolerance(const FCurveCase& InCase)
+    {
+        const bool bInterior = InCase.Bytes[0] > 0 && InCase.Bytes[0] < 127 && InCase.Bytes[2] > 0 && InCase.Bytes[2] < 127;
+        return bInterior ? InteriorTolerance : ExtremeTolerance;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdBezierBatchAccuracyTest, "MmdHelper.Vmd.BezierBatch.Accuracy", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdBezierBatchAccuracyTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdBezierBatchTestPrivate;
+
+    FRandomStream TsRandom(25);
+    FVmdBezierBatch TsBatch;
+
+    /**
+     * 1 to 17 curves run 1 to 5 registers through the 4, 2 and 1 register loops and a partly filled last register
+     * 28 curves take all three loops in one evaluation
+     */
+    TArray<int32> TsCurveNums;
+    for (int32 CurveNum = 1; CurveNum <= 17; ++CurveNum)
+    {
+        TsCurveNums.Add(CurveNum);
+    }
+    TsCurveNums.Add(28);
+
+    for (const int32 IterCurveNum : TsCurveNums)
+    {
+        TArray<FCurveCase> TsCases;
+        TsBatch.Reset(IterCurveNum);
+        for (int32 Idx = 0; Idx < IterCurveNum; ++Idx)
+        {
+            TsCases.Add(MakeCurveCase(TsRandom, Idx));
+            TestEqual(TEXT("Curve index"), TsBatch.Add(TsCases.Last().Curve), Idx);
+        }
+        TestEqual(TEXT("Curve count"), TsBatch.Num(), IterCurveNum);
+
+        TArray<float> TsXs = { 0.0f, 1.0f, 0.5f, -0.25f, 1.25f };
+        for (int32 Sample = 0; Sample < 16; ++Sample)
+        {
+            TsXs.Add(TsRandom.FRand());
+        }
+
+        TArray<float> TsValues;
+        TsValues.SetNumZeroed(IterCurveNum);
+        for (const float IterX : TsXs)
+        {
+            TsBatch.Evaluate(IterX, TsValues);
+            for (int32 Idx = 0; Idx < IterCurveNum; ++Idx)
+            {
+                const FCurveCase& TrCase = TsCases[Idx];
+                const double TfTolerance = GetTolerance(TrCase);
+                const FString TstrWhat = FString::Printf(TEXT("curves=%d index=%d bytes=%d,%d,%d,%d x=%f"),
+                    IterCurveNum, Idx, TrCase.Bytes[0], TrCase.Bytes[1], TrCase.Bytes[2], TrCase.Bytes[3], IterX);
+
+                if (TrCase.Curve.bLinear)
+                {
+                    TestEqual(TEXT("Linear curve, ") + TstrWhat, TsValues[Idx], FMath::Clamp(IterX, 0.0f, 1.0f));
+                }
+                TestNearlyEqual(TEXT("Against scalar, ") + TstrWhat, (double)TsValues[Idx], (double)VmdCore::EvaluateBezier(TrCase.Curve, IterX), TfTolerance);
+                TestNearlyEqual(TEXT("Against reference, ") + TstrWhat, (double)TsValues[Idx], VmdCore::EvaluateBezierReference(TrCase.Curve, IterX), TfTolerance);
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdBezierBatchChannelsTest, "MmdHelper.Vmd.BezierBatch.Channels", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdBezierBatchChannelsTest::RunTest(const FString& Parameters)
+{
+    FRandomStream TsRandom(6);
+    uint8 TsCameraBytes[VmdCore::CameraInterpolationSize];
+    uint8 TsBoneBytes[16];
+    for (uint8& IterByte : TsCameraBytes)
+    {
+        IterByte = (uint8)TsRandom.RandRange(0, 127);
+    }
+    for (uint8& IterByte : TsBoneBytes)
+    {
+        IterByte = (uint8)TsRandom.RandRange(0, 127);
+    }
+
+    /** Camera channels in ECameraCurve order, then bone channels X Y Z R */
+    FVmdBezierBatch TsBatch;
+    TsBatch.AddCameraCurves(TsCameraBytes);
+    TsBatch.AddBoneCurves(TsBoneBytes);
+    TestEqual(TEXT("Curve count"), TsBatch.Num(), (int32)VmdCore::ECameraCurve::Num + 4);
+
+    TArray<VmdCore::FBezierCurve> TsExpected;
+    for (int32 Channel = 0; Channel < (int32)VmdCore::ECameraCurve::Num; ++Channel)
+    {
+        TsExpected.Add(VmdCore::MakeCameraCurve(TsCameraBytes, (VmdCore::ECameraCurve)Channel));
+    }
+    for (int32 Channel = 0; Channel < 4; ++Channel)
+    {
+        TsExpected.Add(VmdCore::MakeBoneCurve(TsBoneBytes, Channel));
+    }
+
+    TArray<float> TsValues;
+    TsValues.SetNumZeroed(TsBatch.Num());
+    for (const float IterX : { 0.1f, 0.37f, 0.8f })
+    {
+        TsBatch.Evaluate(IterX, TsValues);
+        for (int32 Idx = 0; Idx < TsExpected.Num(); ++Idx)
+        {
+            TestNearlyEqual(FString::Printf(TEXT("Channel, index=%d x=%f"), Idx, IterX), TsValues[Idx], VmdCore::EvaluateBezier(TsExpected[Idx], IterX), 5.0e-4f);
+        }
+    }
+    return true;
+}
+
+#endif
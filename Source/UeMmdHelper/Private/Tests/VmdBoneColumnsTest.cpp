@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdBoneColumns.h"
+#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdFileView.h"
+#include "Helper/VmdSyntheticGenerator.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && !UE_BUILD_SHIPPING
+
+
+namespace VmdBoneColumnsTestPrivate
+{
+    /** Count of channel values that differ between column and row decode */
+    struct FMismatchCount
+    {
+        int32 Names = 0;
+        int32 Frames = 0;
+        int32 Positions = 0;
+        int32 Rotations = 0;
+        int32 Interpolations = 0;
+    };
+
+    FMismatchCount CompareColumns(const FVmdBoneFrameColumns& InColumns, TConstArrayView<FVmdBoneFrame> InRows)
+    {
+        FMismatchCount TsCount;
+        for (int32 Idx = 0; Idx < InRows.Num(); ++Idx)
+        {
+            const FVmdBoneFrame& TrRow = InRows[Idx];
+            const int32 TiNameId = InColumns.NameIds[Idx];
+            if (!InColumns.Names.IsValidIndex(TiNameId) || InColumns.Names[TiNameId] != FVmdDataHelper::ConvertFromMmdName(TrRow.Name, sizeof(TrRow.Name)))
+            {
+                ++TsCount.Names;
+            }
+
+            TsCount.Frames += InColumns.Frames[Idx] != TrRow.Frame;
+
+            /** Both decodes copy the floats, bits must be equal */
+            const FVector3f& TrPosition = InColumns.Positions[Idx];
+            TsCount.Positions += FMemory::Memcmp(&TrPosition.X, TrRow.Position, sizeof(TrRow.Position)) != 0;
+
+            const FQuat4f& TrRotation = InColumns.Rotations[Idx];
+            TsCount.Rotations += FMemory::Memcmp(&TrRotation.X, TrRow.Quaternion, sizeof(TrRow.Quaternion)) != 0;
+
+            TsCount.Interpolations += FMemory::Memcmp(InColumns.GetInterpolation(Idx).GetData(), TrRow.Bezier, FVmdBoneFrameColumns::InterpolationStride) != 0;
+        }
+        return TsCount;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdBoneColumnsMatchRowsTest, "MmdHelper.Vmd.BoneColumns.MatchRows", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdBoneColumnsMatchRowsTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdBoneColumnsTestPrivate;
+
+    /** A small file unpacks in one chunk, the large one in several 16K record chunks beside the name task */
+    for (const int32 IterBoneNum : { 37, 50000 })
+    {
+        FVmdSyntheticConfig TsConfig;
+        TsConfig.BoneFrames = IterBoneNum;
+        TsConfig.FaceFrames = 10;
+        TsConfig.CameraFrames = 0;
+        TsConfig.SjisRatio = 0.5f;
+
+        const FString TstrFilePath = FPaths::AutomationTransientDir() / FString::Printf(TEXT("BoneColumns_%d.vmd"), IterBoneNum);
+        if (!TestTrue(TEXT("Synthetic file written"), FVmdSyntheticGenerator::GenerateToFile(TsConfig, TstrFilePath)))
+        {
+            return false;
+        }
+
+        {
+            FVmdFileView TsView;
+            if (TestTrue(TEXT("Synthetic file opened"), TsView.Open(TstrFilePath)))
+            {
+                for (const bool bParallel : { false, true })
+                {
+                    const FString TstrWhat = FString::Printf(TEXT("bones=%d parallel=%d"), IterBoneNum, (int32)bParallel);
+
+                    FVmdData TsRowData;
+                    TsRowData.ReadFromView(TsView, bParallel);
+                    const TArray<FVmdBoneFrame>& TrRows = TsRowData.GetTrackData().BoneFrames;
+
+                    FVmdBoneFrameColumns TsColumns;
+                    TsColumns.UnpackFrom(TsView.GetBoneFrames(), bParallel);
+
+                    TestEqual(TEXT("Frame count, ") + TstrWhat, TsColumns.Num(), TrRows.Num());
+                    TestEqual(TEXT("Channel sizes, ") + TstrWhat, TsColumns.NameIds.Num() + TsColumns.Positions.Num() + TsColumns.Rotations.Num(), 3 * TrRows.Num());
+                    TestEqual(TEXT("Interpolation size, ") + TstrWhat, TsColumns.Interpolations.Num(), TrRows.Num() * FVmdBoneFrameColumns::InterpolationStride);
+                    TestTrue(TEXT("Unique names, ") + TstrWhat, TsColumns.Names.Num() > 0 && TsColumns.Names.Num() <= TsConfig.BoneNames);
+                    if (TsColumns.Num() != TrRows.Num())
+                    {
+                        continue;
+                    }
+
+                    const FMismatchCount TsCount = CompareColumns(TsColumns, TrRows);
+                    TestEqual(TEXT("Names, ") + TstrWhat, TsCount.Names, 0);
+                    TestEqual(TEXT("Frames, ") + TstrWhat, TsCount.Frames, 0);
+                    TestEqual(TEXT("Positions, ") + TstrWhat, TsCount.Positions, 0);
+                    TestEqual(TEXT("Rotations, ") + TstrWhat, TsCount.Rotations, 0);
+                    TestEqual(TEXT("Interpolations, ") + TstrWhat, TsCount.Interpolations, 0);
+                }
+            }
+        }
+
+        IFileManager::Get().Delete(*TstrFilePath);
+    }
+    return true;
+}
+
+#endif
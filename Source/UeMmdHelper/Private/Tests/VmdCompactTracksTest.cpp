@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdCompactTracks.h"
+#include "Vmd/MotionDataAsset.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace VmdCompactTracksTestPrivate
+{
+    void MakeTracks(TMap<FString, FVmdMorphTrackData>& OutMorphTracks, TArray<FVmdCameraFrameData>& OutCameraFrames)
+    {
+        FRandomStream TsRandom(19);
+
+        /** Usual [0, 1] range, wide range with negative values, constant and empty tracks */
+        TArray<FVmdMorphFrameData>& TrBlink = OutMorphTracks.Add(TEXT("まばたき")).Frames;
+        for (uint32 Frame = 0; Frame < 500; Frame += 1 + TsRandom.RandHelper(40))
+        {
+            TrBlink.Add({ Frame, TsRandom.FRand() });
+        }
+        TrBlink.Last().Factor = 1.0f;
+
+        TArray<FVmdMorphFrameData>& TrWide = OutMorphTracks.Add(TEXT("Wide")).Frames;
+        TrWide = { { 3, -2.5f }, { 300000, 7.25f }, { 300001, 0.125f } };
+
+        /** Frames edited by hand may go backwards */
+        TArray<FVmdMorphFrameData>& TrConstant = OutMorphTracks.Add(TEXT("Constant")).Frames;
+        TrConstant = { { 10, 0.3f }, { 5, 0.3f }, { 20, 0.3f } };
+
+        OutMorphTracks.Add(TEXT("Empty"));
+
+        for (int32 Idx = 0; Idx < 50; ++Idx)
+        {
+            FVmdCameraFrameData& TrFrame = OutCameraFrames.AddZeroed_GetRef();
+            TrFrame.Frame = (uint32)Idx * 7;
+            TrFrame.Length = TsRandom.FRandRange(-100.0f, 0.0f);
+            TrFrame.Location = FVector(TsRandom.FRand(), -TsRandom.FRand(), 1000.0f * TsRandom.FRand());
+            TrFrame.Rotate = FVector(TsRandom.FRand(), TsRandom.FRand(), -6.0f * TsRandom.FRand());
+            TrFrame.ViewingAngle = 30 + Idx;
+            TrFrame.Perspective = (uint8)(Idx & 1);
+            for (uint8& IterByte : TrFrame.Interpolation)
+            {
+                IterByte = (uint8)TsRandom.RandHelper(128);
+            }
+        }
+    }
+
+    bool IsSameCameraFrame(const FVmdCameraFrameData& A, const FVmdCameraFrameData& B)
+    {
+        return A.Frame == B.Frame && A.Length == B.Length && A.Location == B.Location && A.Rotate == B.Rotate
+            && A.ViewingAngle == B.ViewingAngle && A.Perspective == B.Perspective
+            && FMemory::Memcmp(A.Interpolation, B.Interpolation, sizeof(A.Interpolation)) == 0;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdCompactTracksRoundTripTest, "MmdHelper.Vmd.CompactTracks.RoundTrip", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdCompactTracksRoundTripTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdCompactTracksTestPrivate;
+
+    TMap<FString, FVmdMorphTrackData> TsMorphTracks;
+    TArray<FVmdCameraFrameData> TsCameraFrames;
+    MakeTracks(TsMorphTracks, TsCameraFrames);
+
+    TArray<uint8> TsBlob;
+    FVmdCompactTracks::Encode(TsMorphTracks, TsCameraFrames, TsBlob);
+
+    TMap<FString, FVmdMorphTrackData> TsDecodedTracks;
+    TArray<FVmdCameraFrameData> TsDecodedFrames;
+    if (!TestTrue(TEXT("Decode"), FVmdCompactTracks::Decode(TsBlob, TsDecodedTracks, TsDecodedFrames)))
+    {
+        return false;
+    }
+
+    TestEqual(TEXT("Track count"), TsDecodedTracks.Num(), TsMorphTracks.Num());
+    for (const TPair<FString, FVmdMorphTrackData>& IterTrack : TsMorphTracks)
+    {
+        const FVmdMorphTrackData* TpDecoded = TsDecodedTracks.Find(IterTrack.Key);
+        const TArray<FVmdMorphFrameData>& TrFrames = IterTrack.Value.Frames;
+        if (!TestNotNull(*FString::Printf(TEXT("Track %s"), *IterTrack.Key), TpDecoded) || !TestEqual(TEXT("Frame count"), TpDecoded->Frames.Num(), TrFrames.Num()))
+        {
+            continue;
+        }
+
+        /** Half a quantization step of the track range, ends of the range are exact */
+        float TfMin = TNumericLimits<float>::Max();
+        float TfMax = TNumericLimits<float>::Lowest();
+        for (const FVmdMorphFrameData& IterFrame : TrFrames)
+        {
+            TfMin = FMath::Min(TfMin, IterFrame.Factor);
+            TfMax = FMath::Max(TfMax, IterFrame.Factor);
+        }
+        const float TfBound = (TfMax - TfMin) / FVmdCompactTracks::FactorSteps * 0.5f + UE_KINDA_SMALL_NUMBER * 0.01f;
+
+        for (int32 Idx = 0; Idx < TrFrames.Num(); ++Idx)
+        {
+            const FVmdMorphFrameData& TrDecoded = TpDecoded->Frames[Idx];
+            TestEqual(TEXT("Frame"), (int64)TrDecoded.Frame, (int64)TrFrames[Idx].Frame);
+            TestTrue(FString::Printf(TEXT("Factor within step, track=%s index=%d"), *IterTrack.Key, Idx), FMath::Abs(TrDecoded.Factor - TrFrames[Idx].Factor) <= TfBound);
+            if (TrFrames[Idx].Factor == TfMin || TrFrames[Idx].Factor == TfMax)
+            {
+                TestEqual(TEXT("Range end is exact"), TrDecoded.Factor, TrFrames[Idx].Factor);
+            }
+        }
+    }
+
+    if (TestEqual(TEXT("Camera frame count"), TsDecodedFrames.Num(), TsCameraFrames.Num()))
+    {
+        for (int32 Idx = 0; Idx < TsCameraFrames.Num(); ++Idx)
+        {
+            TestTrue(FString::Printf(TEXT("Camera frame is lossless, index=%d"), Idx), IsSameCameraFrame(TsDecodedFrames[Idx], TsCameraFrames[Idx]));
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdCompactTracksBrokenBlobTest, "MmdHelper.Vmd.CompactTracks.BrokenBlob", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdCompactTracksBrokenBlobTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdCompactTracksTestPrivate;
+
+    AddExpectedMessage(TEXT("FVmdCompactTracks::Decode"), ELogVerbosity::Warning, EAutomationExpectedMessageFlags::Contains, 0, false);
+
+    TMap<FString, FVmdMorphTrackData> TsMorphTracks;
+    TArray<FVmdCameraFrameData> TsCameraFrames;
+    MakeTracks(TsMorphTracks, TsCameraFrames);
+
+    TArray<uint8> TsBlob;
+    FVmdCompactTracks::Encode(TsMorphTracks, TsCameraFrames, TsBlob);
+
+    TMap<FString, FVmdMorphTrackData> TsDecodedTracks;
+    TArray<FVmdCameraFrameData> TsDecodedFrames;
+
+    /** Every cut fails and leaves outputs empty */
+    for (int32 TiSize = 0; TiSize < TsBlob.Num(); TiSize += 1 + TiSize / 16)
+    {
+        const bool bDecoded = FVmdCompactTracks::Decode(TConstArrayView<uint8>(TsBlob.GetData(), TiSize), TsDecodedTracks, TsDecodedFrames);
+        TestFalse(FString::Printf(TEXT("Truncated blob, size=%d"), TiSize), bDecoded || TsDecodedTracks.Num() > 0 || TsDecodedFrames.Num() > 0);
+    }
+
+    TArray<uint8> TsTrailing = TsBlob;
+    TsTrailing.Add(0);
+    TestFalse(TEXT("Trailing bytes"), FVmdCompactTracks::Decode(TsTrailing, TsDecodedTracks, TsDecodedFrames));
+
+    TArray<uint8> TsNewer = TsBlob;
+    const uint32 TiNewerVersion = FVmdCompactTracks::FormatVersion + 1;
+    FMemory::Memcpy(TsNewer.GetData() + sizeof(uint32), &TiNewerVersion, sizeof(TiNewerVersion));
+    TestFalse(TEXT("Newer version"), FVmdCompactTracks::Decode(TsNewer, TsDecodedTracks, TsDecodedFrames));
+
+    /** Track count far beyond the blob is rejected before allocating */
+    TArray<uint8> TsHostile;
+    TsHostile.Append(TsBlob.GetData(), 2 * sizeof(uint32));
+    TsHostile.Append({ 0xFF, 0xFF, 0xFF, 0xFF, 0x07 });
+    TestFalse(TEXT("Hostile track count"), FVmdCompactTracks::Decode(TsHostile, TsDecodedTracks, TsDecodedFrames));
+    return true;
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/MotionDataAsset.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Algo/BinarySearch.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace VmdKeyReductionTestPrivate
+{
+    FVmdMorphTrackData MakeTrack(const TArray<float>& InFactors)
+    {
+        FVmdMorphTrackData TsTrack;
+        for (int32 Idx = 0; Idx < InFactors.Num(); ++Idx)
+        {
+            TsTrack.Frames.Add({ (uint32)Idx, InFactors[Idx] });
+        }
+        return TsTrack;
+    }
+
+    /** Linear interpolation of kept keys at a frame inside the track */
+    float Evaluate(const FVmdMorphTrackData& InTrack, uint32 InFrame)
+    {
+        const TArray<FVmdMorphFrameData>& TrFrames = InTrack.Frames;
+        const int32 TiNext = Algo::UpperBoundBy(TrFrames, InFrame, &FVmdMorphFrameData::Frame);
+        if (TiNext == 0 || TiNext == TrFrames.Num())
+        {
+            return TrFrames[FMath::Clamp(TiNext - 1, 0, TrFrames.Num() - 1)].Factor;
+        }
+
+        const FVmdMorphFrameData& TrPrev = TrFrames[TiNext - 1];
+        const FVmdMorphFrameData& TrNext = TrFrames[TiNext];
+        return FMath::Lerp(TrPrev.Factor, TrNext.Factor, (float)(InFrame - TrPrev.Frame) / (float)(TrNext.Frame - TrPrev.Frame));
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdKeyReductionShapesTest, "MmdHelper.Vmd.KeyReduction.Shapes", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdKeyReductionShapesTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdKeyReductionTestPrivate;
+
+    FVmdMorphTrackData TsConstant = MakeTrack({ 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f });
+    TestEqual(TEXT("Constant track drops inner keys"), TsConstant.ReduceKeys(0.001f), 4);
+    TestEqual(TEXT("Constant track keeps ends"), TsConstant.Frames.Num(), 2);
+    TestEqual(TEXT("Constant track last frame"), (int32)TsConstant.Frames.Last().Frame, 5);
+
+    FVmdMorphTrackData TsRamp = MakeTrack({ 0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f });
+    TsRamp.ReduceKeys(0.001f);
+    TestEqual(TEXT("Linear ramp keeps ends"), TsRamp.Frames.Num(), 2);
+
+    /** Corners of a step are needed to reproduce it */
+    FVmdMorphTrackData TsStep = MakeTrack({ 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f });
+    TsStep.ReduceKeys(0.001f);
+    TestEqual(TEXT("Step keeps corners"), TsStep.Frames.Num(), 4);
+    TestEqual(TEXT("Step lower corner"), (int32)TsStep.Frames[1].Frame, 3);
+    TestEqual(TEXT("Step upper corner"), (int32)TsStep.Frames[2].Frame, 4);
+
+    FVmdMorphTrackData TsShort = MakeTrack({ 0.0f, 0.0f });
+    TestEqual(TEXT("Two keys are kept"), TsShort.ReduceKeys(1.0f), 0);
+
+    FVmdMorphTrackData TsNegative = MakeTrack({ 0.0f, 0.0f, 0.0f });
+    TestEqual(TEXT("Negative tolerance keeps every key"), TsNegative.ReduceKeys(-1.0f), 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdKeyReductionSharedFrameTest, "MmdHelper.Vmd.KeyReduction.SharedFrame", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdKeyReductionSharedFrameTest::RunTest(const FString& Parameters)
+{
+    FVmdMorphTrackData TsTrack;
+    TsTrack.Frames = { { 0, 0.0f }, { 1, 0.0f }, { 2, 0.0f }, { 2, 1.0f }, { 3, 1.0f }, { 4, 1.0f } };
+    TsTrack.ReduceKeys(0.001f);
+
+    /** Both keys of frame 2 make a jump and survive in order */
+    const int32 TiShared = TsTrack.Frames.IndexOfByPredicate([](const FVmdMorphFrameData& In) { return In.Frame == 2; });
+    if (TestTrue(TEXT("Shared frame is kept"), TiShared != INDEX_NONE && TiShared + 1 < TsTrack.Frames.Num()))
+    {
+        TestEqual(TEXT("Shared frame second key"), (int32)TsTrack.Frames[TiShared + 1].Frame, 2);
+        TestEqual(TEXT("Shared frame order before"), TsTrack.Frames[TiShared].Factor, 0.0f);
+        TestEqual(TEXT("Shared frame order after"), TsTrack.Frames[TiShared + 1].Factor, 1.0f);
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdKeyReductionErrorBoundTest, "MmdHelper.Vmd.KeyReduction.ErrorBound", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdKeyReductionErrorBoundTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdKeyReductionTestPrivate;
+
+    /** Smooth curve with noise and gaps between frames, every dropped key must stay within tolerance */
+    FRandomStream TsRandom(7);
+    FVmdMorphTrackData TsSource;
+    uint32 TiFrame = 0;
+    for (int32 Idx = 0; Idx < 2000; ++Idx)
+    {
+        TiFrame += 1 + (uint32)TsRandom.RandHelper(3);
+        TsSource.Frames.Add({ TiFrame, FMath::Sin(TiFrame * 0.02f) * 0.5f + 0.5f + TsRandom.FRandRange(-0.002f, 0.002f) });
+    }
+
+    const float TfTolerance = 0.01f;
+    FVmdMorphTrackData TsReduced = TsSource;
+    const int32 TiDropped = TsReduced.ReduceKeys(TfTolerance);
+    TestEqual(TEXT("Dropped count"), TiDropped, TsSource.Frames.Num() - TsReduced.Frames.Num());
+    TestTrue(TEXT("Keys are dropped"), TiDropped > 0);
+    TestEqual(TEXT("First key kept"), (int32)TsReduced.Frames[0].Frame, (int32)TsSource.Frames[0].Frame);
+    TestEqual(TEXT("Last key kept"), (int32)TsReduced.Frames.Last().Frame, (int32)TsSource.Frames.Last().Frame);
+
+    float TfMaxError = 0.0f;
+    for (const FVmdMorphFrameData& IterFrame : TsSource.Frames)
+    {
+        TfMaxError = FMath::Max(TfMaxError, FMath::Abs(Evaluate(TsReduced, IterFrame.Frame) - IterFrame.Factor));
+    }
+    TestTrue(FString::Printf(TEXT("Error within tolerance, error=%f"), TfMaxError), TfMaxError <= TfTolerance + KINDA_SMALL_NUMBER);
+    return true;
+}
+
+#endif
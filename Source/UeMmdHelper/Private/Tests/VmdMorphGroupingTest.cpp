@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdMotionImporter.h"
+#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdFileView.h"
+#include "Helper/VmdSyntheticGenerator.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Algo/StableSort.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && !UE_BUILD_SHIPPING
+
+
+namespace VmdMorphGroupingTestPrivate
+{
+    /** Grouping the importer did before radix sorting, a map of names to frames and a stable sort of each track */
+    struct FReferenceGrouping
+    {
+        /** Names in order of first appearance in file, the order of interned name ids */
+        TArray<FString> Names;
+        TMap<FString, TArray<FVmdMorphFrameData>> Tracks;
+
+    public:
+        void Build(TConstArrayView<FVmdRawFaceRecord> InRecords)
+        {
+            for (const FVmdRawFaceRecord& IterRecord : InRecords)
+            {
+                const FString TstrName = FVmdDataHelper::ConvertFromMmdName(IterRecord.Name, sizeof(IterRecord.Name));
+                TArray<FVmdMorphFrameData>* TpFrames = Tracks.Find(TstrName);
+                if (!TpFrames)
+                {
+                    Names.Add(TstrName);
+                    TpFrames = &Tracks.Add(TstrName);
+                }
+                TpFrames->Add({ IterRecord.Frame, IterRecord.Factor });
+            }
+
+            for (TPair<FString, TArray<FVmdMorphFrameData>>& IterTrack : Tracks)
+            {
+                Algo::StableSortBy(IterTrack.Value, &FVmdMorphFrameData::Frame);
+            }
+        }
+    };
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdMorphGroupingTest, "MmdHelper.Vmd.MorphGrouping.MatchesReference", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdMorphGroupingTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdMorphGroupingTestPrivate;
+
+    struct FCase
+    {
+        int32 Faces;
+        int32 FaceNames;
+        int32 MaxFrame;
+
+        /** Rare names of the zipf tail get a single frame */
+        bool bDropsTracks;
+    };
+
+    /**
+     * Many names with few frames leave single frame tracks to drop, a short frame range repeats frame numbers inside tracks
+     * The second case is above the parallel threshold of the radix sort
+     */
+    const FCase TsCases[] = {
+        { 3000, 1500, 200, true },
+        { 100000, 300, 2000, false },
+    };
+
+    for (const FCase& IterCase : TsCases)
+    {
+        FVmdSyntheticConfig TsConfig;
+        TsConfig.BoneFrames = 0;
+        TsConfig.FaceFrames = IterCase.Faces;
+        TsConfig.FaceNames = IterCase.FaceNames;
+        TsConfig.MaxFrame = IterCase.MaxFrame;
+        TsConfig.CameraFrames = 10;
+
+        const FString TstrWhat = FString::Printf(TEXT("faces=%d names=%d"), IterCase.Faces, IterCase.FaceNames);
+        const FString TstrFilePath = FPaths::AutomationTransientDir() / FString::Printf(TEXT("MorphGrouping_%d.vmd"), IterCase.Faces);
+        if (!TestTrue(TEXT("Synthetic file written"), FVmdSyntheticGenerator::GenerateToFile(TsConfig, TstrFilePath)))
+        {
+            return false;
+        }
+
+        FReferenceGrouping TsReference;
+        {
+            FVmdFileView TsView;
+            if (TestTrue(TEXT("Synthetic file opened"), TsView.Open(TstrFilePath)))
+            {
+                TsReference.Build(TsView.GetFaceFrames());
+            }
+        }
+
+        FVmdMotionImportResult TsResult;
+        const bool bImported = FVmdMotionImporter::ImportFromVmd(TstrFilePath, TsResult, [](float) { return true; });
+        IFileManager::Get().Delete(*TstrFilePath);
+        if (!TestTrue(TEXT("Imported, ") + TstrWhat, bImported))
+        {
+            continue;
+        }
+
+        /** Tracks with less than two frames are dropped, the rest keep first appearance order */
+        TArray<FString> TsExpectedNames;
+        int32 TiDroppedNum = 0;
+        for (const FString& IterName : TsReference.Names)
+        {
+            if (TsReference.Tracks[IterName].Num() >= 2)
+            {
+                TsExpectedNames.Add(IterName);
+            }
+            else
+            {
+                ++TiDroppedNum;
+            }
+        }
+        TestTrue(TEXT("Tracks kept, ") + TstrWhat, TsExpectedNames.Num() > 0);
+        if (IterCase.bDropsTracks)
+        {
+            TestTrue(TEXT("Tracks dropped, ") + TstrWhat, TiDroppedNum > 0);
+        }
+        TestTrue(TEXT("Track names in order, ") + TstrWhat, TsResult.MorphNames == TsExpectedNames);
+        if (!TestEqual(TEXT("Track count, ") + TstrWhat, TsResult.MorphTracks.Num(), TsExpectedNames.Num()))
+        {
+            continue;
+        }
+
+        int32 TiMismatchTracks = 0;
+        for (int32 TrackIdx = 0; TrackIdx < TsExpectedNames.Num(); ++TrackIdx)
+        {
+            const TArray<FVmdMorphFrameData>& TrExpected = TsReference.Tracks[TsExpectedNames[TrackIdx]];
+            const TArray<FVmdMorphFrameData>& TrActual = TsResult.MorphTracks[TrackIdx].Frames;
+
+            /** Equal frames keep file order on both sides, so factors compare in place */
+            bool bSame = TrActual.Num() == TrExpected.Num();
+            for (int32 Idx = 0; bSame && Idx < TrExpected.Num(); ++Idx)
+            {
+                bSame = TrActual[Idx].Frame == TrExpected[Idx].Frame && TrActual[Idx].Factor == TrExpected[Idx].Factor;
+            }
+
+            if (!bSame)
+            {
+                AddError(FString::Printf(TEXT("Track differs, %s name=%s num=%d expected=%d"), *TstrWhat, *TsExpectedNames[TrackIdx], TrActual.Num(), TrExpected.Num()));
+                ++TiMismatchTracks;
+            }
+        }
+        TestEqual(TEXT("Mismatched tracks, ") + TstrWhat, TiMismatchTracks, 0);
+    }
+    return true;
+}
+
+#endif
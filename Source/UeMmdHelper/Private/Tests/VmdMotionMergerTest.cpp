@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdMotionMerger.h"
+#include "Vmd/VmdMotionImporter.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace VmdMotionMergerTestPrivate
+{
+    /** Factor tells which source a key came from */
+    void AddMorphTrack(FVmdMotionImportResult& OutResult, const FString& InName, const TArray<uint32>& InFrames, float InFactor)
+    {
+        OutResult.MorphNames.Add(InName);
+        FVmdMorphTrackData& TrTrack = OutResult.MorphTracks.AddDefaulted_GetRef();
+        for (const uint32 IterFrame : InFrames)
+        {
+            TrTrack.Frames.Add({ IterFrame, InFactor });
+        }
+    }
+
+    void AddCameraFrames(FVmdMotionImportResult& OutResult, const TArray<uint32>& InFrames, float InLength)
+    {
+        for (const uint32 IterFrame : InFrames)
+        {
+            FVmdCameraFrameData& TrFrame = OutResult.CameraFrames.AddZeroed_GetRef();
+            TrFrame.Frame = IterFrame;
+            TrFrame.Length = InLength;
+        }
+    }
+
+    /** Body with camera, facial with a shared morph, and a camera only source */
+    TArray<FVmdMotionImportResult> MakeSources()
+    {
+        TArray<FVmdMotionImportResult> TsSources;
+        TsSources.SetNum(3);
+
+        TsSources[0].TargetModelName = TEXT("Body");
+        AddMorphTrack(TsSources[0], TEXT("あ"), { 0, 10, 20 }, 1.0f);
+        AddCameraFrames(TsSources[0], { 0, 30 }, 1.0f);
+
+        AddMorphTrack(TsSources[1], TEXT("まばたき"), { 5, 6 }, 2.0f);
+        AddMorphTrack(TsSources[1], TEXT("あ"), { 10, 15 }, 2.0f);
+        AddMorphTrack(TsSources[1], TEXT("Empty"), {}, 2.0f);
+        TsSources[1].TargetModelName = TEXT("Face");
+
+        AddCameraFrames(TsSources[2], { 15, 30, 45 }, 3.0f);
+        return TsSources;
+    }
+
+    const FVmdMorphTrackData* FindTrack(const FVmdMotionImportResult& InResult, const FString& InName)
+    {
+        const int32 TiIndex = InResult.MorphNames.IndexOfByKey(InName);
+        return TiIndex != INDEX_NONE ? &InResult.MorphTracks[TiIndex] : nullptr;
+    }
+
+    /** Frame and source marker of every key, e.g. 10:2 */
+    FString DescribeMorph(const FVmdMotionImportResult& InResult, const FString& InName)
+    {
+        const FVmdMorphTrackData* TpTrack = FindTrack(InResult, InName);
+        if (!TpTrack)
+        {
+            return TEXT("None");
+        }
+
+        FString TstrResult;
+        for (const FVmdMorphFrameData& IterFrame : TpTrack->Frames)
+        {
+            TstrResult += FString::Printf(TEXT("%u:%g "), IterFrame.Frame, IterFrame.Factor);
+        }
+        return TstrResult.TrimEnd();
+    }
+
+    FString DescribeCamera(const FVmdMotionImportResult& InResult)
+    {
+        FString TstrResult;
+        for (const FVmdCameraFrameData& IterFrame : InResult.CameraFrames)
+        {
+            TstrResult += FString::Printf(TEXT("%u:%g "), IterFrame.Frame, IterFrame.Length);
+        }
+        return TstrResult.TrimEnd();
+    }
+
+    FString Describe(const FVmdMotionImportResult& InResult)
+    {
+        FString TstrResult = InResult.TargetModelName + TEXT(" | ") + DescribeCamera(InResult);
+        for (const FString& IterName : InResult.MorphNames)
+        {
+            TstrResult += FString::Printf(TEXT(" | %s %s"), *IterName, *DescribeMorph(InResult, IterName));
+        }
+        return TstrResult;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdMergeSortedFramesTest, "MmdHelper.Vmd.MotionMerger.SortedFrames", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdMergeSortedFramesTest::RunTest(const FString& Parameters)
+{
+    TArray<FVmdMorphFrameData> TsFirst = { { 0, 1.0f }, { 5, 1.0f }, { 5, 1.5f }, { 9, 1.0f } };
+    TArray<FVmdMorphFrameData> TsSecond = { { 5, 2.0f }, { 7, 2.0f } };
+    TArray<FVmdMorphFrameData> TsThird = { { 9, 3.0f }, { 9, 3.5f }, { 12, 3.0f } };
+    TArray<TArray<FVmdMorphFrameData>*> TsStreams = { &TsFirst, &TsSecond, &TsThird };
+
+    TArray<FVmdMorphFrameData> TsMerged;
+    FVmdMotionMerger::MergeSortedFrames<FVmdMorphFrameData>(TsStreams, TsMerged);
+
+    /** Repeats inside a stream stay, a later stream replaces every key of earlier ones on a shared frame */
+    const TArray<FVmdMorphFrameData> TsExpected = { { 0, 1.0f }, { 5, 2.0f }, { 7, 2.0f }, { 9, 3.0f }, { 9, 3.5f }, { 12, 3.0f } };
+    if (TestEqual(TEXT("Merged count"), TsMerged.Num(), TsExpected.Num()))
+    {
+        for (int32 Idx = 0; Idx < TsExpected.Num(); ++Idx)
+        {
+            TestEqual(FString::Printf(TEXT("Frame, index=%d"), Idx), (int32)TsMerged[Idx].Frame, (int32)TsExpected[Idx].Frame);
+            TestEqual(FString::Printf(TEXT("Factor, index=%d"), Idx), TsMerged[Idx].Factor, TsExpected[Idx].Factor);
+        }
+    }
+    TestTrue(TEXT("Streams are emptied"), TsFirst.Num() == 0 && TsSecond.Num() == 0 && TsThird.Num() == 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdMotionMergerPolicyTest, "MmdHelper.Vmd.MotionMerger.Policy", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdMotionMergerPolicyTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdMotionMergerTestPrivate;
+
+    struct FCase
+    {
+        EVmdMergePolicy Policy;
+        const TCHAR* Camera;
+        const TCHAR* SharedMorph;
+    };
+
+    /** An empty track or section never counts as present */
+    const FCase TsCases[] = {
+        { EVmdMergePolicy::KeepFirst, TEXT("0:1 30:1"), TEXT("0:1 10:1 20:1") },
+        { EVmdMergePolicy::KeepLast, TEXT("15:3 30:3 45:3"), TEXT("10:2 15:2") },
+        { EVmdMergePolicy::MergeKeys, TEXT("0:1 15:3 30:3 45:3"), TEXT("0:1 10:2 15:2 20:1") },
+    };
+
+    for (const FCase& IterCase : TsCases)
+    {
+        const FString TstrPolicy = UEnum::GetValueAsString(IterCase.Policy);
+        TArray<FVmdMotionImportResult> TsSources = MakeSources();
+        FVmdMotionImportResult TsResult;
+        FVmdMotionMerger::Merge(TsSources, IterCase.Policy, TsResult);
+
+        TestEqual(TstrPolicy + TEXT(" model name"), TsResult.TargetModelName, FString(TEXT("Body")));
+        TestEqual(TstrPolicy + TEXT(" camera"), DescribeCamera(TsResult), FString(IterCase.Camera));
+        TestEqual(TstrPolicy + TEXT(" shared morph"), DescribeMorph(TsResult, TEXT("あ")), FString(IterCase.SharedMorph));
+        TestEqual(TstrPolicy + TEXT(" single source morph"), DescribeMorph(TsResult, TEXT("まばたき")), FString(TEXT("5:2 6:2")));
+        TestNull(*(TstrPolicy + TEXT(" empty morph")), FindTrack(TsResult, TEXT("Empty")));
+        TestEqual(TstrPolicy + TEXT(" morph hashes"), TsResult.MorphHashes.Num(), TsResult.MorphTracks.Num());
+        TestTrue(TstrPolicy + TEXT(" camera hash"), TsResult.CameraHash != 0);
+
+        for (const FVmdMotionImportResult& IterSource : TsSources)
+        {
+            TestTrue(TstrPolicy + TEXT(" source is released"), IterSource.MorphTracks.Num() == 0 && IterSource.CameraFrames.Num() == 0);
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdMotionMergerIncrementalTest, "MmdHelper.Vmd.MotionMerger.Incremental", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdMotionMergerIncrementalTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdMotionMergerTestPrivate;
+
+    for (const EVmdMergePolicy IterPolicy : { EVmdMergePolicy::KeepFirst, EVmdMergePolicy::KeepLast, EVmdMergePolicy::MergeKeys })
+    {
+        const FString TstrPolicy = UEnum::GetValueAsString(IterPolicy);
+
+        TArray<FVmdMotionImportResult> TsSources = MakeSources();
+        FVmdMotionImportResult TsMerged;
+        FVmdMotionMerger::Merge(TsSources, IterPolicy, TsMerged);
+
+        /** Folding sources one by one, like LoadFromVmdFile does right after each import */
+        TsSources = MakeSources();
+        FVmdMotionImportResult TsFolded;
+        for (FVmdMotionImportResult& IterSource : TsSources)
+        {
+            FVmdMotionMerger::MergeInto(TsFolded, IterSource, IterPolicy);
+            TestEqual(TstrPolicy + TEXT(" hashes cleared while folding"), TsFolded.MorphHashes.Num(), 0);
+        }
+        TsFolded.ComputeHashes();
+
+        TestEqual(TstrPolicy + TEXT(" same as merge"), Describe(TsFolded), Describe(TsMerged));
+        TestTrue(TstrPolicy + TEXT(" same hashes"), TsFolded.CameraHash == TsMerged.CameraHash && TsFolded.MorphHashes == TsMerged.MorphHashes);
+    }
+    return true;
+}
+
+#endif
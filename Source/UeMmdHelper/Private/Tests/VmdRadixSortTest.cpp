@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdRadixSort.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Algo/StableSort.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+
+namespace VmdRadixSortTestPrivate
+{
+    struct FSortItem
+    {
+        uint32 Key;
+
+        /** Position in input, tells whether equal keys kept their order */
+        int32 Order;
+    };
+
+    TArray<FSortItem> MakeItems(int32 InNum, uint32 InKeyMask, int32 InSeed)
+    {
+        FRandomStream TsRandom(InSeed);
+        TArray<FSortItem> TsItems;
+        TsItems.SetNumUninitialized(InNum);
+        for (int32 Idx = 0; Idx < InNum; ++Idx)
+        {
+            TsItems[Idx] = { TsRandom.GetUnsignedInt() & InKeyMask, Idx };
+        }
+        return TsItems;
+    }
+
+    /** Radix sort must give exactly what a stable comparison sort gives */
+    bool IsSameAsStableSort(const TArray<FSortItem>& InItems, bool bInParallel)
+    {
+        TArray<FSortItem> TsExpected = InItems;
+        Algo::StableSortBy(TsExpected, &FSortItem::Key);
+
+        TArray<FSortItem> TsSorted = InItems;
+        VmdRadixSort::SortByKey(TsSorted, [](const FSortItem& In) { return In.Key; }, bInParallel);
+
+        return TsSorted.Num() == TsExpected.Num() && FMemory::Memcmp(TsSorted.GetData(), TsExpected.GetData(), TsSorted.Num() * sizeof(FSortItem)) == 0;
+    }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdRadixSortSortedInputTest, "MmdHelper.Vmd.RadixSort.SortedInput", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdRadixSortSortedInputTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdRadixSortTestPrivate;
+
+    TArray<FSortItem> TsEmpty;
+    TestFalse(TEXT("Empty input is sorted"), VmdRadixSort::SortByKey(TsEmpty, [](const FSortItem& In) { return In.Key; }));
+
+    TArray<FSortItem> TsItems = { { 1, 0 }, { 1, 1 }, { 5, 2 }, { 9, 3 } };
+    const TArray<FSortItem> TsOriginal = TsItems;
+    TestFalse(TEXT("Sorted input is detected"), VmdRadixSort::SortByKey(TsItems, [](const FSortItem& In) { return In.Key; }));
+    TestTrue(TEXT("Sorted input is untouched"), FMemory::Memcmp(TsItems.GetData(), TsOriginal.GetData(), TsItems.Num() * sizeof(FSortItem)) == 0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdRadixSortStableTest, "MmdHelper.Vmd.RadixSort.Stable", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdRadixSortStableTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdRadixSortTestPrivate;
+
+    /** Few distinct keys, most items share a key with others */
+    TestTrue(TEXT("Repeated keys"), IsSameAsStableSort(MakeItems(5000, 0x1F, 1), false));
+
+    /** Keys varying in every byte, and in the high byte only, which skips the lower passes */
+    TestTrue(TEXT("Full width keys"), IsSameAsStableSort(MakeItems(5000, 0xFFFFFFFF, 2), false));
+    TestTrue(TEXT("High byte keys"), IsSameAsStableSort(MakeItems(5000, 0xFF000000, 3), false));
+
+    TArray<FSortItem> TsReversed;
+    for (int32 Idx = 0; Idx < 300; ++Idx)
+    {
+        TsReversed.Add({ (uint32)(300 - Idx) / 2, Idx });
+    }
+    TestTrue(TEXT("Reversed keys"), IsSameAsStableSort(TsReversed, false));
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVmdRadixSortParallelTest, "MmdHelper.Vmd.RadixSort.Parallel", EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FVmdRadixSortParallelTest::RunTest(const FString& Parameters)
+{
+    using namespace VmdRadixSortTestPrivate;
+
+    /** Above threshold with a partial last chunk, chunks must be stitched in order inside each bucket */
+    const int32 TiNum = VmdRadixSort::ParallelThreshold * 2 + 123;
+    TestTrue(TEXT("Parallel repeated keys"), IsSameAsStableSort(MakeItems(TiNum, 0xFF0F, 4), true));
+    TestTrue(TEXT("Parallel full width keys"), IsSameAsStableSort(MakeItems(TiNum, 0xFFFFFFFF, 5), true));
+    return true;
+}
+
+#endif
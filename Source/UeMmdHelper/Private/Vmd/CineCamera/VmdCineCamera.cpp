@@ -6,7 +6,9 @@
 #include "UeMmdHelper.h"
 #include "Vmd/CineCamera/VmdCineCameraComponent.h"
 #include "Vmd/MotionDataAsset.h"
+#include "Vmd/VmdContentHash.h"
 #include "Helper/MmdSequencerHelper.h"
+#include "Algo/Transform.h"
 
 
 #if WITH_EDITOR
@@ -71,6 +73,34 @@ void AVmdCineCamera::SyncCameraMotion()
 
     UE_LOG(LogMmdHelper, Log, TEXT("AMmdCamera::ApplyCineCameraMotions: Camera=%p)%s"), this, *GetNameSafe(this));
     const FScopedTransaction Transaction(LOCTEXT("ApplyCineCameraMotions", "Apply VMD Camera motions"));
+
+    /** All tracks are built from camera frames and config only */
+    const uint64 TiCameraHash = TpMotionData->GetContentHashes().Camera;
+    const FQuat TsCenterRot = TsTargetTrans.GetRotation();
+    const FVector TsCenterLoc = TsTargetTrans.GetLocation();
+    const FVector TsCenterScale = TsTargetTrans.GetScale3D();
+    const uint64 TiSyncKey = TiCameraHash == FVmdContentHash::None ? FVmdContentHash::None : FVmdContentHash::Combine(
+        TiCameraHash, TfDistScaleBias, GetViewAngelBias(), bBakeInterpolation, TpLevelSeq->GetPathName(),
+        TsCenterLoc.X, TsCenterLoc.Y, TsCenterLoc.Z,
+        TsCenterRot.X, TsCenterRot.Y, TsCenterRot.Z, TsCenterRot.W,
+        TsCenterScale.X, TsCenterScale.Y, TsCenterScale.Z
+    );
+
+    if (bSkipUnchangedSync && TiSyncKey != FVmdContentHash::None && TiSyncKey == SyncedCameraKey)
+    {
+        /** Lookups only, bindings are created on the path that writes keys */
+        const FGuid TsActorGuid = UMmdSequencerHelper::FindBindingInLevelSequence(this, TpLevelSeq);
+        const FGuid TsComponentGuid = UMmdSequencerHelper::FindBindingInLevelSequence(GetCineCameraComponent(), TpLevelSeq);
+        if (TsActorGuid.IsValid() && TsComponentGuid.IsValid()
+            && TpMovieScene->FindTrack<UMovieScene3DTransformTrack>(TsActorGuid)
+            && TpMovieScene->FindTrack<UMovieSceneFloatTrack>(TsComponentGuid, CameraFovName)
+            && TpMovieScene->FindTrack<UMovieSceneByteTrack>(TsComponentGuid, ProjectionModeName))
+        {
+            UE_LOG(LogMmdHelper, Log, TEXT("AMmdCamera::ApplyCineCameraMotions: Skipped unchanged, motion=%s"), *GetNameSafe(TpMotionData));
+            return;
+        }
+    }
+
     FScopedSlowTask SlowTask(3.0f, FText::Format(LOCTEXT("BeginSyncMotionDatas", "Sync motion data {0}"), FText::FromName(TpMotionData->GetFName())));
     SlowTask.MakeDialog(false/*bShowCancelButton*/, true/*bAllowInPIE*/);
 
@@ -78,6 +108,32 @@ void AVmdCineCamera::SyncCameraMotion()
     FFrameRate TickResolution = TpMovieScene->GetTickResolution();
     FFrameRate DisplayRate = TpMovieScene->GetDisplayRate();
 
+    /** Baked frames already follow the easing, they are joined linearly */
+    const TArray<FVmdCameraFrameData>& TrKeyFrames = TpMotionData->GetCameraFrames();
+    TArray<FVmdCameraFrameData> TsBakedFrames;
+    TArray<float> TsViewAngles;
+    if (bBakeInterpolation)
+    {
+        UMmdSequencerHelper::SampleCameraFrames(TrKeyFrames, TsBakedFrames, TsViewAngles);
+    }
+    else
+    {
+        Algo::Transform(TrKeyFrames, TsViewAngles, [](const FVmdCameraFrameData& InFrame) { return (float)InFrame.ViewingAngle; });
+    }
+    const TArray<FVmdCameraFrameData>& TrCameraFrames = bBakeInterpolation ? TsBakedFrames : TrKeyFrames;
+
+    auto AddKey = [this](auto* InChannel, FFrameNumber InFrame, auto InValue)
+        {
+            if (bBakeInterpolation)
+            {
+                InChannel->AddLinearKey(InFrame, InValue);
+            }
+            else
+            {
+                InChannel->AddCubicKey(InFrame, InValue);
+            }
+        };
+
     //////////////////////////////////////////////////////////////////////////
     /** Processing camera transform track */
     do
@@ -101,25 +157,25 @@ void AVmdCineCamera::SyncCameraMotion()
         TransformTrack->AddSection(*TransformSection);
         TransformSection->SetRange(TRange<FFrameNumber>::All());
 
+        TArray<FTransform> TsFinalTransforms;
+        UMmdSequencerHelper::ConvertCameraFrames(TrCameraFrames, TsTargetTrans, TfDistScaleBias, TsFinalTransforms);
+
         FMovieSceneChannelProxy& TrChanelProxy = TransformSection->GetChannelProxy();
-        for (const FVmdCameraFrameData& IterCameraFrame : TpMotionData->CameraFrames)
+        for (int32 FrameIdx = 0; FrameIdx < TsFinalTransforms.Num(); ++FrameIdx)
         {
+            const FVmdCameraFrameData& IterCameraFrame = TrCameraFrames[FrameIdx];
             const FFrameNumber TsCurFrame = FFrameRate::TransformTime(FFrameNumber((int32)IterCameraFrame.Frame), DisplayRate, TickResolution).GetFrame();
 
-            const FVector TfvCenterOffset = FVector(IterCameraFrame.Location.Z, IterCameraFrame.Location.X, IterCameraFrame.Location.Y) * TfDistScaleBias;
-            const FRotator TfrRot = FRotator(-IterCameraFrame.Rotate.X, -IterCameraFrame.Rotate.Y, IterCameraFrame.Rotate.Z);
-            const float TfCameraLen = IterCameraFrame.Length * TfDistScaleBias;
-
-            const FTransform TsFinalTrans = UMmdSequencerHelper::GetConvertedCameraTrans(TsTargetTrans, TfvCenterOffset, TfrRot, TfCameraLen);
+            const FTransform& TsFinalTrans = TsFinalTransforms[FrameIdx];
             const FRotator& TfrFinalRot = TsFinalTrans.GetRotation().Rotator();
 
-            TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(0)->AddCubicKey(TsCurFrame, TsFinalTrans.GetLocation().X);
-            TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(1)->AddCubicKey(TsCurFrame, TsFinalTrans.GetLocation().Y);
-            TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(2)->AddCubicKey(TsCurFrame, TsFinalTrans.GetLocation().Z);
+            AddKey(TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(0), TsCurFrame, TsFinalTrans.GetLocation().X);
+            AddKey(TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(1), TsCurFrame, TsFinalTrans.GetLocation().Y);
+            AddKey(TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(2), TsCurFrame, TsFinalTrans.GetLocation().Z);
 
-            TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(3)->AddCubicKey(TsCurFrame, TfrFinalRot.Roll);
-            TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(4)->AddCubicKey(TsCurFrame, TfrFinalRot.Pitch);
-            TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(5)->AddCubicKey(TsCurFrame, TfrFinalRot.Yaw);
+            AddKey(TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(3), TsCurFrame, TfrFinalRot.Roll);
+            AddKey(TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(4), TsCurFrame, TfrFinalRot.Pitch);
+            AddKey(TrChanelProxy.GetChannel<FMovieSceneDoubleChannel>(5), TsCurFrame, TfrFinalRot.Yaw);
 
         }
     } while (false);
@@ -151,11 +207,11 @@ void AVmdCineCamera::SyncCameraMotion()
 
         const float TfFovScale = GetViewAngelBias();
 
-        for (const FVmdCameraFrameData& IterCameraFrame : TpMotionData->CameraFrames)
+        for (int32 FrameIdx = 0; FrameIdx < TrCameraFrames.Num(); ++FrameIdx)
         {
-            FovSection->GetChannel().AddCubicKey(
-                FFrameRate::TransformTime(FFrameNumber((int32)IterCameraFrame.Frame), DisplayRate, TickResolution).GetFrame(),
-                IterCameraFrame.ViewingAngle * TfFovScale
+            AddKey(&FovSection->GetChannel(),
+                FFrameRate::TransformTime(FFrameNumber((int32)TrCameraFrames[FrameIdx].Frame), DisplayRate, TickResolution).GetFrame(),
+                TsViewAngles[FrameIdx] * TfFovScale
             );
         }
     } while (false);
@@ -185,7 +241,7 @@ void AVmdCineCamera::SyncCameraMotion()
 
         FMovieSceneByteChannel* Channel = ProjectionModeSection->GetChannelProxy().GetChannel<FMovieSceneByteChannel>(0);
 
-        for (const FVmdCameraFrameData& IterCameraFrame : TpMotionData->CameraFrames)
+        for (const FVmdCameraFrameData& IterCameraFrame : TpMotionData->GetCameraFrames())
         {
             Channel->GetData().AddKey(
                 FFrameRate::TransformTime(FFrameNumber((int32)IterCameraFrame.Frame), DisplayRate, TickResolution).GetFrame(),
@@ -194,6 +250,9 @@ void AVmdCineCamera::SyncCameraMotion()
         }
 
     } while (false);
+
+    Modify();
+    SyncedCameraKey = TiSyncKey;
 #endif
 }
 
@@ -2,130 +2,339 @@
 
 
 #include "Vmd/MotionDataAsset.h"
-#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdMotionImporter.h"
+#include "Vmd/VmdCompactTracks.h"
+#include "Vmd/VmdContentHash.h"
+#include "Vmd/VmdMotionMerger.h"
 #include "UeMmdHelper.h"
 #include "UObject/ObjectSaveContext.h"
+#include "Serialization/CustomVersion.h"
+#include "Curves/RichCurve.h"
+#include "Async/Async.h"
+#include "Misc/AsyncTaskNotification.h"
+#include "Misc/Paths.h"
+#include "Tasks/Task.h"
 
 
 
 #define LOCTEXT_NAMESPACE "VmdDataAsset"
 
-
-void UMotionDataAsset::LoadFromVmdFile()
+namespace MotionDataAssetPrivate
 {
-#if WITH_EDITOR
-    FScopedSlowTask SlowTask(3.0f, LOCTEXT("LoadFromVmdFile", "Load motion data from file"));
-    SlowTask.MakeDialog(false/*bShowCancelButton*/, true/*bAllowInPIE*/);
+    struct FMotionDataAssetVersion
+    {
+        enum Type
+        {
+            BeforeCustomVersion = 0,
 
-    SlowTask.EnterProgressFrame(1.0f, LOCTEXT("LoadData", "Serialize file data"));
-    FVmdData TsVmdData;
-    FVmdDataHelper::LoadVmdDataFromFile(MotionPath.FilePath, TsVmdData);
-    TsVmdData.PrintOutData();
+            /** Optional compact track blob after tagged properties */
+            CompactTracks,
 
-    TargetModelName = FVmdDataHelper::ConvertFromMmdName(TsVmdData.GetVmdHeader().TargetModelName);
+            VersionPlusOne,
+            LatestVersion = VersionPlusOne - 1
+        };
 
-    SlowTask.EnterProgressFrame(1.0f, LOCTEXT("CameraFrame", "Converting camera frame"));
-    const FVmdBoneTracks& TsVmdTracks = TsVmdData.GetTrackData();
+        static const FGuid GUID;
+    };
 
-    CameraFrames.Empty(TsVmdTracks.CameraFrames.Num());
-    for (const FVmdCameraFrame& IterRawFrame : TsVmdTracks.CameraFrames)
-    {
-        FVmdCameraFrameData& TrAdded = CameraFrames.AddZeroed_GetRef();
-        TrAdded.Frame = IterRawFrame.Frame;
-        TrAdded.Length = IterRawFrame.Length;
-        TrAdded.Location = FVector(IterRawFrame.Location[0], IterRawFrame.Location[1], IterRawFrame.Location[2]);
-        TrAdded.Rotate = FVector(
-            -FMath::RadiansToDegrees(IterRawFrame.Rotate[0]),
-            FMath::RadiansToDegrees(IterRawFrame.Rotate[1]),
-            FMath::RadiansToDegrees(IterRawFrame.Rotate[2])
-        );
-
-        TrAdded.ViewingAngle = IterRawFrame.ViewingAngle;
-        TrAdded.Perspective = IterRawFrame.Perspective;
-    }
+    const FGuid FMotionDataAssetVersion::GUID(0x5A1F3C27, 0x8E4B4D61, 0x9C2A7E15, 0x3B6D0F48);
+    static FCustomVersionRegistration GRegisterMotionDataAssetVersion(FMotionDataAssetVersion::GUID, FMotionDataAssetVersion::LatestVersion, TEXT("MotionDataAssetVer"));
+}
 
-    Algo::Sort(CameraFrames, [&](const FVmdCameraFrameData& A, const FVmdCameraFrameData& B)
-        {
-            return A.Frame < B.Frame;
-        });
 
-    SlowTask.EnterProgressFrame(1.0f, LOCTEXT("MorphFrame", "Converting morph frame"));
+void UMotionDataAsset::LoadFromVmdFile()
+{
+#if WITH_EDITOR
+    check(IsInGameThread());
 
-    MorphTracks.Empty(0);
+    if (bImportRunning)
     {
-        TMap<FString, FVmdMorphTrackData> TmapTracks;
+        UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::LoadFromVmdFile: Import already running, asset=%s"), *GetPathName());
+        return;
+    }
+    bImportRunning = true;
 
-        /** Read raw data into mapped data */
-        for (const FVmdFaceFrame& IterRawFrame : TsVmdTracks.FaceFrames)
+    /** Shared with the import task, which holds no UObject */
+    struct FImportState
+    {
+        FString FilePath;
+        TArray<FString> ExtraFilePaths;
+        EVmdMergePolicy MergePolicy = EVmdMergePolicy::KeepLast;
+        bool bUseCache = true;
+        bool bImported = false;
+        bool bCancelled = false;
+        FVmdMotionImportResult Result;
+        TUniquePtr<FAsyncTaskNotification> Notification;
+    };
+
+    TSharedRef<FImportState> TsState = MakeShared<FImportState>();
+    TsState->FilePath = MotionPath.FilePath;
+    TsState->MergePolicy = MergePolicy;
+    TsState->bUseCache = bUseImportCache;
+    for (const FFilePath& IterPath : ExtraMotionPaths)
+    {
+        if (!IterPath.FilePath.IsEmpty())
         {
-            const FString TstrName = FVmdDataHelper::ConvertFromMmdName(IterRawFrame.Name);
-
-            FVmdMorphTrackData& TrTrack = TmapTracks.FindOrAdd(TstrName);
-            FVmdMorphFrameData& TrAdded = TrTrack.Frames.AddZeroed_GetRef();
-
-            TrAdded.Frame = IterRawFrame.Frame;
-            TrAdded.Factor = IterRawFrame.Factor;
+            TsState->ExtraFilePaths.Add(IterPath.FilePath);
         }
+    }
 
-        /** Filter frame data */
-        for (TPair<FString, FVmdMorphTrackData>& IterMorphTrack : TmapTracks)
+    FAsyncTaskNotificationConfig TsConfig;
+    TsConfig.TitleText = FText::Format(LOCTEXT("LoadFromVmdFile", "Load motion data from {0}"), FText::FromString(FPaths::GetCleanFilename(TsState->FilePath)));
+    TsConfig.ProgressText = LOCTEXT("LoadData", "Converting file data");
+    TsConfig.bCanCancel = true;
+    TsConfig.LogCategory = &LogMmdHelper;
+    TsState->Notification = MakeUnique<FAsyncTaskNotification>(TsConfig);
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [TsState, TpAssetWeak = TWeakObjectPtr<UMotionDataAsset>(this)]()
         {
-            const FString& TrName = IterMorphTrack.Key;
-            FVmdMorphTrackData& TrTrack = IterMorphTrack.Value;
+            /** Sources are imported one by one, progress of each takes an equal share */
+            TArray<FString> TsFilePaths = { TsState->FilePath };
+            TsFilePaths.Append(TsState->ExtraFilePaths);
 
-            /** Ignore empty data */
-            if (TrTrack.Frames.Num() == 0)
-            {
-                UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::LoadFromVmdFile:(Filter) remov empty, name=%s"),
-                    *TrName
-                );
-                continue;
-            }
+            /** Each source is folded into the result right after import, so only one source is held besides the result */
+            FVmdMotionImportResult TsSource;
 
-            /** Ignore data with only one frame */
-            if (TrTrack.Frames.Num() == 1)
+            /** Notification text is only touched when the shown percent changes */
+            int32 TiLastPercent = -1;
+            TsState->bImported = true;
+            for (int32 SourceIdx = 0; SourceIdx < TsFilePaths.Num() && TsState->bImported; ++SourceIdx)
             {
-                if (TrTrack.Frames[0].Factor != 0.0f)
+                FVmdMotionImportResult& TrTarget = SourceIdx == 0 ? TsState->Result : TsSource;
+                TsState->bImported = FVmdMotionImporter::ImportFromFile(TsFilePaths[SourceIdx], TrTarget, TsState->bUseCache, [&](float InProgress)
+                    {
+                        if (TsState->Notification->GetPromptAction() == EAsyncTaskNotificationPromptAction::Cancel)
+                        {
+                            TsState->bCancelled = true;
+                            return false;
+                        }
+
+                        const int32 TiPercent = FMath::FloorToInt32((SourceIdx + InProgress) * 100.0f / TsFilePaths.Num());
+                        if (TiPercent != TiLastPercent)
+                        {
+                            TiLastPercent = TiPercent;
+                            TsState->Notification->SetProgressText(FText::Format(LOCTEXT("LoadDataProgress", "Converting file data {0}%"), TiPercent));
+                        }
+                        return true;
+                    });
+
+                if (!TsState->bImported)
                 {
-                    UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::LoadFromVmdFile:(Filter) Ignored factor not zero"));
+                    /** Failing source is the one reported */
+                    TsState->FilePath = TsFilePaths[SourceIdx];
                 }
-
-                if (TrTrack.Frames[0].Frame != 0)
+                else if (SourceIdx > 0)
                 {
-                    UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::LoadFromVmdFile:(Filter) Ignored frame not zero"));
+                    FVmdMotionMerger::MergeInto(TsState->Result, TsSource, TsState->MergePolicy);
                 }
+            }
 
-                UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::LoadFromVmdFile:(Filter) remov single frame, name=%s"),
-                    *TrName
+            /** A single source keeps the hashes computed by importer */
+            if (TsState->bImported && TsFilePaths.Num() > 1)
+            {
+                TsState->Result.ComputeHashes();
+                UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::LoadFromVmdFile: Merged, sources=%d morphTracks=%d policy=%s"),
+                    TsFilePaths.Num(),
+                    TsState->Result.MorphTracks.Num(),
+                    *UEnum::GetValueAsString(TsState->MergePolicy)
                 );
-                continue;
             }
 
-            /** Insert data */
-            MorphTracks.Add(IterMorphTrack);
+            /** Asset is only touched on game thread, it may have been destroyed meanwhile */
+            AsyncTask(ENamedThreads::GameThread, [TsState, TpAssetWeak]()
+                {
+                    UMotionDataAsset* TpAsset = TpAssetWeak.Get();
+                    if (TpAsset)
+                    {
+                        TpAsset->bImportRunning = false;
+                    }
+
+                    if (TsState->bCancelled)
+                    {
+                        TsState->Notification->SetComplete(LOCTEXT("LoadCancelled", "Load motion data cancelled"), FText::GetEmpty(), false);
+                        return;
+                    }
+
+                    if (!TsState->bImported)
+                    {
+                        UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::LoadFromVmdFile: Bad vmd file, path=%s"), *TsState->FilePath);
+                        TsState->Notification->SetComplete(LOCTEXT("LoadFailed", "Load motion data failed"), FText::FromString(TsState->FilePath), false);
+                        return;
+                    }
+
+                    if (!TpAsset)
+                    {
+                        UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::LoadFromVmdFile: Asset destroyed before import finished, path=%s"), *TsState->FilePath);
+                        TsState->Notification->SetComplete(LOCTEXT("LoadFailed", "Load motion data failed"), FText::FromString(TsState->FilePath), false);
+                        return;
+                    }
+
+                    TpAsset->ApplyImportResult(MoveTemp(TsState->Result));
+                    TsState->Notification->SetComplete(LOCTEXT("LoadDone", "Load motion data done"), FText::FromString(TpAsset->GetName()), true);
+                });
+        });
+#endif
+}
+
+
+void UMotionDataAsset::ApplyImportResult(FVmdMotionImportResult&& InResult)
+{
+    /** Kept tracks come from stored data, and undo buffer records tracks, so both need them decoded first */
+    DecodeCompactTracks();
+
+    Modify();
+
+    TargetModelName = MoveTemp(InResult.TargetModelName);
+
+    /** Sections with unchanged content hash keep their stored frames */
+    int32 TiRebuiltSections = 0;
+    auto ApplySection = [&TiRebuiltSections](auto& OutFrames, auto& InFrames, uint64& InOutHash, uint64 InHash)
+        {
+            if (InHash != FVmdContentHash::None && InHash == InOutHash)
+            {
+                return;
+            }
+
+            OutFrames = MoveTemp(InFrames);
+            InOutHash = InHash;
+            ++TiRebuiltSections;
+        };
+
+    ApplySection(CameraFrames, InResult.CameraFrames, ContentHashes.Camera, InResult.CameraHash);
+    ApplySection(LightFrames, InResult.LightFrames, ContentHashes.Light, InResult.LightHash);
+    ApplySection(SelfShadowFrames, InResult.SelfShadowFrames, ContentHashes.SelfShadow, InResult.SelfShadowHash);
+    ApplySection(IkFrames, InResult.IkFrames, ContentHashes.Ik, InResult.IkHash);
+
+    /** Stored morph tracks are reduced, so their hash also covers the reduction settings */
+    const uint64 TiBuildHash = FVmdContentHash::Combine(bReduceMorphKeys, bReduceMorphKeys ? MorphReductionTolerance : 0.0f);
+    const bool bHasMorphHashes = InResult.MorphHashes.Num() == InResult.MorphTracks.Num();
+
+    TMap<FString, FVmdMorphTrackData> TsOldTracks = MoveTemp(MorphTracks);
+    TMap<FString, uint64> TsOldHashes = MoveTemp(ContentHashes.MorphTracks);
+    MorphTracks.Empty(InResult.MorphTracks.Num());
+    ContentHashes.MorphTracks.Empty(InResult.MorphTracks.Num());
+
+    int32 TiKeptTracks = 0;
+    MorphReductionStats = FVmdKeyReductionStats();
+    for (int32 TrackIdx = 0; TrackIdx < InResult.MorphTracks.Num(); ++TrackIdx)
+    {
+        FString& TrName = InResult.MorphNames[TrackIdx];
+        FVmdMorphTrackData& TrSourceTrack = InResult.MorphTracks[TrackIdx];
+        const uint64 TiHash = bHasMorphHashes ? FVmdContentHash::Combine(InResult.MorphHashes[TrackIdx], TiBuildHash) : FVmdContentHash::None;
+
+        const uint64* TpOldHash = TsOldHashes.Find(TrName);
+        FVmdMorphTrackData* TpOldTrack = TsOldTracks.Find(TrName);
+        const bool bKeep = TiHash != FVmdContentHash::None && TpOldHash && *TpOldHash == TiHash && TpOldTrack;
+
+        MorphReductionStats.KeysBefore += TrSourceTrack.Frames.Num();
+        FVmdMorphTrackData& TrTrack = MorphTracks.Add(TrName, bKeep ? MoveTemp(*TpOldTrack) : MoveTemp(TrSourceTrack));
+        if (bKeep)
+        {
+            ++TiKeptTracks;
+            if (TrTrack.Frames.Num() < TrSourceTrack.Frames.Num())
+            {
+                ++MorphReductionStats.ReducedTracks;
+            }
+        }
+        else if (bReduceMorphKeys && TrTrack.ReduceKeys(MorphReductionTolerance) > 0)
+        {
+            ++MorphReductionStats.ReducedTracks;
+        }
+        MorphReductionStats.KeysAfter += TrTrack.Frames.Num();
+
+        if (TiHash != FVmdContentHash::None)
+        {
+            ContentHashes.MorphTracks.Add(MoveTemp(TrName), TiHash);
         }
     }
 
-    /** Sort the frame data */
-    for (TPair<FString, FVmdMorphTrackData>& IterMorphTrack : MorphTracks)
+    int32 TiRemovedTracks = 0;
+    for (const TPair<FString, FVmdMorphTrackData>& IterTrack : TsOldTracks)
     {
-        const FString& TrName = IterMorphTrack.Key;
-        FVmdMorphTrackData& TrTrack = IterMorphTrack.Value;
-        Algo::Sort(TrTrack.Frames, [&](const FVmdMorphFrameData& A, const FVmdMorphFrameData& B)
-            {
-                return A.Frame < B.Frame;
-            });
+        TiRemovedTracks += MorphTracks.Contains(IterTrack.Key) ? 0 : 1;
+    }
 
-        UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::LoadFromVmdFile: Morph track, name=%s num=%d"),
-            *TrName,
-            TrTrack.Frames.Num()
+    UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::ApplyImportResult: Applied, rebuiltSections=%d keptTracks=%d rebuiltTracks=%d removedTracks=%d"),
+        TiRebuiltSections,
+        TiKeptTracks,
+        MorphTracks.Num() - TiKeptTracks,
+        TiRemovedTracks
+    );
+
+    if (bReduceMorphKeys)
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::ApplyImportResult: Morph keys reduced, before=%d after=%d tracks=%d tolerance=%f"),
+            MorphReductionStats.KeysBefore,
+            MorphReductionStats.KeysAfter,
+            MorphReductionStats.ReducedTracks,
+            MorphReductionTolerance
         );
     }
-
-    Modify();
-#endif
 }
 
+int32 FVmdMorphTrackData::ReduceKeys(float InTolerance)
+{
+    const int32 TiNum = Frames.Num();
+    if (TiNum <= 2 || InTolerance < 0.0f)
+    {
+        return 0;
+    }
+
+    /**
+     * Slopes from anchor that keep every skipped key within tolerance form a range
+     * A key is skipped while the line from anchor to the key after it stays in the range, so one pass bounds the error
+     * Kept keys are compacted in place, writes never pass the key being read
+     */
+    int32 TiWrite = 1;
+    int32 TiAnchor = 0;
+    FVmdMorphFrameData TsAnchor = Frames[0];
+    double TfLowSlope = TNumericLimits<double>::Lowest();
+    double TfHighSlope = TNumericLimits<double>::Max();
+
+    auto KeepAnchor = [&](int32 InIndex)
+        {
+            TiAnchor = InIndex;
+            TsAnchor = Frames[InIndex];
+            Frames[TiWrite++] = TsAnchor;
+            TfLowSlope = TNumericLimits<double>::Lowest();
+            TfHighSlope = TNumericLimits<double>::Max();
+        };
+
+    for (int32 Idx = 1; Idx < TiNum; ++Idx)
+    {
+        const FVmdMorphFrameData TsFrame = Frames[Idx];
+        double TfDelta = (double)TsFrame.Frame - (double)TsAnchor.Frame;
+        const double TfSlope = TfDelta > 0.0 ? (TsFrame.Factor - TsAnchor.Factor) / TfDelta : 0.0;
+
+        if (TfDelta <= 0.0 || TfSlope < TfLowSlope || TfSlope > TfHighSlope)
+        {
+            /** Previous key is the farthest end the segment can reach */
+            if (TiAnchor != Idx - 1)
+            {
+                KeepAnchor(Idx - 1);
+                TfDelta = (double)TsFrame.Frame - (double)TsAnchor.Frame;
+            }
+
+            /** Keys sharing a frame are all kept */
+            if (TfDelta <= 0.0)
+            {
+                KeepAnchor(Idx);
+                continue;
+            }
+        }
+
+        TfLowSlope = FMath::Max(TfLowSlope, (TsFrame.Factor - InTolerance - TsAnchor.Factor) / TfDelta);
+        TfHighSlope = FMath::Min(TfHighSlope, (TsFrame.Factor + InTolerance - TsAnchor.Factor) / TfDelta);
+    }
+
+    if (TiAnchor != TiNum - 1)
+    {
+        Frames[TiWrite++] = Frames[TiNum - 1];
+    }
+
+    Frames.SetNum(TiWrite);
+    return TiNum - TiWrite;
+}
 
 void UMotionDataAsset::PushMorphToAnimation()
 {
@@ -157,8 +366,12 @@ void UMotionDataAsset::PushMorphToAnimation()
 
     const float TfAnimLen = TpAnimSeq->GetPlayLength();
     const float TfAnimRate = GetMorphAnimConvFrameRate();
+    const FString TstrAnimPath = TpAnimSeq->GetPathName();
 
-    for (const TPair<FString, FVmdMorphTrackData>& IterMorphTrack : MorphTracks)
+    int32 TiSkippedNum = 0;
+    int32 TiPushedNum = 0;
+    bool bKeysModified = false;
+    for (const TPair<FString, FVmdMorphTrackData>& IterMorphTrack : GetMorphTracks())
     {
         const FString& TrName = IterMorphTrack.Key;
         const FVmdMorphTrackData& TrTrack = IterMorphTrack.Value;
@@ -206,6 +419,18 @@ void UMotionDataAsset::PushMorphToAnimation()
             continue;
         }
 
+        /** Same track pushed with same mapping into same anim, and the curve is still there */
+        const uint64* TpTrackHash = ContentHashes.MorphTracks.Find(TrName);
+        const uint64 TiPushKey = TpTrackHash ? FVmdContentHash::Combine(*TpTrackHash, TsMorphName.ToString(), bNegativeValue, TfAnimRate, TfAnimLen, TstrAnimPath) : FVmdContentHash::None;
+        const FAnimationCurveIdentifier MetadataCurveId(TsMorphName, ERawCurveTrackTypes::RCT_Float);
+        if (bSkipUnchangedMorphPush && TiPushKey != FVmdContentHash::None
+            && PushedMorphKeys.FindRef(TsMorphName) == TiPushKey
+            && TpAnimSeq->GetDataModel()->FindFloatCurve(MetadataCurveId))
+        {
+            ++TiSkippedNum;
+            continue;
+        }
+
         /** Try create meta data */
         FCurveMetaData* TpCurveMeta = TpSkeleton->GetCurveMetaData(TsMorphName);
         if (!TpCurveMeta || !TpCurveMeta->Type.bMorphtarget)
@@ -243,7 +468,6 @@ void UMotionDataAsset::PushMorphToAnimation()
         }
 
         /** Add curve */
-        const FAnimationCurveIdentifier MetadataCurveId(TsMorphName, ERawCurveTrackTypes::RCT_Float);
         TpAnimDataController.AddCurve(MetadataCurveId, AACF_Metadata);
 
         const FFloatCurve* TpNewCurve = TpAnimSeq->GetDataModel()->FindFloatCurve(MetadataCurveId);
@@ -256,43 +480,172 @@ void UMotionDataAsset::PushMorphToAnimation()
 
         /** Add data to curve */
         FRichCurve TsMorphRichCurve;
-        for (const FVmdMorphFrameData& IterFrame : TrTrack.Frames)
+        BuildMorphCurve(TrTrack, TfAnimRate, TfAnimLen, bNegativeValue, TsMorphName, TsMorphRichCurve);
+
+        TpAnimDataController.SetCurveKeys(MetadataCurveId, TsMorphRichCurve.GetConstRefOfKeys());
+
+        if (TiPushKey != FVmdContentHash::None)
         {
-            /** Convert frame time */
-            float TfTimeInCurve = IterFrame.Frame / TfAnimRate;
-            if (TfTimeInCurve > TfAnimLen)
+            if (!bKeysModified)
             {
-                /**
-                 * Ignore if morph animation is longer than target animation
-                 * We do not automatically modify animation length
-                 */
-                UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::PushMorphToAnimation: Bad time couverted, track=%s frame=%f>%f, frame=%d"),
-                    *TsMorphName.ToString(),
-                    TfTimeInCurve,
-                    TfAnimLen,
-                    IterFrame.Frame
-                );
-                continue;
+                Modify();
+                bKeysModified = true;
             }
-
-            const float TfCurveValue = bNegativeValue ? -IterFrame.Factor : IterFrame.Factor;
-            const float TfTimeValue = TfTimeInCurve;
-
-            FKeyHandle TsKeyHandle = TsMorphRichCurve.AddKey(TfTimeValue, TfCurveValue, false);
-            TsMorphRichCurve.SetKeyInterpMode(TsKeyHandle, ERichCurveInterpMode::RCIM_Linear);
-            TsMorphRichCurve.SetKeyTangentMode(TsKeyHandle, ERichCurveTangentMode::RCTM_Auto);
-            TsMorphRichCurve.SetKeyTangentWeightMode(TsKeyHandle, ERichCurveTangentWeightMode::RCTWM_WeightedNone);
+            PushedMorphKeys.Add(TsMorphName, TiPushKey);
         }
-
-        TpAnimDataController.SetCurveKeys(MetadataCurveId, TsMorphRichCurve.GetConstRefOfKeys());
+        ++TiPushedNum;
     }
 
     TpAnimDataController.NotifyPopulated();
     TpAnimDataController.CloseBracket();
+
+    UE_LOG(LogMmdHelper, Log, TEXT("UMotionDataAsset::PushMorphToAnimation: Done, pushed=%d skipped=%d"), TiPushedNum, TiSkippedNum);
     return;
 #endif
 }
 
+void UMotionDataAsset::BuildMorphCurve(const FVmdMorphTrackData& InTrack, float InFrameRate, float InMaxTime, bool bInNegative, const FName& InCurveName, FRichCurve& OutCurve)
+{
+    for (const FVmdMorphFrameData& IterFrame : InTrack.Frames)
+    {
+        /** Convert frame time */
+        float TfTimeInCurve = IterFrame.Frame / InFrameRate;
+        if (TfTimeInCurve > InMaxTime)
+        {
+            /**
+             * Ignore if morph animation is longer than target animation
+             * We do not automatically modify animation length
+             */
+            UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::BuildMorphCurve: Bad time couverted, track=%s frame=%f>%f, frame=%d"),
+                *InCurveName.ToString(),
+                TfTimeInCurve,
+                InMaxTime,
+                IterFrame.Frame
+            );
+            continue;
+        }
+
+        const float TfCurveValue = bInNegative ? -IterFrame.Factor : IterFrame.Factor;
+        const float TfTimeValue = TfTimeInCurve;
+
+        FKeyHandle TsKeyHandle = OutCurve.AddKey(TfTimeValue, TfCurveValue, false);
+        OutCurve.SetKeyInterpMode(TsKeyHandle, ERichCurveInterpMode::RCIM_Linear);
+        OutCurve.SetKeyTangentMode(TsKeyHandle, ERichCurveTangentMode::RCTM_Auto);
+        OutCurve.SetKeyTangentWeightMode(TsKeyHandle, ERichCurveTangentWeightMode::RCTWM_WeightedNone);
+    }
+}
+
+const TMap<FString, FVmdMorphTrackData>& UMotionDataAsset::GetMorphTracks()
+{
+    DecodeCompactTracks();
+    return MorphTracks;
+}
+
+const TArray<FVmdCameraFrameData>& UMotionDataAsset::GetCameraFrames()
+{
+    DecodeCompactTracks();
+    return CameraFrames;
+}
+
+void UMotionDataAsset::DecodeCompactTracks()
+{
+    if (!bCompactPending)
+    {
+        return;
+    }
+
+    if (!FVmdCompactTracks::Decode(PendingCompactBlob, MorphTracks, CameraFrames))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("UMotionDataAsset::DecodeCompactTracks: Bad compact tracks, asset=%s"), *GetPathName());
+    }
+
+    PendingCompactBlob.Empty();
+    bCompactPending = false;
+}
+
+void UMotionDataAsset::Serialize(FArchive& Ar)
+{
+    using namespace MotionDataAssetPrivate;
+    Ar.UsingCustomVersion(FMotionDataAssetVersion::GUID);
+
+    const bool bTrackArchive = !Ar.IsObjectReferenceCollector() && !Ar.IsCountingMemory();
+
+    /**
+     * Blob flag follows tagged properties in every track archive, saving and loading alike
+     * Only packages saved before compact storage lack it, memory archives carry no custom versions and always have it
+     */
+    const bool bLegacyData = Ar.IsLoading() && Ar.IsPersistent() && Ar.CustomVer(FMotionDataAssetVersion::GUID) < FMotionDataAssetVersion::CompactTracks;
+    const bool bBlobField = bTrackArchive && !bLegacyData;
+
+    /** Undo buffer keeps tagged tracks, so a transaction restores them without a decode */
+    const bool bSaveCompact = bBlobField && Ar.IsSaving() && bUseCompactStorage && !Ar.IsTransacting();
+
+    /** Tagged properties need decoded tracks when compact storage is turned off, and in undo buffer */
+    if (bTrackArchive && Ar.IsSaving() && (!bUseCompactStorage || Ar.IsTransacting()))
+    {
+        DecodeCompactTracks();
+    }
+
+    /** Tracks go into the blob, they are moved aside while tagged properties are written */
+    TArray<uint8> TsBlob;
+    TMap<FString, FVmdMorphTrackData> TsMorphTracks;
+    TArray<FVmdCameraFrameData> TsCameraFrames;
+    if (bSaveCompact)
+    {
+        if (bCompactPending)
+        {
+            TsBlob = PendingCompactBlob;
+        }
+        else
+        {
+            FVmdCompactTracks::Encode(MorphTracks, CameraFrames, TsBlob);
+        }
+
+        TsMorphTracks = MoveTemp(MorphTracks);
+        TsCameraFrames = MoveTemp(CameraFrames);
+    }
+
+    Super::Serialize(Ar);
+
+    if (bSaveCompact)
+    {
+        MorphTracks = MoveTemp(TsMorphTracks);
+        CameraFrames = MoveTemp(TsCameraFrames);
+    }
+
+    if (!bBlobField)
+    {
+        return;
+    }
+
+    bool bHasBlob = bSaveCompact;
+    Ar << bHasBlob;
+    if (bHasBlob)
+    {
+        Ar << TsBlob;
+    }
+
+    /** Decoding waits until tracks are asked for */
+    if (Ar.IsLoading())
+    {
+        PendingCompactBlob = MoveTemp(TsBlob);
+        bCompactPending = bHasBlob && !Ar.IsError();
+    }
+}
+
+void UMotionDataAsset::PostLoad()
+{
+    Super::PostLoad();
+
+#if WITH_EDITOR
+    /** Details panel shows the track properties directly */
+    if (GIsEditor && !IsRunningCommandlet())
+    {
+        DecodeCompactTracks();
+    }
+#endif
+}
+
 void UMotionDataAsset::PreSave(FObjectPreSaveContext SaveContext)
 {
     Super::PreSave(SaveContext);
@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdBezierBatch.h"
+
+
+namespace VmdBezierBatchPrivate
+{
+    /** Registers solved in one loop, a 16 curve stream */
+    static constexpr int32 MaxGroupsPerStream = 4;
+
+    /** Newton and bisection steps share the loop, a lane settles in about 4 steps and no curve of bytes in [0, 127] needs more than 10 */
+    static constexpr int32 MaxSolveSteps = 24;
+
+    static void SetLane(FVmdBezierBatch::FLaneGroup& OutGroup, int32 InLane, const VmdCore::FBezierCurve& InCurve)
+    {
+        OutGroup.Ax[InLane] = InCurve.Ax;
+        OutGroup.Bx[InLane] = InCurve.Bx;
+        OutGroup.Cx[InLane] = InCurve.Cx;
+        OutGroup.DAx[InLane] = 3.0f * InCurve.Ax;
+        OutGroup.DBx[InLane] = 2.0f * InCurve.Bx;
+        OutGroup.Ay[InLane] = InCurve.Ay;
+        OutGroup.By[InLane] = InCurve.By;
+        OutGroup.Cy[InLane] = InCurve.Cy;
+    }
+
+    /** x(t) = y(t) = t, solved by the first step */
+    static VmdCore::FBezierCurve MakeIdentityCurve()
+    {
+        VmdCore::FBezierCurve TsCurve;
+        TsCurve.Cx = 1.0f;
+        TsCurve.Cy = 1.0f;
+        return TsCurve;
+    }
+
+    /** Solve GroupNum registers together, lanes already settled keep their t while the rest step */
+    template<int32 GroupNum>
+    static void EvaluateGroups(const FVmdBezierBatch::FLaneGroup* InGroups, const VectorRegister4Float& InX, float* OutValues)
+    {
+        const VectorRegister4Float TsZero = VectorZeroFloat();
+        const VectorRegister4Float TsHalf = VectorSetFloat1(0.5f);
+        const VectorRegister4Float TsTolerance = VectorSetFloat1(VmdCore::BezierSolveTolerance);
+        const VectorRegister4Float TsMinDeriv = VectorSetFloat1(1.0e-6f);
+
+        VectorRegister4Float TsT[GroupNum];
+        VectorRegister4Float TsLow[GroupNum];
+        VectorRegister4Float TsHigh[GroupNum];
+        for (int32 GroupIdx = 0; GroupIdx < GroupNum; ++GroupIdx)
+        {
+            TsT[GroupIdx] = InX;
+            TsLow[GroupIdx] = TsZero;
+            TsHigh[GroupIdx] = VectorOneFloat();
+        }
+
+        for (int32 Step = 0; Step < MaxSolveSteps; ++Step)
+        {
+            bool bAllSettled = true;
+            for (int32 GroupIdx = 0; GroupIdx < GroupNum; ++GroupIdx)
+            {
+                const FVmdBezierBatch::FLaneGroup& TrGroup = InGroups[GroupIdx];
+                const VectorRegister4Float TsCurT = TsT[GroupIdx];
+
+                const VectorRegister4Float TsSampleX = VectorMultiply(VectorMultiplyAdd(VectorMultiplyAdd(VectorLoadAligned(TrGroup.Ax), TsCurT, VectorLoadAligned(TrGroup.Bx)), TsCurT, VectorLoadAligned(TrGroup.Cx)), TsCurT);
+                const VectorRegister4Float TsError = VectorSubtract(TsSampleX, InX);
+                const VectorRegister4Float TsSettled = VectorCompareLT(VectorAbs(TsError), TsTolerance);
+                bAllSettled &= VectorMaskBits(TsSettled) == 0xF;
+
+                const VectorRegister4Float TsOver = VectorCompareGT(TsError, TsZero);
+                TsHigh[GroupIdx] = VectorSelect(TsOver, TsCurT, TsHigh[GroupIdx]);
+                TsLow[GroupIdx] = VectorSelect(TsOver, TsLow[GroupIdx], TsCurT);
+
+                /** A step leaving the bracket or a flat derivative takes the midpoint, comparisons with nan of a zero division are false */
+                const VectorRegister4Float TsDeriv = VectorMultiplyAdd(VectorMultiplyAdd(VectorLoadAligned(TrGroup.DAx), TsCurT, VectorLoadAligned(TrGroup.DBx)), TsCurT, VectorLoadAligned(TrGroup.Cx));
+                const VectorRegister4Float TsNext = VectorSubtract(TsCurT, VectorDivide(TsError, TsDeriv));
+                const VectorRegister4Float TsValid = VectorBitwiseAnd(
+                    VectorBitwiseAnd(VectorCompareGT(TsNext, TsLow[GroupIdx]), VectorCompareLT(TsNext, TsHigh[GroupIdx])),
+                    VectorCompareGT(TsDeriv, TsMinDeriv));
+                const VectorRegister4Float TsMid = VectorMultiply(VectorAdd(TsLow[GroupIdx], TsHigh[GroupIdx]), TsHalf);
+
+                TsT[GroupIdx] = VectorSelect(TsSettled, TsCurT, VectorSelect(TsValid, TsNext, TsMid));
+            }
+
+            if (bAllSettled)
+            {
+                break;
+            }
+        }
+
+        for (int32 GroupIdx = 0; GroupIdx < GroupNum; ++GroupIdx)
+        {
+            const FVmdBezierBatch::FLaneGroup& TrGroup = InGroups[GroupIdx];
+            const VectorRegister4Float TsY = VectorMultiply(VectorMultiplyAdd(VectorMultiplyAdd(VectorLoadAligned(TrGroup.Ay), TsT[GroupIdx], VectorLoadAligned(TrGroup.By)), TsT[GroupIdx], VectorLoadAligned(TrGroup.Cy)), TsT[GroupIdx]);
+            VectorStore(TsY, OutValues + GroupIdx * FVmdBezierBatch::LaneNum);
+        }
+    }
+}
+
+void FVmdBezierBatch::Reset(int32 InExpectedNum)
+{
+    Groups.Reset(FMath::DivideAndRoundUp(InExpectedNum, LaneNum));
+    CurveNum = 0;
+}
+
+int32 FVmdBezierBatch::Add(const VmdCore::FBezierCurve& InCurve)
+{
+    using namespace VmdBezierBatchPrivate;
+
+    const int32 TiLane = CurveNum % LaneNum;
+    if (TiLane == 0)
+    {
+        FLaneGroup& TrGroup = Groups.AddUninitialized_GetRef();
+        const VmdCore::FBezierCurve TsIdentity = MakeIdentityCurve();
+        for (int32 Lane = 0; Lane < LaneNum; ++Lane)
+        {
+            SetLane(TrGroup, Lane, TsIdentity);
+        }
+    }
+
+    /** y equals x on a linear curve, the identity lane gives it without solving */
+    SetLane(Groups.Last(), TiLane, InCurve.bLinear ? MakeIdentityCurve() : InCurve);
+    return CurveNum++;
+}
+
+void FVmdBezierBatch::AddCameraCurves(const uint8* InInterpolation)
+{
+    for (int32 Channel = 0; Channel < (int32)VmdCore::ECameraCurve::Num; ++Channel)
+    {
+        Add(VmdCore::MakeCameraCurve(InInterpolation, (VmdCore::ECameraCurve)Channel));
+    }
+}
+
+void FVmdBezierBatch::AddBoneCurves(const uint8* InInterpolation)
+{
+    for (int32 Channel = 0; Channel < 4; ++Channel)
+    {
+        Add(VmdCore::MakeBoneCurve(InInterpolation, Channel));
+    }
+}
+
+void FVmdBezierBatch::Evaluate(float InX, TArrayView<float> OutValues) const
+{
+    using namespace VmdBezierBatchPrivate;
+    check(OutValues.Num() >= CurveNum);
+
+    const VectorRegister4Float TsX = VectorSetFloat1(FMath::Clamp(InX, 0.0f, 1.0f));
+    float TsLanes[MaxGroupsPerStream * LaneNum];
+
+    /** Widest stream first, the tail goes through narrower ones instead of solving padding registers */
+    for (int32 GroupIdx = 0; GroupIdx < Groups.Num();)
+    {
+        const int32 TiRemain = Groups.Num() - GroupIdx;
+        const int32 TiGroupNum = TiRemain >= 4 ? 4 : (TiRemain >= 2 ? 2 : 1);
+        switch (TiGroupNum)
+        {
+        case 4:
+            EvaluateGroups<4>(Groups.GetData() + GroupIdx, TsX, TsLanes);
+            break;
+        case 2:
+            EvaluateGroups<2>(Groups.GetData() + GroupIdx, TsX, TsLanes);
+            break;
+        default:
+            EvaluateGroups<1>(Groups.GetData() + GroupIdx, TsX, TsLanes);
+            break;
+        }
+
+        const int32 TiFirst = GroupIdx * LaneNum;
+        FMemory::Memcpy(OutValues.GetData() + TiFirst, TsLanes, FMath::Min(TiGroupNum * LaneNum, CurveNum - TiFirst) * sizeof(float));
+        GroupIdx += TiGroupNum;
+    }
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdBoneColumns.h"
+
+#include "Vmd/VmdFileView.h"
+#include "Vmd/VmdNameInterner.h"
+#include "Async/ParallelFor.h"
+
+
+namespace VmdBoneColumnsPrivate
+{
+    /** Records unpacked by one parallel task */
+    static constexpr int32 UnpackChunkSize = 16 * 1024;
+
+    /** Channels are read through byte offsets, record members are not aligned */
+    static constexpr int32 NameOffset = STRUCT_OFFSET(FVmdRawBoneRecord, Name);
+    static constexpr int32 FrameOffset = STRUCT_OFFSET(FVmdRawBoneRecord, Frame);
+    static constexpr int32 PositionOffset = STRUCT_OFFSET(FVmdRawBoneRecord, Position);
+    static constexpr int32 RotationOffset = STRUCT_OFFSET(FVmdRawBoneRecord, Quaternion);
+    static constexpr int32 InterpolationOffset = STRUCT_OFFSET(FVmdRawBoneRecord, Interpolation);
+    static constexpr int32 NameSize = sizeof(FVmdRawBoneRecord::Name);
+
+    /** Position is followed by rotation, so loading 4 floats from it stays inside the record */
+    static_assert(PositionOffset + 4 * sizeof(float) <= sizeof(FVmdRawBoneRecord), "Bad position load");
+}
+
+void FVmdBoneFrameColumns::Reset()
+{
+    NameIds.Reset();
+    Frames.Reset();
+    Positions.Reset();
+    Rotations.Reset();
+    Interpolations.Reset();
+    Names.Reset();
+}
+
+void FVmdBoneFrameColumns::UnpackFrom(TConstArrayView<FVmdRawBoneRecord> InRecords, bool bInParallel)
+{
+    using namespace VmdBoneColumnsPrivate;
+    Reset();
+
+    const int32 TiNum = InRecords.Num();
+    NameIds.SetNumUninitialized(TiNum);
+    Frames.SetNumUninitialized(TiNum);
+    Positions.SetNumUninitialized(TiNum);
+    Rotations.SetNumUninitialized(TiNum);
+    Interpolations.SetNumUninitialized(TiNum * InterpolationStride);
+
+    const uint8* TpRecords = reinterpret_cast<const uint8*>(InRecords.GetData());
+    int32* TpNameIds = NameIds.GetData();
+    uint32* TpFrames = Frames.GetData();
+    float* TpPositions = reinterpret_cast<float*>(Positions.GetData());
+    float* TpRotations = reinterpret_cast<float*>(Rotations.GetData());
+    uint8* TpInterpolations = Interpolations.GetData();
+
+    /** Numeric channels of each chunk are independent */
+    auto UnpackChannels = [=](int32 InBegin, int32 InEnd)
+    {
+        const uint8* TpRecord = TpRecords + (int64)InBegin * sizeof(FVmdRawBoneRecord);
+        for (int32 Idx = InBegin; Idx < InEnd; ++Idx, TpRecord += sizeof(FVmdRawBoneRecord))
+        {
+            FPlatformMisc::Prefetch(TpRecord, 4 * PLATFORM_CACHE_LINE_SIZE);
+
+            const VectorRegister4Float TsPosition = VectorLoad(reinterpret_cast<const float*>(TpRecord + PositionOffset));
+            const VectorRegister4Float TsRotation = VectorLoad(reinterpret_cast<const float*>(TpRecord + RotationOffset));
+            VectorStoreFloat3(TsPosition, TpPositions + Idx * 3);
+            VectorStore(TsRotation, TpRotations + Idx * 4);
+
+            FMemory::Memcpy(TpFrames + Idx, TpRecord + FrameOffset, sizeof(uint32));
+            FMemory::Memcpy(TpInterpolations + Idx * InterpolationStride, TpRecord + InterpolationOffset, InterpolationStride);
+        }
+    };
+
+    /** Names are interned on raw bytes, each distinct bone name is decoded once */
+    auto UnpackNames = [&]()
+    {
+        FVmdNameInterner TsInterner;
+        TsInterner.InternColumn(reinterpret_cast<const char*>(TpRecords + NameOffset), sizeof(FVmdRawBoneRecord), NameSize, TArrayView<int32>(TpNameIds, TiNum));
+        Names = TsInterner.GetNames();
+    };
+
+    /** The last task walks names while the others unpack channel chunks */
+    const int32 TiChunkNum = FMath::DivideAndRoundUp(TiNum, UnpackChunkSize);
+    ParallelFor(TiChunkNum + 1, [&](int32 InTaskIndex)
+        {
+            if (InTaskIndex == TiChunkNum)
+            {
+                UnpackNames();
+                return;
+            }
+
+            const int32 TiBegin = InTaskIndex * UnpackChunkSize;
+            UnpackChannels(TiBegin, FMath::Min(TiBegin + UnpackChunkSize, TiNum));
+        }, bInParallel ? EParallelForFlags::Unbalanced : EParallelForFlags::ForceSingleThread);
+}
@@ -0,0 +1,308 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdCompactTracks.h"
+
+#include "Vmd/MotionDataAsset.h"
+#include "UeMmdHelper.h"
+
+
+namespace VmdCompactTracksPrivate
+{
+    static constexpr uint32 BlobMagic = 0x54444D56; // "VMDT"
+
+    /** Smallest encoded frames, counts are checked against rest of blob before allocating */
+    static constexpr int64 MinMorphTrackSize = 1 + 1 + 2 * sizeof(float);
+    static constexpr int64 MinMorphFrameSize = 1 + sizeof(uint16);
+    static constexpr int64 MinCameraFrameSize = 1 + 7 * sizeof(float) + 1 + sizeof(uint8);
+
+    /** Camera interpolation is stored since version 2 */
+    static constexpr uint32 CameraInterpolationVersion = 2;
+
+    class FBlobWriter
+    {
+    public:
+        explicit FBlobWriter(TArray<uint8>& InBytes) : Bytes(InBytes) {}
+
+        void WriteVarint(uint64 InValue)
+        {
+            while (InValue >= 0x80)
+            {
+                Bytes.Add((uint8)(InValue | 0x80));
+                InValue >>= 7;
+            }
+            Bytes.Add((uint8)InValue);
+        }
+
+        /** Zigzag keeps small negative deltas short, frames edited by hand may be out of order */
+        void WriteDelta(int64 InDelta)
+        {
+            WriteVarint(((uint64)InDelta << 1) ^ (uint64)(InDelta >> 63));
+        }
+
+        void WriteBytes(const uint8* InBytes, int32 InNum)
+        {
+            Bytes.Append(InBytes, InNum);
+        }
+
+        template<typename ValueType>
+        void WriteRaw(ValueType InValue)
+        {
+            Bytes.Append(reinterpret_cast<const uint8*>(&InValue), sizeof(ValueType));
+        }
+
+        void WriteString(const FString& InString)
+        {
+            const FTCHARToUTF8 TsUtf8(*InString);
+            WriteVarint(TsUtf8.Length());
+            Bytes.Append(reinterpret_cast<const uint8*>(TsUtf8.Get()), TsUtf8.Length());
+        }
+
+    private:
+        TArray<uint8>& Bytes;
+    };
+
+    class FBlobReader
+    {
+    public:
+        explicit FBlobReader(TConstArrayView<uint8> InBytes) : Bytes(InBytes) {}
+
+        bool HasError() const { return bError; }
+        int64 GetRemaining() const { return Bytes.Num() - Offset; }
+
+        uint64 ReadVarint()
+        {
+            uint64 TiValue = 0;
+            for (int32 TiShift = 0; TiShift < 64; TiShift += 7)
+            {
+                if (Offset >= Bytes.Num())
+                {
+                    break;
+                }
+
+                const uint8 TiByte = Bytes[Offset++];
+                TiValue |= (uint64)(TiByte & 0x7F) << TiShift;
+                if ((TiByte & 0x80) == 0)
+                {
+                    return TiValue;
+                }
+            }
+
+            bError = true;
+            return 0;
+        }
+
+        int64 ReadDelta()
+        {
+            const uint64 TiValue = ReadVarint();
+            return (int64)(TiValue >> 1) ^ -(int64)(TiValue & 1);
+        }
+
+        void ReadBytes(uint8* OutBytes, int32 InNum)
+        {
+            if (GetRemaining() < InNum)
+            {
+                bError = true;
+                FMemory::Memzero(OutBytes, InNum);
+                return;
+            }
+
+            FMemory::Memcpy(OutBytes, Bytes.GetData() + Offset, InNum);
+            Offset += InNum;
+        }
+
+        template<typename ValueType>
+        ValueType ReadRaw()
+        {
+            ValueType TsValue{};
+            if (GetRemaining() < (int64)sizeof(ValueType))
+            {
+                bError = true;
+                return TsValue;
+            }
+
+            FMemory::Memcpy(&TsValue, Bytes.GetData() + Offset, sizeof(ValueType));
+            Offset += (int32)sizeof(ValueType);
+            return TsValue;
+        }
+
+        FString ReadString()
+        {
+            const uint64 TiLen = ReadVarint();
+            if (bError || TiLen > (uint64)GetRemaining())
+            {
+                bError = true;
+                return FString();
+            }
+
+            const FUTF8ToTCHAR TsConverted(reinterpret_cast<const UTF8CHAR*>(Bytes.GetData() + Offset), (int32)TiLen);
+            Offset += (int32)TiLen;
+            return FString::ConstructFromPtrSize(TsConverted.Get(), TsConverted.Length());
+        }
+
+        /** Count of elements that are at least InMinSize bytes each, fails if the rest of blob can not hold them */
+        int32 ReadNum(int64 InMinSize)
+        {
+            const uint64 TiNum = ReadVarint();
+            if (bError || TiNum > (uint64)MAX_int32 || (int64)TiNum * InMinSize > GetRemaining())
+            {
+                bError = true;
+                return 0;
+            }
+            return (int32)TiNum;
+        }
+
+    private:
+        TConstArrayView<uint8> Bytes;
+        int32 Offset = 0;
+        bool bError = false;
+    };
+}
+
+void FVmdCompactTracks::Encode(const TMap<FString, FVmdMorphTrackData>& InMorphTracks, TConstArrayView<FVmdCameraFrameData> InCameraFrames, TArray<uint8>& OutBlob)
+{
+    using namespace VmdCompactTracksPrivate;
+
+    OutBlob.Reset();
+    FBlobWriter TsWriter(OutBlob);
+    TsWriter.WriteRaw<uint32>(BlobMagic);
+    TsWriter.WriteRaw<uint32>(FormatVersion);
+
+    TsWriter.WriteVarint(InMorphTracks.Num());
+    for (const TPair<FString, FVmdMorphTrackData>& IterTrack : InMorphTracks)
+    {
+        const TArray<FVmdMorphFrameData>& TrFrames = IterTrack.Value.Frames;
+        TsWriter.WriteString(IterTrack.Key);
+        TsWriter.WriteVarint(TrFrames.Num());
+
+        float TfMin = 0.0f;
+        float TfMax = 0.0f;
+        if (TrFrames.Num() > 0)
+        {
+            TfMin = TfMax = TrFrames[0].Factor;
+            for (const FVmdMorphFrameData& IterFrame : TrFrames)
+            {
+                TfMin = FMath::Min(TfMin, IterFrame.Factor);
+                TfMax = FMath::Max(TfMax, IterFrame.Factor);
+            }
+        }
+        TsWriter.WriteRaw<float>(TfMin);
+        TsWriter.WriteRaw<float>(TfMax);
+
+        const double TfScale = TfMax > TfMin ? FactorSteps / ((double)TfMax - TfMin) : 0.0;
+        int64 TiPrevFrame = 0;
+        for (const FVmdMorphFrameData& IterFrame : TrFrames)
+        {
+            TsWriter.WriteDelta((int64)IterFrame.Frame - TiPrevFrame);
+            TiPrevFrame = IterFrame.Frame;
+
+            const double TfSteps = FMath::RoundHalfFromZero(((double)IterFrame.Factor - TfMin) * TfScale);
+            TsWriter.WriteRaw<uint16>((uint16)FMath::Clamp<double>(TfSteps, 0.0, FactorSteps));
+        }
+    }
+
+    TsWriter.WriteVarint(InCameraFrames.Num());
+    int64 TiPrevFrame = 0;
+    for (const FVmdCameraFrameData& IterFrame : InCameraFrames)
+    {
+        TsWriter.WriteDelta((int64)IterFrame.Frame - TiPrevFrame);
+        TiPrevFrame = IterFrame.Frame;
+
+        TsWriter.WriteRaw<float>(IterFrame.Length);
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            TsWriter.WriteRaw<float>((float)IterFrame.Location[Axis]);
+        }
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            TsWriter.WriteRaw<float>((float)IterFrame.Rotate[Axis]);
+        }
+        TsWriter.WriteVarint(IterFrame.ViewingAngle);
+        TsWriter.WriteRaw<uint8>(IterFrame.Perspective);
+        TsWriter.WriteBytes(IterFrame.Interpolation, sizeof(IterFrame.Interpolation));
+    }
+}
+
+bool FVmdCompactTracks::Decode(TConstArrayView<uint8> InBlob, TMap<FString, FVmdMorphTrackData>& OutMorphTracks, TArray<FVmdCameraFrameData>& OutCameraFrames)
+{
+    using namespace VmdCompactTracksPrivate;
+
+    OutMorphTracks.Reset();
+    OutCameraFrames.Reset();
+
+    FBlobReader TsReader(InBlob);
+    const uint32 TiMagic = TsReader.ReadRaw<uint32>();
+    const uint32 TiVersion = TsReader.ReadRaw<uint32>();
+    if (TsReader.HasError() || TiMagic != BlobMagic || TiVersion == 0 || TiVersion > FormatVersion)
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdCompactTracks::Decode: Bad header, magic=%08x version=%u"), TiMagic, TiVersion);
+        return false;
+    }
+
+    const int32 TiTrackNum = TsReader.ReadNum(MinMorphTrackSize);
+    OutMorphTracks.Reserve(TiTrackNum);
+    for (int32 TrackIdx = 0; TrackIdx < TiTrackNum && !TsReader.HasError(); ++TrackIdx)
+    {
+        FString TstrName = TsReader.ReadString();
+        const int32 TiFrameNum = TsReader.ReadNum(MinMorphFrameSize);
+        const float TfMin = TsReader.ReadRaw<float>();
+        const float TfMax = TsReader.ReadRaw<float>();
+        if (TsReader.HasError())
+        {
+            break;
+        }
+
+        /** Steps are scaled in double so both ends of the range decode exactly */
+        const double TfStep = ((double)TfMax - TfMin) / FactorSteps;
+
+        TArray<FVmdMorphFrameData>& TrFrames = OutMorphTracks.Add(MoveTemp(TstrName)).Frames;
+        TrFrames.SetNumUninitialized(TiFrameNum);
+        int64 TiFrame = 0;
+        for (FVmdMorphFrameData& IterFrame : TrFrames)
+        {
+            TiFrame += TsReader.ReadDelta();
+            const uint16 TiSteps = TsReader.ReadRaw<uint16>();
+
+            IterFrame.Frame = (uint32)TiFrame;
+            IterFrame.Factor = TiSteps == FactorSteps ? TfMax : (float)(TfMin + TiSteps * TfStep);
+        }
+    }
+
+    const bool bHasInterpolation = TiVersion >= CameraInterpolationVersion;
+    const int32 TiCameraNum = TsReader.ReadNum(MinCameraFrameSize + (bHasInterpolation ? sizeof(FVmdCameraFrameData::Interpolation) : 0));
+    OutCameraFrames.SetNumUninitialized(TiCameraNum);
+    int64 TiFrame = 0;
+    for (FVmdCameraFrameData& IterFrame : OutCameraFrames)
+    {
+        TiFrame += TsReader.ReadDelta();
+        IterFrame.Frame = (uint32)TiFrame;
+        IterFrame.Length = TsReader.ReadRaw<float>();
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            IterFrame.Location[Axis] = TsReader.ReadRaw<float>();
+        }
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            IterFrame.Rotate[Axis] = TsReader.ReadRaw<float>();
+        }
+        IterFrame.ViewingAngle = (uint32)TsReader.ReadVarint();
+        IterFrame.Perspective = TsReader.ReadRaw<uint8>();
+
+        if (bHasInterpolation)
+        {
+            TsReader.ReadBytes(IterFrame.Interpolation, sizeof(IterFrame.Interpolation));
+        }
+        else
+        {
+            FMemory::Memzero(IterFrame.Interpolation, sizeof(IterFrame.Interpolation));
+        }
+    }
+
+    if (TsReader.HasError() || TsReader.GetRemaining() != 0)
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdCompactTracks::Decode: Broken blob, size=%d"), InBlob.Num());
+        OutMorphTracks.Reset();
+        OutCameraFrames.Reset();
+        return false;
+    }
+    return true;
+}
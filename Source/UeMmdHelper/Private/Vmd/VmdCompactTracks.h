@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVmdMorphTrackData;
+struct FVmdCameraFrameData;
+
+
+/**
+ * Compact encoding of morph and camera tracks of UMotionDataAsset as one blob
+ * Frame numbers are varint deltas, morph factors are 16 bit quantized in the value range of each track,
+ * camera channels are stored as float and camera interpolation as raw bytes
+ */
+namespace FVmdCompactTracks
+{
+    /**
+     * Bump when blob layout changes, older blobs still decode and newer ones fail
+     * 2: Camera interpolation bytes
+     */
+    static constexpr uint32 FormatVersion = 2;
+
+    /** Quantization step of a morph factor is the value range of its track divided by this */
+    static constexpr uint32 FactorSteps = 0xFFFF;
+
+    void Encode(const TMap<FString, FVmdMorphTrackData>& InMorphTracks, TConstArrayView<FVmdCameraFrameData> InCameraFrames, TArray<uint8>& OutBlob);
+
+    /** @return False on broken blob or newer version, outputs are then left empty */
+    bool Decode(TConstArrayView<uint8> InBlob, TMap<FString, FVmdMorphTrackData>& OutMorphTracks, TArray<FVmdCameraFrameData>& OutCameraFrames);
+}
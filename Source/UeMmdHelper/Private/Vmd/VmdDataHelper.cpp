@@ -1,10 +1,14 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdFileView.h"
+#include "Vmd/VmdValidation.h"
+#include "Vmd/VmdNameInterner.h"
 
 #include "Miscs/SjisToUnicode.h"
 #include "UeMmdHelper.h"
 #include "HAL/FileManagerGeneric.h"
+#include "Async/ParallelFor.h"
 
 
 
@@ -22,6 +26,15 @@ void FVmdDataHelper::LoadVmdDataFromFile(const FString& InFilePath, FVmdData& Ou
 
     UE_LOG(LogMmdHelper, Log, TEXT("FVmdDataHelper::LoadVmdDataFromFile: Start, file=%s size=%lld"), *InFilePath, FileHandle->Size());
 
+    /** Reject broken counts before any section is allocated */
+    const FVmdValidationResult TsValidation = ValidateVmdFile(*FileHandle);
+    if (!TsValidation.IsValid() || !FileHandle->Seek(0))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdDataHelper::LoadVmdDataFromFile: Validation failed, file=%s %s"), *InFilePath, *TsValidation.ToString());
+        delete FileHandle;
+        return;
+    }
+
     /** init file reader */
     FArchiveFileReaderGeneric FileReader(FileHandle, *InFilePath, FileHandle->Size());
     FileReader << OutData;
@@ -30,9 +43,254 @@ void FVmdDataHelper::LoadVmdDataFromFile(const FString& InFilePath, FVmdData& Ou
     UE_LOG(LogMmdHelper, Log, TEXT("FVmdDataHelper::LoadVmdDataFromFile: Ends"));
 }
 
+int32 FVmdDataHelper::DecodeMmdName(const char* InName, int32 InMaxLen, TCHAR* OutBuffer, int32 InBufferLen)
+{
+    if (!InName || InMaxLen <= 0 || InBufferLen <= 0)
+    {
+        return 0;
+    }
+
+    if constexpr (sizeof(TCHAR) == sizeof(char16_t))
+    {
+        /** Decoded straight into caller storage */
+        return (int32)saba::ConvertSjisToU16Buffer(InName, InMaxLen, reinterpret_cast<char16_t*>(OutBuffer), InBufferLen);
+    }
+    else
+    {
+        /** Wider TCHAR, sjis only maps into the basic plane so each char widens as is */
+        TArray<char16_t, TInlineAllocator<MaxInlineNameLen>> TsDecoded;
+        TsDecoded.SetNumUninitialized(InBufferLen);
+        const int32 TiLen = (int32)saba::ConvertSjisToU16Buffer(InName, InMaxLen, TsDecoded.GetData(), InBufferLen);
+        for (int32 Idx = 0; Idx < TiLen; ++Idx)
+        {
+            OutBuffer[Idx] = (TCHAR)TsDecoded[Idx];
+        }
+        return TiLen;
+    }
+}
+
 FString FVmdDataHelper::ConvertFromMmdName(const char* InName)
 {
-    return FString((wchar_t*)saba::ConvertSjisToU16String(InName).c_str());
+    return InName ? ConvertFromMmdName(InName, FCStringAnsi::Strlen(InName)) : FString();
+}
+
+FString FVmdDataHelper::ConvertFromMmdName(const char* InName, int32 InMaxLen)
+{
+    /** Each byte decodes to at most one char, names in vmd fit the inline buffer */
+    TArray<TCHAR, TInlineAllocator<MaxInlineNameLen>> TsDecoded;
+    TsDecoded.SetNumUninitialized(FMath::Max(InMaxLen, 0));
+    const int32 TiLen = DecodeMmdName(InName, InMaxLen, TsDecoded.GetData(), TsDecoded.Num());
+    return FString::ConstructFromPtrSize(TsDecoded.GetData(), TiLen);
+}
+
+FName FVmdDataHelper::ConvertFromMmdNameToFName(const char* InName, int32 InMaxLen, EFindName InFindType)
+{
+    TArray<TCHAR, TInlineAllocator<MaxInlineNameLen>> TsDecoded;
+    TsDecoded.SetNumUninitialized(FMath::Max(InMaxLen, 0));
+    const int32 TiLen = DecodeMmdName(InName, InMaxLen, TsDecoded.GetData(), TsDecoded.Num());
+    return FName(TiLen, TsDecoded.GetData(), InFindType);
+}
+
+FVmdNameEncodeResult FVmdDataHelper::ConvertToMmdName(FStringView InName, char* OutField, int32 InFieldSize)
+{
+    FVmdNameEncodeResult TsResult;
+    if (!OutField || InFieldSize <= 0)
+    {
+        return TsResult;
+    }
+
+    saba::SjisEncodeResult TsEncoded;
+    if constexpr (sizeof(TCHAR) == sizeof(char16_t))
+    {
+        TsEncoded = saba::ConvertU16ToSjisBuffer(reinterpret_cast<const char16_t*>(InName.GetData()), InName.Len(), OutField, InFieldSize);
+    }
+    else
+    {
+        /** Wider TCHAR, chars outside the basic plane have no sjis code and narrow to a lone surrogate */
+        TArray<char16_t, TInlineAllocator<MaxInlineNameLen>> TsNarrowed;
+        TsNarrowed.SetNumUninitialized(InName.Len());
+        for (int32 Idx = 0; Idx < InName.Len(); ++Idx)
+        {
+            TsNarrowed[Idx] = (uint32)InName[Idx] > 0xFFFF ? char16_t(0xD800) : (char16_t)InName[Idx];
+        }
+        TsEncoded = saba::ConvertU16ToSjisBuffer(TsNarrowed.GetData(), TsNarrowed.Num(), OutField, InFieldSize);
+    }
+
+    FMemory::Memzero(OutField + TsEncoded.written, InFieldSize - TsEncoded.written);
+
+    TsResult.Bytes = (int32)TsEncoded.written;
+    TsResult.UnrepresentableNum = (int32)TsEncoded.unrepresentable;
+    TsResult.bTruncated = TsEncoded.truncated;
+    return TsResult;
+}
+
+namespace VmdDataHelperPrivate
+{
+    /** Records decoded by one parallel task */
+    static constexpr int32 DecodeChunkSize = 16 * 1024;
+
+    struct FDecodeChunk
+    {
+        EVmdSection Section;
+        int32 Begin;
+        int32 End;
+    };
+
+    static void AddDecodeChunks(TArray<FDecodeChunk>& OutChunks, EVmdSection InSection, int32 InNum)
+    {
+        for (int32 TiBegin = 0; TiBegin < InNum; TiBegin += DecodeChunkSize)
+        {
+            OutChunks.Add({ InSection, TiBegin, FMath::Min(TiBegin + DecodeChunkSize, InNum) });
+        }
+    }
+
+    static void ConvertRecord(const FVmdRawBoneRecord& InRecord, FVmdBoneFrame& OutFrame)
+    {
+        FMemory::Memcpy(OutFrame.Name, InRecord.Name, sizeof(OutFrame.Name));
+        OutFrame.Frame = InRecord.Frame;
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            OutFrame.Position[Axis] = InRecord.Position[Axis];
+        }
+        for (int32 Axis = 0; Axis < 4; ++Axis)
+        {
+            OutFrame.Quaternion[Axis] = InRecord.Quaternion[Axis];
+        }
+        FMemory::Memcpy(OutFrame.Bezier, InRecord.Interpolation, sizeof(OutFrame.Bezier));
+    }
+
+    static void ConvertRecord(const FVmdRawFaceRecord& InRecord, FVmdFaceFrame& OutFrame)
+    {
+        FMemory::Memcpy(OutFrame.Name, InRecord.Name, sizeof(OutFrame.Name));
+        OutFrame.Frame = InRecord.Frame;
+        OutFrame.Factor = InRecord.Factor;
+    }
+
+    static void ConvertRecord(const FVmdRawCameraRecord& InRecord, FVmdCameraFrame& OutFrame)
+    {
+        OutFrame.Frame = InRecord.Frame;
+        OutFrame.Length = InRecord.Length;
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            OutFrame.Location[Axis] = InRecord.Location[Axis];
+            OutFrame.Rotate[Axis] = InRecord.Rotate[Axis];
+        }
+        FMemory::Memcpy(OutFrame.Interpolation, InRecord.Interpolation, sizeof(OutFrame.Interpolation));
+        OutFrame.ViewingAngle = InRecord.ViewingAngle;
+        OutFrame.Perspective = InRecord.Perspective;
+    }
+
+    static void ConvertRecord(const FVmdRawLightRecord& InRecord, FVmdLightFrame& OutFrame)
+    {
+        OutFrame.Frame = InRecord.Frame;
+        for (int32 Axis = 0; Axis < 3; ++Axis)
+        {
+            OutFrame.Color[Axis] = InRecord.Color[Axis];
+            OutFrame.Position[Axis] = InRecord.Position[Axis];
+        }
+    }
+
+    static void ConvertRecord(const FVmdRawSelfShadowRecord& InRecord, FVmdSelfShadowFrame& OutFrame)
+    {
+        OutFrame.Frame = InRecord.Frame;
+        OutFrame.Mode = InRecord.Mode;
+        OutFrame.Distance = InRecord.Distance;
+    }
+
+    static void ConvertIkRecords(FVmdIkRecordIterator InIter, TArray<FVmdIkFrame>& OutFrames)
+    {
+        for (FVmdIkFrame& IterFrame : OutFrames)
+        {
+            const FVmdRawIkRecord& TrRecord = InIter.GetRecord();
+            const TConstArrayView<FVmdRawIkInfo> TsInfos = InIter.GetInfos();
+
+            IterFrame.Frame = TrRecord.Frame;
+            IterFrame.Show = TrRecord.Show;
+            IterFrame.IkInfos.SetNumZeroed(TsInfos.Num());
+            for (int32 Idx = 0; Idx < TsInfos.Num(); ++Idx)
+            {
+                FMemory::Memcpy(IterFrame.IkInfos[Idx].Name, TsInfos[Idx].Name, sizeof(FVmdIkInfo::Name));
+                IterFrame.IkInfos[Idx].Enable = TsInfos[Idx].Enable;
+            }
+
+            ++InIter;
+        }
+    }
+
+    template<typename RecordType, typename FrameType>
+    static void ConvertRange(TConstArrayView<RecordType> InRecords, TArray<FrameType>& OutFrames, int32 InBegin, int32 InEnd)
+    {
+        for (int32 Idx = InBegin; Idx < InEnd; ++Idx)
+        {
+            ConvertRecord(InRecords[Idx], OutFrames[Idx]);
+        }
+    }
+}
+
+void FVmdData::ReadFromView(const FVmdFileView& InView, bool bInParallel)
+{
+    using namespace VmdDataHelperPrivate;
+    check(InView.IsValid());
+
+    const FVmdRawHeader& TrHeader = InView.GetHeader();
+    FMemory::Memcpy(VmdHeader.MagicHeader, TrHeader.MagicHeader, sizeof(VmdHeader.MagicHeader));
+    FMemory::Memcpy(VmdHeader.TargetModelName, TrHeader.TargetModelName, sizeof(VmdHeader.TargetModelName));
+
+    /** Section offsets are known from the view, so every section is sized up front and filled in disjoint chunks */
+    const TConstArrayView<FVmdRawBoneRecord> TsBoneRecords = InView.GetBoneFrames();
+    const TConstArrayView<FVmdRawFaceRecord> TsFaceRecords = InView.GetFaceFrames();
+    const TConstArrayView<FVmdRawCameraRecord> TsCameraRecords = InView.GetCameraFrames();
+    const TConstArrayView<FVmdRawLightRecord> TsLightRecords = InView.GetLightFrames();
+    const TConstArrayView<FVmdRawSelfShadowRecord> TsSelfShadowRecords = InView.GetSelfShadowFrames();
+
+    TrackData.BoneFrames.SetNumZeroed(TsBoneRecords.Num());
+    TrackData.FaceFrames.SetNumZeroed(TsFaceRecords.Num());
+    TrackData.CameraFrames.SetNumZeroed(TsCameraRecords.Num());
+    TrackData.LightFrames.SetNumZeroed(TsLightRecords.Num());
+    TrackData.SelfShadowFrames.SetNumZeroed(TsSelfShadowRecords.Num());
+    TrackData.IkFrames.SetNumZeroed(InView.GetIkFrameNum());
+
+    TArray<FDecodeChunk> TsChunks;
+    AddDecodeChunks(TsChunks, EVmdSection::Bone, TsBoneRecords.Num());
+    AddDecodeChunks(TsChunks, EVmdSection::Face, TsFaceRecords.Num());
+    AddDecodeChunks(TsChunks, EVmdSection::Camera, TsCameraRecords.Num());
+    AddDecodeChunks(TsChunks, EVmdSection::Light, TsLightRecords.Num());
+    AddDecodeChunks(TsChunks, EVmdSection::SelfShadow, TsSelfShadowRecords.Num());
+
+    /** Ik records have no fixed offsets, the whole section is one task */
+    if (TrackData.IkFrames.Num() > 0)
+    {
+        TsChunks.Add({ EVmdSection::Ik, 0, TrackData.IkFrames.Num() });
+    }
+
+    ParallelFor(TsChunks.Num(), [&](int32 InChunkIndex)
+        {
+            const FDecodeChunk& TrChunk = TsChunks[InChunkIndex];
+            switch (TrChunk.Section)
+            {
+            case EVmdSection::Bone:
+                ConvertRange(TsBoneRecords, TrackData.BoneFrames, TrChunk.Begin, TrChunk.End);
+                break;
+            case EVmdSection::Face:
+                ConvertRange(TsFaceRecords, TrackData.FaceFrames, TrChunk.Begin, TrChunk.End);
+                break;
+            case EVmdSection::Camera:
+                ConvertRange(TsCameraRecords, TrackData.CameraFrames, TrChunk.Begin, TrChunk.End);
+                break;
+            case EVmdSection::Light:
+                ConvertRange(TsLightRecords, TrackData.LightFrames, TrChunk.Begin, TrChunk.End);
+                break;
+            case EVmdSection::SelfShadow:
+                ConvertRange(TsSelfShadowRecords, TrackData.SelfShadowFrames, TrChunk.Begin, TrChunk.End);
+                break;
+            case EVmdSection::Ik:
+                ConvertIkRecords(InView.GetIkFrames(), TrackData.IkFrames);
+                break;
+            default:
+                checkNoEntry();
+                break;
+            }
+        }, bInParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
 }
 
 void FVmdData::PrintOutData()
@@ -40,23 +298,32 @@ void FVmdData::PrintOutData()
     UE_LOG(LogMmdHelper, Log, TEXT("------ FVmdData::PrintOutData: Starte ------"));
 
     UE_LOG(LogMmdHelper, Log, TEXT("Magic:%s"), ANSI_TO_TCHAR(VmdHeader.MagicHeader));
-    UE_LOG(LogMmdHelper, Log, TEXT("Model:%s"), ANSI_TO_TCHAR(VmdHeader.TargetModelName));
+    UE_LOG(LogMmdHelper, Log, TEXT("Model:%s"), *FVmdDataHelper::ConvertFromMmdName(VmdHeader.TargetModelName, sizeof(VmdHeader.TargetModelName)));
 
     UE_LOG(LogMmdHelper, Log, TEXT("BoneFrames:%d"), TrackData.BoneFrames.Num());
     UE_LOG(LogMmdHelper, Log, TEXT("FaceFrames:%d"), TrackData.FaceFrames.Num());
     UE_LOG(LogMmdHelper, Log, TEXT("CameraFrames:%d"), TrackData.CameraFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("LightFrames:%d"), TrackData.LightFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("SelfShadowFrames:%d"), TrackData.SelfShadowFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("IkFrames:%d"), TrackData.IkFrames.Num());
+
+    /** Each distinct name is decoded once for the whole section, frames are strided like raw records */
+    FVmdNameColumn TsNames;
+    const TArray<FVmdBoneFrame>& TrBoneFrames = TrackData.BoneFrames;
+    const TArray<FVmdFaceFrame>& TrFaceFrames = TrackData.FaceFrames;
 
     UE_LOG(LogMmdHelper, Log, TEXT("== BoneFrame info =="));
-    for (const FVmdBoneFrame& IterFrame : TrackData.BoneFrames)
+    TsNames.DecodeFrom(reinterpret_cast<const char*>(TrBoneFrames.GetData()), sizeof(FVmdBoneFrame), sizeof(FVmdBoneFrame::Name), TrBoneFrames.Num());
+    for (int32 Idx = 0; Idx < TrBoneFrames.Num(); ++Idx)
     {
-        ;
-        UE_LOG(LogMmdHelper, Log, TEXT("Name:%s Frame:%d"), *FVmdDataHelper::ConvertFromMmdName(IterFrame.Name), IterFrame.Frame);
+        UE_LOG(LogMmdHelper, Log, TEXT("Name:%s Frame:%d"), *TsNames.GetName(Idx), TrBoneFrames[Idx].Frame);
     }
 
     UE_LOG(LogMmdHelper, Log, TEXT("== FaceFrames info =="));
-    for (const FVmdFaceFrame& IterFrame : TrackData.FaceFrames)
+    TsNames.DecodeFrom(reinterpret_cast<const char*>(TrFaceFrames.GetData()), sizeof(FVmdFaceFrame), sizeof(FVmdFaceFrame::Name), TrFaceFrames.Num());
+    for (int32 Idx = 0; Idx < TrFaceFrames.Num(); ++Idx)
     {
-        UE_LOG(LogMmdHelper, Log, TEXT("Name:%s Frame:%d"), *FVmdDataHelper::ConvertFromMmdName(IterFrame.Name), IterFrame.Frame);
+        UE_LOG(LogMmdHelper, Log, TEXT("Name:%s Frame:%d"), *TsNames.GetName(Idx), TrFaceFrames[Idx].Frame);
     }
 
     UE_LOG(LogMmdHelper, Log, TEXT("== CameraFrames info =="));
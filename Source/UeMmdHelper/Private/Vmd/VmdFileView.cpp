@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdFileView.h"
+
+#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdNameInterner.h"
+#include "UeMmdHelper.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+
+namespace VmdFileViewPrivate
+{
+    /** Validation ensures records are inside file */
+    template<typename RecordType>
+    static TConstArrayView<RecordType> GetSection(const VmdCore::FRecordView& InRecords, EVmdSection InSection)
+    {
+        return TConstArrayView<RecordType>(InRecords.GetRecords<RecordType>(InSection), InRecords.GetCount(InSection));
+    }
+}
+
+FVmdFileView::FVmdFileView()
+{
+}
+
+FVmdFileView::~FVmdFileView()
+{
+    Close();
+}
+
+bool FVmdFileView::Open(const FString& InFilePath)
+{
+    Close();
+    Validation = FVmdValidationResult();
+
+    /** Prefer mapping, the records are read in place */
+    IPlatformFile& FileSystem = IPlatformFile::GetPlatformPhysical();
+    FOpenMappedResult TsMapResult = FileSystem.OpenMappedEx(*InFilePath);
+    if (TsMapResult.HasValue())
+    {
+        MappedHandle = TsMapResult.StealValue();
+    }
+
+    if (MappedHandle.IsValid() && MappedHandle->GetFileSize() > 0)
+    {
+        MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+    }
+
+    if (MappedRegion.IsValid())
+    {
+        Data = MappedRegion->GetMappedPtr();
+        DataSize = MappedRegion->GetMappedSize();
+    }
+    else
+    {
+        MappedHandle.Reset();
+        if (!FFileHelper::LoadFileToArray(FallbackBuffer, *InFilePath))
+        {
+            Validation.Error = EVmdValidationError::ReadFailed;
+            UE_LOG(LogMmdHelper, Error, TEXT("FVmdFileView::Open: Failed read file %s"), *InFilePath);
+            return false;
+        }
+
+        Data = FallbackBuffer.GetData();
+        DataSize = FallbackBuffer.Num();
+    }
+
+    UE_LOG(LogMmdHelper, Log, TEXT("FVmdFileView::Open: file=%s size=%lld mapped=%d"), *InFilePath, DataSize, IsMapped());
+
+    if (!ParseSections())
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdFileView::Open: Bad vmd file %s"), *InFilePath);
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void FVmdFileView::Close()
+{
+    Header = nullptr;
+    BoneFrames = TConstArrayView<FVmdRawBoneRecord>();
+    FaceFrames = TConstArrayView<FVmdRawFaceRecord>();
+    CameraFrames = TConstArrayView<FVmdRawCameraRecord>();
+    LightFrames = TConstArrayView<FVmdRawLightRecord>();
+    SelfShadowFrames = TConstArrayView<FVmdRawSelfShadowRecord>();
+
+    Data = nullptr;
+    DataSize = 0;
+
+    /** Region must be released before its handle */
+    MappedRegion.Reset();
+    MappedHandle.Reset();
+    FallbackBuffer.Empty();
+}
+
+bool FVmdFileView::ParseSections()
+{
+    VmdCore::FRecordView TsRecords;
+    const bool bParsed = VmdCore::ParseRecords(Data, DataSize, TsRecords);
+    static_cast<VmdCore::FVmdLayout&>(Validation) = TsRecords.Layout;
+    if (!bParsed)
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdFileView::ParseSections: Validation failed, %s"), *Validation.ToString());
+        return false;
+    }
+
+    using namespace VmdFileViewPrivate;
+    Header = TsRecords.Header;
+    BoneFrames = GetSection<FVmdRawBoneRecord>(TsRecords, EVmdSection::Bone);
+    FaceFrames = GetSection<FVmdRawFaceRecord>(TsRecords, EVmdSection::Face);
+    CameraFrames = GetSection<FVmdRawCameraRecord>(TsRecords, EVmdSection::Camera);
+    LightFrames = GetSection<FVmdRawLightRecord>(TsRecords, EVmdSection::Light);
+    SelfShadowFrames = GetSection<FVmdRawSelfShadowRecord>(TsRecords, EVmdSection::SelfShadow);
+    return true;
+}
+
+void FVmdFileView::PrintOutData() const
+{
+    if (!IsValid())
+    {
+        return;
+    }
+
+    UE_LOG(LogMmdHelper, Log, TEXT("------ FVmdFileView::PrintOutData: Starte ------"));
+
+    UE_LOG(LogMmdHelper, Log, TEXT("Magic:%s"), ANSI_TO_TCHAR(Header->MagicHeader));
+    UE_LOG(LogMmdHelper, Log, TEXT("Model:%s"), *FVmdDataHelper::ConvertFromMmdName(Header->TargetModelName, sizeof(Header->TargetModelName)));
+
+    UE_LOG(LogMmdHelper, Log, TEXT("BoneFrames:%d"), BoneFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("FaceFrames:%d"), FaceFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("CameraFrames:%d"), CameraFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("LightFrames:%d"), LightFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("SelfShadowFrames:%d"), SelfShadowFrames.Num());
+    UE_LOG(LogMmdHelper, Log, TEXT("IkFrames:%d"), GetIkFrameNum());
+
+    /** Each distinct name is decoded once for the whole section */
+    FVmdNameColumn TsNames;
+
+    UE_LOG(LogMmdHelper, Log, TEXT("== BoneFrame info =="));
+    TsNames.DecodeFrom(BoneFrames);
+    for (int32 Idx = 0; Idx < BoneFrames.Num(); ++Idx)
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("Name:%s Frame:%d"), *TsNames.GetName(Idx), BoneFrames[Idx].Frame);
+    }
+
+    UE_LOG(LogMmdHelper, Log, TEXT("== FaceFrames info =="));
+    TsNames.DecodeFrom(FaceFrames);
+    for (int32 Idx = 0; Idx < FaceFrames.Num(); ++Idx)
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("Name:%s Frame:%d"), *TsNames.GetName(Idx), FaceFrames[Idx].Frame);
+    }
+
+    UE_LOG(LogMmdHelper, Log, TEXT("== CameraFrames info =="));
+    for (const FVmdRawCameraRecord& IterFrame : CameraFrames)
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("Frame:%d Location:%f,%f,%f Rotation:%f,%f,%f"),
+            IterFrame.Frame,
+            IterFrame.Location[0], IterFrame.Location[1], IterFrame.Location[2],
+            IterFrame.Rotate[0], IterFrame.Rotate[1], IterFrame.Rotate[2]
+        );
+    }
+
+    UE_LOG(LogMmdHelper, Log, TEXT("------ FVmdFileView::PrintOutData: End ------"));
+}
@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdMotionCache.h"
+
+#include "Vmd/VmdMotionImporter.h"
+#include "UeMmdHelper.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/xxhash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include <type_traits>
+
+
+namespace VmdMotionCachePrivate
+{
+    static constexpr uint32 CacheMagic = 0x43444D56; // "VMDC"
+
+    /** Bump when layout of cache file changes */
+    static constexpr uint32 FormatVersion = 1;
+
+    static constexpr int64 HashBufferSize = 1024 * 1024;
+
+    /** Sizes of bulk copied frames, cache written by a build with different struct layout is rejected */
+    static constexpr uint32 FrameLayout[] =
+    {
+        sizeof(FVmdCameraFrameData),
+        sizeof(FVmdLightFrameData),
+        sizeof(FVmdSelfShadowFrameData),
+        sizeof(FVmdMorphFrameData),
+    };
+
+    struct FCacheHeader
+    {
+        uint32 Magic = CacheMagic;
+        uint32 Format = FormatVersion;
+        uint32 Parser = FVmdMotionCache::ParserVersion;
+        uint32 Layout[UE_ARRAY_COUNT(FrameLayout)] = {};
+        uint64 SourceHash = 0;
+        int64 SourceSize = 0;
+
+    public:
+        friend FArchive& operator<<(FArchive& Ar, FCacheHeader& P)
+        {
+            Ar << P.Magic << P.Format << P.Parser;
+            for (uint32& IterSize : P.Layout)
+            {
+                Ar << IterSize;
+            }
+            Ar << P.SourceHash << P.SourceSize;
+            return Ar;
+        }
+    };
+
+    /** Check count against rest of archive before allocating */
+    static bool SerializeNum(FArchive& Ar, int32& InOutNum, int64 InElementSize)
+    {
+        Ar << InOutNum;
+        if (Ar.IsLoading() && (Ar.IsError() || InOutNum < 0 || (int64)InOutNum * InElementSize > Ar.TotalSize() - Ar.Tell()))
+        {
+            Ar.SetError();
+            return false;
+        }
+        return !Ar.IsError();
+    }
+
+    /** Frames without heap members are copied as one block */
+    template<typename ElementType>
+    static void SerializeBulk(FArchive& Ar, TArray<ElementType>& InOutArray)
+    {
+        static_assert(std::is_trivially_copyable_v<ElementType>, "Bulk serialized frame must be trivially copyable");
+
+        int32 TiNum = InOutArray.Num();
+        if (!SerializeNum(Ar, TiNum, sizeof(ElementType)))
+        {
+            InOutArray.Reset();
+            return;
+        }
+
+        if (Ar.IsLoading())
+        {
+            InOutArray.SetNumUninitialized(TiNum);
+        }
+        Ar.Serialize(InOutArray.GetData(), (int64)TiNum * sizeof(ElementType));
+    }
+
+    static void SerializeIkFrames(FArchive& Ar, TArray<FVmdIkFrameData>& InOutFrames)
+    {
+        /** Frame, show and state count at least */
+        int32 TiNum = InOutFrames.Num();
+        if (!SerializeNum(Ar, TiNum, sizeof(uint32) + sizeof(bool) + sizeof(int32)))
+        {
+            InOutFrames.Reset();
+            return;
+        }
+
+        InOutFrames.SetNum(TiNum);
+        for (FVmdIkFrameData& IterFrame : InOutFrames)
+        {
+            Ar << IterFrame.Frame << IterFrame.bShow;
+
+            /** Name length and enable at least */
+            int32 TiStateNum = IterFrame.IkStates.Num();
+            if (!SerializeNum(Ar, TiStateNum, sizeof(int32) + sizeof(bool)))
+            {
+                InOutFrames.Reset();
+                return;
+            }
+
+            IterFrame.IkStates.SetNum(TiStateNum);
+            for (FVmdIkStateData& IterState : IterFrame.IkStates)
+            {
+                Ar << IterState.Name << IterState.bEnable;
+            }
+        }
+    }
+
+    static void SerializeResult(FArchive& Ar, FVmdMotionImportResult& InOutResult)
+    {
+        Ar << InOutResult.TargetModelName;
+
+        SerializeBulk(Ar, InOutResult.CameraFrames);
+        SerializeBulk(Ar, InOutResult.LightFrames);
+        SerializeBulk(Ar, InOutResult.SelfShadowFrames);
+        SerializeIkFrames(Ar, InOutResult.IkFrames);
+
+        /** Name length and frame count at least */
+        int32 TiTrackNum = InOutResult.MorphTracks.Num();
+        if (!SerializeNum(Ar, TiTrackNum, 2 * sizeof(int32)))
+        {
+            return;
+        }
+
+        InOutResult.MorphNames.SetNum(TiTrackNum);
+        InOutResult.MorphTracks.SetNum(TiTrackNum);
+        for (int32 TrackIdx = 0; TrackIdx < TiTrackNum && !Ar.IsError(); ++TrackIdx)
+        {
+            Ar << InOutResult.MorphNames[TrackIdx];
+            SerializeBulk(Ar, InOutResult.MorphTracks[TrackIdx].Frames);
+        }
+    }
+
+    static FCacheHeader MakeHeader(const FVmdMotionCacheKey& InKey)
+    {
+        FCacheHeader TsHeader;
+        FMemory::Memcpy(TsHeader.Layout, FrameLayout, sizeof(FrameLayout));
+        TsHeader.SourceHash = InKey.SourceHash;
+        TsHeader.SourceSize = InKey.SourceSize;
+        return TsHeader;
+    }
+}
+
+FString FVmdMotionCacheKey::GetCachePath() const
+{
+    return FPaths::ProjectSavedDir() / TEXT("VmdCache") / FString::Printf(TEXT("%016llx.vmdc"), SourceHash);
+}
+
+bool FVmdMotionCache::MakeKey(const FString& InFilePath, FVmdMotionCacheKey& OutKey)
+{
+    using namespace VmdMotionCachePrivate;
+
+    TUniquePtr<IFileHandle> TpFile(IPlatformFile::GetPlatformPhysical().OpenRead(*InFilePath));
+    if (!TpFile)
+    {
+        return false;
+    }
+
+    OutKey.SourceSize = TpFile->Size();
+
+    TArray<uint8> TsBuffer;
+    TsBuffer.SetNumUninitialized(FMath::Min<int64>(HashBufferSize, FMath::Max<int64>(OutKey.SourceSize, 1)));
+
+    FXxHash64Builder TsHasher;
+    for (int64 TiOffset = 0; TiOffset < OutKey.SourceSize; TiOffset += TsBuffer.Num())
+    {
+        const int64 TiSize = FMath::Min<int64>(TsBuffer.Num(), OutKey.SourceSize - TiOffset);
+        if (!TpFile->Read(TsBuffer.GetData(), TiSize))
+        {
+            return false;
+        }
+        TsHasher.Update(TsBuffer.GetData(), TiSize);
+    }
+
+    OutKey.SourceHash = TsHasher.Finalize().Hash;
+    return true;
+}
+
+bool FVmdMotionCache::Load(const FVmdMotionCacheKey& InKey, FVmdMotionImportResult& OutResult)
+{
+    using namespace VmdMotionCachePrivate;
+
+    const FString TstrPath = InKey.GetCachePath();
+
+    TArray<uint8> TsBytes;
+    if (!IFileManager::Get().FileExists(*TstrPath) || !FFileHelper::LoadFileToArray(TsBytes, *TstrPath))
+    {
+        return false;
+    }
+
+    FMemoryReader TsReader(TsBytes);
+
+    const FCacheHeader TsExpected = MakeHeader(InKey);
+    FCacheHeader TsHeader;
+    TsReader << TsHeader;
+    if (TsReader.IsError()
+        || TsHeader.Magic != TsExpected.Magic
+        || TsHeader.Format != TsExpected.Format
+        || TsHeader.Parser != TsExpected.Parser
+        || FMemory::Memcmp(TsHeader.Layout, TsExpected.Layout, sizeof(TsHeader.Layout)) != 0
+        || TsHeader.SourceHash != TsExpected.SourceHash
+        || TsHeader.SourceSize != TsExpected.SourceSize)
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionCache::Load: Stale cache, path=%s"), *TstrPath);
+        return false;
+    }
+
+    OutResult.Reset();
+    SerializeResult(TsReader, OutResult);
+    if (TsReader.IsError() || TsReader.Tell() != TsReader.TotalSize())
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionCache::Load: Broken cache, path=%s"), *TstrPath);
+        OutResult.Reset();
+        return false;
+    }
+
+    return true;
+}
+
+bool FVmdMotionCache::Save(const FVmdMotionCacheKey& InKey, FVmdMotionImportResult& InResult)
+{
+    using namespace VmdMotionCachePrivate;
+
+    TArray<uint8> TsBytes;
+    FMemoryWriter TsWriter(TsBytes);
+
+    FCacheHeader TsHeader = MakeHeader(InKey);
+    TsWriter << TsHeader;
+    SerializeResult(TsWriter, InResult);
+
+    /** Write aside and move, so concurrent imports of the same file never see a partial cache */
+    const FString TstrPath = InKey.GetCachePath();
+    const FString TstrTempPath = FPaths::CreateTempFilename(*FPaths::GetPath(TstrPath), TEXT("VmdCache"), TEXT(".tmp"));
+    if (!FFileHelper::SaveArrayToFile(TsBytes, *TstrTempPath) || !IFileManager::Get().Move(*TstrPath, *TstrTempPath, true/*bReplace*/))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionCache::Save: Failed write cache, path=%s"), *TstrPath);
+        IFileManager::Get().Delete(*TstrTempPath, false, false, true);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVmdMotionImportResult;
+
+
+/** Identifies the content of a source vmd file */
+struct FVmdMotionCacheKey
+{
+public:
+    uint64 SourceHash = 0;
+    int64 SourceSize = 0;
+
+public:
+    /** Saved/VmdCache/<hash>.vmdc */
+    FString GetCachePath() const;
+};
+
+/**
+ * Cache of converted motion data in a binary intermediate file (.vmdc)
+ * Entries are keyed by source content, so moved or renamed vmd files still hit
+ */
+namespace FVmdMotionCache
+{
+    /** Bump when conversion in FVmdMotionImporter changes, old entries are then treated as misses */
+    static constexpr uint32 ParserVersion = 2;
+
+    /** Hash source file content */
+    bool MakeKey(const FString& InFilePath, FVmdMotionCacheKey& OutKey);
+
+    /** @return False on miss, stale version or broken cache file */
+    bool Load(const FVmdMotionCacheKey& InKey, FVmdMotionImportResult& OutResult);
+
+    /** Result is not modified, it is non const because loading and saving share one archive serializer */
+    bool Save(const FVmdMotionCacheKey& InKey, FVmdMotionImportResult& InResult);
+}
@@ -0,0 +1,389 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdMotionImporter.h"
+
+#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdStreamReader.h"
+#include "Vmd/VmdNameInterner.h"
+#include "Vmd/VmdMotionCache.h"
+#include "Vmd/VmdRadixSort.h"
+#include "Vmd/VmdContentHash.h"
+#include "VmdCore/VmdCameraMath.h"
+#include "UeMmdHelper.h"
+#include "Async/ParallelFor.h"
+
+
+namespace VmdMotionImporterPrivate
+{
+    /** One face record, morph tracks are contiguous runs of these after sorting */
+    struct FMorphSortItem
+    {
+        uint32 NameId;
+        uint32 Frame;
+        float Factor;
+    };
+
+    static uint64 GetMorphSortKey(const FMorphSortItem& InItem)
+    {
+        return ((uint64)InItem.NameId << 32) | InItem.Frame;
+    }
+
+    static uint32 GetFrameSortKey(const FVmdCameraFrameData& InFrame) { return InFrame.Frame; }
+    static uint32 GetFrameSortKey(const FVmdLightFrameData& InFrame) { return InFrame.Frame; }
+    static uint32 GetFrameSortKey(const FVmdSelfShadowFrameData& InFrame) { return InFrame.Frame; }
+    static uint32 GetFrameSortKey(const FVmdIkFrameData& InFrame) { return InFrame.Frame; }
+
+    template<typename FrameType>
+    static void SortFrames(TArray<FrameType>& InOutFrames)
+    {
+        VmdRadixSort::SortByKey(InOutFrames, [](const FrameType& InFrame) { return GetFrameSortKey(InFrame); });
+    }
+
+    static void AppendVector(FXxHash64Builder& InOutBuilder, const FVector& InVector)
+    {
+        FVmdContentHash::Append(InOutBuilder, InVector.X);
+        FVmdContentHash::Append(InOutBuilder, InVector.Y);
+        FVmdContentHash::Append(InOutBuilder, InVector.Z);
+    }
+
+    static void AppendFrame(FXxHash64Builder& InOutBuilder, const FVmdCameraFrameData& InFrame)
+    {
+        FVmdContentHash::Append(InOutBuilder, InFrame.Frame);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Length);
+        AppendVector(InOutBuilder, InFrame.Location);
+        AppendVector(InOutBuilder, InFrame.Rotate);
+        FVmdContentHash::Append(InOutBuilder, InFrame.ViewingAngle);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Perspective);
+        InOutBuilder.Update(InFrame.Interpolation, sizeof(InFrame.Interpolation));
+    }
+
+    static void AppendFrame(FXxHash64Builder& InOutBuilder, const FVmdLightFrameData& InFrame)
+    {
+        FVmdContentHash::Append(InOutBuilder, InFrame.Frame);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Color.R);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Color.G);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Color.B);
+        AppendVector(InOutBuilder, InFrame.Position);
+    }
+
+    static void AppendFrame(FXxHash64Builder& InOutBuilder, const FVmdSelfShadowFrameData& InFrame)
+    {
+        FVmdContentHash::Append(InOutBuilder, InFrame.Frame);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Mode);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Distance);
+    }
+
+    static void AppendFrame(FXxHash64Builder& InOutBuilder, const FVmdIkFrameData& InFrame)
+    {
+        FVmdContentHash::Append(InOutBuilder, InFrame.Frame);
+        FVmdContentHash::Append(InOutBuilder, InFrame.bShow);
+        FVmdContentHash::Append(InOutBuilder, InFrame.IkStates.Num());
+        for (const FVmdIkStateData& IterState : InFrame.IkStates)
+        {
+            FVmdContentHash::Append(InOutBuilder, IterState.Name);
+            FVmdContentHash::Append(InOutBuilder, IterState.bEnable);
+        }
+    }
+
+    static void AppendFrame(FXxHash64Builder& InOutBuilder, const FVmdMorphFrameData& InFrame)
+    {
+        FVmdContentHash::Append(InOutBuilder, InFrame.Frame);
+        FVmdContentHash::Append(InOutBuilder, InFrame.Factor);
+    }
+
+    template<typename FrameType>
+    static uint64 HashFrames(const TArray<FrameType>& InFrames)
+    {
+        FXxHash64Builder TsBuilder;
+        FVmdContentHash::Append(TsBuilder, InFrames.Num());
+        for (const FrameType& IterFrame : InFrames)
+        {
+            AppendFrame(TsBuilder, IterFrame);
+        }
+        return TsBuilder.Finalize().Hash;
+    }
+}
+
+
+void FVmdMotionImportResult::Reset()
+{
+    TargetModelName.Reset();
+    CameraFrames.Reset();
+    LightFrames.Reset();
+    SelfShadowFrames.Reset();
+    IkFrames.Reset();
+    MorphNames.Reset();
+    MorphTracks.Reset();
+    CameraHash = 0;
+    LightHash = 0;
+    SelfShadowHash = 0;
+    IkHash = 0;
+    MorphHashes.Reset();
+}
+
+void FVmdMotionImportResult::ComputeHashes()
+{
+    using namespace VmdMotionImporterPrivate;
+
+    CameraHash = HashFrames(CameraFrames);
+    LightHash = HashFrames(LightFrames);
+    SelfShadowHash = HashFrames(SelfShadowFrames);
+    IkHash = HashFrames(IkFrames);
+
+    MorphHashes.SetNumUninitialized(MorphTracks.Num());
+    for (int32 TrackIdx = 0; TrackIdx < MorphTracks.Num(); ++TrackIdx)
+    {
+        MorphHashes[TrackIdx] = HashFrames(MorphTracks[TrackIdx].Frames);
+    }
+}
+
+bool FVmdMotionImporter::ImportFromFile(const FString& InFilePath, FVmdMotionImportResult& OutResult, bool bInUseCache, FProgressCallback InProgress)
+{
+    if (!bInUseCache)
+    {
+        return ImportFromVmd(InFilePath, OutResult, InProgress);
+    }
+
+    FVmdMotionCacheKey TsCacheKey;
+    if (!FVmdMotionCache::MakeKey(InFilePath, TsCacheKey))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionImporter::ImportFromFile: Failed hash file, path=%s"), *InFilePath);
+        return false;
+    }
+
+    if (FVmdMotionCache::Load(TsCacheKey, OutResult))
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionImporter::ImportFromFile: Loaded from cache, path=%s"), *InFilePath);
+        OutResult.ComputeHashes();
+        return InProgress(1.0f);
+    }
+
+    if (!ImportFromVmd(InFilePath, OutResult, InProgress))
+    {
+        return false;
+    }
+
+    FVmdMotionCache::Save(TsCacheKey, OutResult);
+    return true;
+}
+
+bool FVmdMotionImporter::ImportFromVmd(const FString& InFilePath, FVmdMotionImportResult& OutResult, FProgressCallback InProgress)
+{
+    OutResult.Reset();
+
+    FVmdStreamReader TsReader;
+    if (!TsReader.Open(InFilePath))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionImporter::ImportFromVmd: Bad vmd file, path=%s"), *InFilePath);
+        return false;
+    }
+
+    /** Bone frames are not used by motion data asset */
+    TsReader.SetSkipSection(EVmdSection::Bone, true);
+
+    TArray<FVmdCameraFrameData> TsCameraFrames;
+    TArray<FVmdLightFrameData> TsLightFrames;
+    TArray<FVmdSelfShadowFrameData> TsSelfShadowFrames;
+    TArray<FVmdIkFrameData> TsIkFrames;
+
+    /** Tracks are indexed by interned name id, names are decoded once per distinct raw name */
+    FVmdNameInterner TsMorphNames;
+    FVmdNameInterner TsIkNames;
+    TArray<VmdMotionImporterPrivate::FMorphSortItem> TsMorphItems;
+    TArray<int32> TsBatchNameIds;
+
+    /** Convert each batch while later sections are still being read, reading takes most of the progress range */
+    constexpr float TfReadProgress = 0.9f;
+    const float TfProgressPerByte = TfReadProgress / FMath::Max<int64>(TsReader.GetFileSize(), 1);
+
+    FVmdRecordBatch TsBatch;
+    while (TsReader.ReadNextBatch(TsBatch))
+    {
+        if (!InProgress(TsReader.GetOffset() * TfProgressPerByte))
+        {
+            UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionImporter::ImportFromVmd: Cancelled, path=%s"), *InFilePath);
+            return false;
+        }
+
+        switch (TsBatch.Section)
+        {
+        case EVmdSection::Face:
+        {
+            /** Whole name column of the batch is interned in one pass, frames are grouped by sorting after reading */
+            const TConstArrayView<FVmdRawFaceRecord> TsRecords = TsBatch.GetFaceRecords();
+            TsBatchNameIds.SetNumUninitialized(TsRecords.Num());
+            TsMorphNames.InternColumn(reinterpret_cast<const char*>(TsRecords.GetData()), sizeof(FVmdRawFaceRecord), sizeof(FVmdRawFaceRecord::Name), TsBatchNameIds);
+
+            TsMorphItems.Reserve(TsBatch.SectionNum);
+            for (int32 Idx = 0; Idx < TsRecords.Num(); ++Idx)
+            {
+                TsMorphItems.Add({ (uint32)TsBatchNameIds[Idx], TsRecords[Idx].Frame, TsRecords[Idx].Factor });
+            }
+            break;
+        }
+
+        case EVmdSection::Camera:
+            TsCameraFrames.Reserve(TsBatch.SectionNum);
+            for (const FVmdRawCameraRecord& IterRawFrame : TsBatch.GetCameraRecords())
+            {
+                FVmdCameraFrameData& TrAdded = TsCameraFrames.AddZeroed_GetRef();
+                TrAdded.Frame = IterRawFrame.Frame;
+                TrAdded.Length = IterRawFrame.Length;
+                TrAdded.Location = FVector(IterRawFrame.Location[0], IterRawFrame.Location[1], IterRawFrame.Location[2]);
+
+                const VmdCore::FVec3 TsRotate = VmdCore::ConvertCameraRotation(IterRawFrame.Rotate[0], IterRawFrame.Rotate[1], IterRawFrame.Rotate[2]);
+                TrAdded.Rotate = FVector(TsRotate.X, TsRotate.Y, TsRotate.Z);
+
+                TrAdded.ViewingAngle = IterRawFrame.ViewingAngle;
+                TrAdded.Perspective = IterRawFrame.Perspective;
+                FMemory::Memcpy(TrAdded.Interpolation, IterRawFrame.Interpolation, sizeof(TrAdded.Interpolation));
+            }
+            break;
+
+        case EVmdSection::Light:
+            TsLightFrames.Reserve(TsBatch.SectionNum);
+            for (const FVmdRawLightRecord& IterRawFrame : TsBatch.GetLightRecords())
+            {
+                FVmdLightFrameData& TrAdded = TsLightFrames.AddZeroed_GetRef();
+                TrAdded.Frame = IterRawFrame.Frame;
+                TrAdded.Color = FLinearColor(IterRawFrame.Color[0], IterRawFrame.Color[1], IterRawFrame.Color[2]);
+                TrAdded.Position = FVector(IterRawFrame.Position[0], IterRawFrame.Position[1], IterRawFrame.Position[2]);
+            }
+            break;
+
+        case EVmdSection::SelfShadow:
+            TsSelfShadowFrames.Reserve(TsBatch.SectionNum);
+            for (const FVmdRawSelfShadowRecord& IterRawFrame : TsBatch.GetSelfShadowRecords())
+            {
+                FVmdSelfShadowFrameData& TrAdded = TsSelfShadowFrames.AddZeroed_GetRef();
+                TrAdded.Frame = IterRawFrame.Frame;
+                TrAdded.Mode = IterRawFrame.Mode;
+                TrAdded.Distance = IterRawFrame.Distance;
+            }
+            break;
+
+        case EVmdSection::Ik:
+            TsIkFrames.Reserve(TsBatch.SectionNum);
+            for (FVmdIkRecordIterator IterRecord = TsBatch.GetIkRecords(); IterRecord; ++IterRecord)
+            {
+                FVmdIkFrameData& TrAdded = TsIkFrames.AddDefaulted_GetRef();
+                TrAdded.Frame = IterRecord.GetRecord().Frame;
+                TrAdded.bShow = IterRecord.GetRecord().Show != 0;
+
+                for (const FVmdRawIkInfo& IterInfo : IterRecord.GetInfos())
+                {
+                    FVmdIkStateData& TrState = TrAdded.IkStates.AddDefaulted_GetRef();
+                    TrState.Name = TsIkNames.GetName(TsIkNames.Intern(IterInfo.Name, sizeof(IterInfo.Name)));
+                    TrState.bEnable = IterInfo.Enable != 0;
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (TsReader.HasError())
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionImporter::ImportFromVmd: Failed read vmd file, path=%s"), *InFilePath);
+        return false;
+    }
+
+    /** Last chance to cancel before sorting, which runs to the end once started */
+    if (!InProgress(TfReadProgress))
+    {
+        UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionImporter::ImportFromVmd: Cancelled, path=%s"), *InFilePath);
+        return false;
+    }
+
+    OutResult.TargetModelName = FVmdDataHelper::ConvertFromMmdName(TsReader.GetHeader().TargetModelName, sizeof(FVmdRawHeader::TargetModelName));
+
+    OutResult.CameraFrames = MoveTemp(TsCameraFrames);
+    OutResult.LightFrames = MoveTemp(TsLightFrames);
+    OutResult.SelfShadowFrames = MoveTemp(TsSelfShadowFrames);
+    OutResult.IkFrames = MoveTemp(TsIkFrames);
+
+    /**
+     * Every section is sorted concurrently, sorted sections are only scanned once
+     * Frames of each morph name become one contiguous run sorted by frame, in name id order
+     */
+    constexpr int32 TiSortJobNum = 5;
+    ParallelFor(TiSortJobNum, [&](int32 InJobIndex)
+        {
+            using namespace VmdMotionImporterPrivate;
+            switch (InJobIndex)
+            {
+            case 0: SortFrames(OutResult.CameraFrames); break;
+            case 1: SortFrames(OutResult.LightFrames); break;
+            case 2: SortFrames(OutResult.SelfShadowFrames); break;
+            case 3: SortFrames(OutResult.IkFrames); break;
+            default: VmdRadixSort::SortByKey(TsMorphItems, &GetMorphSortKey); break;
+            }
+        }, EParallelForFlags::Unbalanced);
+
+    int32 TiNextRun = 0;
+    for (int32 TrackId = 0; TrackId < TsMorphNames.Num(); ++TrackId)
+    {
+        const FString& TrName = TsMorphNames.GetName(TrackId);
+
+        const int32 TiRunBegin = TiNextRun;
+        int32 TiRunEnd = TiRunBegin;
+        while (TiRunEnd < TsMorphItems.Num() && TsMorphItems[TiRunEnd].NameId == (uint32)TrackId)
+        {
+            ++TiRunEnd;
+        }
+
+        const int32 TiFrameNum = TiRunEnd - TiRunBegin;
+        TiNextRun = TiRunEnd;
+
+        /** Ignore empty data */
+        if (TiFrameNum == 0)
+        {
+            UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionImporter::ImportFromVmd:(Filter) remov empty, name=%s"),
+                *TrName
+            );
+            continue;
+        }
+
+        /** Ignore data with only one frame */
+        if (TiFrameNum == 1)
+        {
+            if (TsMorphItems[TiRunBegin].Factor != 0.0f)
+            {
+                UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionImporter::ImportFromVmd:(Filter) Ignored factor not zero"));
+            }
+
+            if (TsMorphItems[TiRunBegin].Frame != 0)
+            {
+                UE_LOG(LogMmdHelper, Warning, TEXT("FVmdMotionImporter::ImportFromVmd:(Filter) Ignored frame not zero"));
+            }
+
+            UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionImporter::ImportFromVmd:(Filter) remov single frame, name=%s"),
+                *TrName
+            );
+            continue;
+        }
+
+        /** Insert data, the run is already sorted by frame */
+        OutResult.MorphNames.Add(TrName);
+        FVmdMorphTrackData& TrTrack = OutResult.MorphTracks.AddDefaulted_GetRef();
+        TrTrack.Frames.SetNumUninitialized(TiFrameNum);
+        for (int32 Idx = 0; Idx < TiFrameNum; ++Idx)
+        {
+            const VmdMotionImporterPrivate::FMorphSortItem& TrItem = TsMorphItems[TiRunBegin + Idx];
+            TrTrack.Frames[Idx].Frame = TrItem.Frame;
+            TrTrack.Frames[Idx].Factor = TrItem.Factor;
+        }
+
+        UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionImporter::ImportFromVmd: Morph track, name=%s num=%d"),
+            *TrName,
+            TiFrameNum
+        );
+    }
+
+    OutResult.ComputeHashes();
+
+    InProgress(1.0f);
+    return true;
+}
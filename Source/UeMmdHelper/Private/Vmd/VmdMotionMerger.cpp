@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdMotionMerger.h"
+
+#include "Vmd/VmdMotionImporter.h"
+#include "Vmd/VmdContentHash.h"
+#include "UeMmdHelper.h"
+
+
+namespace VmdMotionMergerPrivate
+{
+    /** Combine one track of every source by policy, sources without frames take no part */
+    template<typename FrameType>
+    static void MergeTrack(TArray<TArray<FrameType>*, TInlineAllocator<8>>& InStreams, EVmdMergePolicy InPolicy, TArray<FrameType>& OutFrames)
+    {
+        InStreams.RemoveAll([](const TArray<FrameType>* InStream) { return InStream->Num() == 0; });
+        if (InStreams.Num() == 0)
+        {
+            OutFrames.Reset();
+            return;
+        }
+
+        if (InStreams.Num() == 1 || InPolicy != EVmdMergePolicy::MergeKeys)
+        {
+            TArray<FrameType>* TpKept = InPolicy == EVmdMergePolicy::KeepFirst ? InStreams[0] : InStreams.Last();
+            OutFrames = MoveTemp(*TpKept);
+            for (TArray<FrameType>* IterStream : InStreams)
+            {
+                IterStream->Empty();
+            }
+            return;
+        }
+
+        FVmdMotionMerger::MergeSortedFrames<FrameType>(InStreams, OutFrames);
+    }
+
+    /** Fold frames of a source into frames merged so far, both are left in InOutMerged */
+    template<typename FrameType>
+    static void MergeFrames(TArray<FrameType>& InOutMerged, TArray<FrameType>& InOutSource, EVmdMergePolicy InPolicy)
+    {
+        TArray<TArray<FrameType>*, TInlineAllocator<8>> TsStreams = { &InOutMerged, &InOutSource };
+        TArray<FrameType> TsFrames;
+        MergeTrack(TsStreams, InPolicy, TsFrames);
+        InOutMerged = MoveTemp(TsFrames);
+    }
+}
+
+int32 FVmdMotionMerger::MergeInto(FVmdMotionImportResult& InOutMerged, FVmdMotionImportResult& InOutSource, EVmdMergePolicy InPolicy)
+{
+    using namespace VmdMotionMergerPrivate;
+
+    if (InOutMerged.TargetModelName.IsEmpty())
+    {
+        InOutMerged.TargetModelName = MoveTemp(InOutSource.TargetModelName);
+    }
+
+    MergeFrames(InOutMerged.CameraFrames, InOutSource.CameraFrames, InPolicy);
+    MergeFrames(InOutMerged.LightFrames, InOutSource.LightFrames, InPolicy);
+    MergeFrames(InOutMerged.SelfShadowFrames, InOutSource.SelfShadowFrames, InPolicy);
+    MergeFrames(InOutMerged.IkFrames, InOutSource.IkFrames, InPolicy);
+
+    /** Tracks new to the merged result are appended, so tracks stay in order of first appearance */
+    TMap<FString, int32> TsTrackIndices;
+    TsTrackIndices.Reserve(InOutMerged.MorphNames.Num());
+    for (int32 TrackIdx = 0; TrackIdx < InOutMerged.MorphNames.Num(); ++TrackIdx)
+    {
+        TsTrackIndices.Add(InOutMerged.MorphNames[TrackIdx], TrackIdx);
+    }
+
+    int32 TiSharedNum = 0;
+    for (int32 TrackIdx = 0; TrackIdx < InOutSource.MorphTracks.Num(); ++TrackIdx)
+    {
+        TArray<FVmdMorphFrameData>& TrFrames = InOutSource.MorphTracks[TrackIdx].Frames;
+        const int32* TpIndex = TsTrackIndices.Find(InOutSource.MorphNames[TrackIdx]);
+        if (TpIndex)
+        {
+            ++TiSharedNum;
+            MergeFrames(InOutMerged.MorphTracks[*TpIndex].Frames, TrFrames, InPolicy);
+        }
+        else if (TrFrames.Num() > 0)
+        {
+            TsTrackIndices.Add(InOutSource.MorphNames[TrackIdx], InOutMerged.MorphTracks.Num());
+            InOutMerged.MorphNames.Add(MoveTemp(InOutSource.MorphNames[TrackIdx]));
+            InOutMerged.MorphTracks.Add(MoveTemp(InOutSource.MorphTracks[TrackIdx]));
+        }
+    }
+
+    /** Hashes no longer match the frames, an empty hash list is never taken as valid */
+    InOutMerged.CameraHash = FVmdContentHash::None;
+    InOutMerged.LightHash = FVmdContentHash::None;
+    InOutMerged.SelfShadowHash = FVmdContentHash::None;
+    InOutMerged.IkHash = FVmdContentHash::None;
+    InOutMerged.MorphHashes.Reset();
+
+    InOutSource.Reset();
+    return TiSharedNum;
+}
+
+void FVmdMotionMerger::Merge(TArrayView<FVmdMotionImportResult> InOutSources, EVmdMergePolicy InPolicy, FVmdMotionImportResult& OutResult)
+{
+    OutResult.Reset();
+
+    int32 TiSharedNum = 0;
+    for (FVmdMotionImportResult& IterSource : InOutSources)
+    {
+        TiSharedNum += MergeInto(OutResult, IterSource, InPolicy);
+    }
+
+    OutResult.ComputeHashes();
+
+    UE_LOG(LogMmdHelper, Log, TEXT("FVmdMotionMerger::Merge: Merged, sources=%d morphTracks=%d sharedTracks=%d policy=%s"),
+        InOutSources.Num(),
+        OutResult.MorphTracks.Num(),
+        TiSharedNum,
+        *UEnum::GetValueAsString(InPolicy)
+    );
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdNameInterner.h"
+
+#include "Vmd/VmdDataHelper.h"
+#include "Vmd/VmdRawRecords.h"
+
+
+int32 FVmdNameInterner::Intern(const char* InField, int32 InFieldSize)
+{
+    check(InFieldSize <= MaxFieldSize);
+
+    /** Bytes after terminator are often garbage left by exporters, they are not part of the name */
+    int32 TiLen = 0;
+    while (TiLen < InFieldSize && InField[TiLen] != 0)
+    {
+        ++TiLen;
+    }
+
+    FRawKey TsKey;
+    FMemory::Memcpy(TsKey.Words, InField, TiLen);
+
+    if (LastId != INDEX_NONE && TsKey == LastKey)
+    {
+        return LastId;
+    }
+
+    int32 TiId = INDEX_NONE;
+    if (const int32* TpFoundId = RawIds.Find(TsKey))
+    {
+        TiId = *TpFoundId;
+    }
+    else
+    {
+        FString TstrName = FVmdDataHelper::ConvertFromMmdName(InField, TiLen);
+        if (const int32* TpNameId = NameIds.Find(TstrName))
+        {
+            TiId = *TpNameId;
+        }
+        else
+        {
+            TiId = Names.Num();
+            NameIds.Add(TstrName, TiId);
+            Names.Add(MoveTemp(TstrName));
+        }
+
+        RawIds.Add(TsKey, TiId);
+    }
+
+    LastKey = TsKey;
+    LastId = TiId;
+    return TiId;
+}
+
+void FVmdNameInterner::InternColumn(const char* InFields, int64 InStride, int32 InFieldSize, TArrayView<int32> OutIds)
+{
+    const char* TpField = InFields;
+    for (int32& IterId : OutIds)
+    {
+        IterId = Intern(TpField, InFieldSize);
+        TpField += InStride;
+    }
+}
+
+void FVmdNameInterner::Reset()
+{
+    RawIds.Reset();
+    NameIds.Reset();
+    Names.Reset();
+    LastId = INDEX_NONE;
+}
+
+void FVmdNameColumn::Reset()
+{
+    NameIds.Reset();
+    Names.Reset();
+}
+
+void FVmdNameColumn::DecodeFrom(TConstArrayView<FVmdRawBoneRecord> InRecords)
+{
+    static_assert(STRUCT_OFFSET(FVmdRawBoneRecord, Name) == 0, "Name is not at start of record");
+    DecodeFrom(reinterpret_cast<const char*>(InRecords.GetData()), sizeof(FVmdRawBoneRecord), sizeof(FVmdRawBoneRecord::Name), InRecords.Num());
+}
+
+void FVmdNameColumn::DecodeFrom(TConstArrayView<FVmdRawFaceRecord> InRecords)
+{
+    static_assert(STRUCT_OFFSET(FVmdRawFaceRecord, Name) == 0, "Name is not at start of record");
+    DecodeFrom(reinterpret_cast<const char*>(InRecords.GetData()), sizeof(FVmdRawFaceRecord), sizeof(FVmdRawFaceRecord::Name), InRecords.Num());
+}
+
+void FVmdNameColumn::DecodeFrom(const char* InFields, int64 InStride, int32 InFieldSize, int32 InNum)
+{
+    FVmdNameInterner TsInterner;
+    NameIds.SetNumUninitialized(InNum);
+    TsInterner.InternColumn(InFields, InStride, InFieldSize, NameIds);
+    Names = TsInterner.GetNames();
+}
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdStreamReader.h"
+
+#include "UeMmdHelper.h"
+#include "HAL/PlatformFileManager.h"
+
+
+FVmdStreamReader::FVmdStreamReader(int32 InBatchSize)
+    : BatchSize(FMath::Max(1, InBatchSize))
+{
+    FMemory::Memzero(Header);
+}
+
+FVmdStreamReader::~FVmdStreamReader()
+{
+}
+
+bool FVmdStreamReader::Open(const FString& InFilePath)
+{
+    IPlatformFile& FileSystem = IPlatformFile::GetPlatformPhysical();
+    FileHandle.Reset(FileSystem.OpenRead(*InFilePath));
+
+    Offset = 0;
+    CurrentSection = EVmdSection::Num;
+    NextSectionIndex = 0;
+    CurrentSectionNum = 0;
+    CurrentSectionRead = 0;
+    Validation = FVmdValidationResult();
+    bError = false;
+
+    if (!FileHandle.IsValid())
+    {
+        Validation.Error = EVmdValidationError::ReadFailed;
+        UE_LOG(LogMmdHelper, Error, TEXT("FVmdStreamReader::Open: Failed create handle %s"), *InFilePath);
+        bError = true;
+        return false;
+    }
+
+    FileSize = FileHandle->Size();
+    UE_LOG(LogMmdHelper, Log, TEXT("FVmdStreamReader::Open: file=%s size=%lld batch=%d"), *InFilePath, FileSize, BatchSize);
+
+    /** Section counts are trusted after this, nothing is allocated for a broken file */
+    Validation = FVmdDataHelper::ValidateVmdFile(*FileHandle);
+    if (!Validation.IsValid())
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdStreamReader::Open: Validation failed, file=%s %s"), *InFilePath, *Validation.ToString());
+        bError = true;
+        return false;
+    }
+
+    if (!FileHandle->Seek(0) || !ReadBytes(&Header, sizeof(Header)))
+    {
+        bError = true;
+        return false;
+    }
+
+    return true;
+}
+
+void FVmdStreamReader::SetSkipSection(EVmdSection InSection, bool bInSkip)
+{
+    const uint32 TiBit = 1u << (uint32)InSection;
+    SkipSectionMask = bInSkip ? (SkipSectionMask | TiBit) : (SkipSectionMask & ~TiBit);
+}
+
+bool FVmdStreamReader::ReadNextBatch(FVmdRecordBatch& OutBatch)
+{
+    if (bError || !FileHandle.IsValid())
+    {
+        return false;
+    }
+
+    while (CurrentSectionRead >= CurrentSectionNum)
+    {
+        if (!BeginNextSection())
+        {
+            return false;
+        }
+    }
+
+    const int32 TiRecordSize = GetVmdRecordSize(CurrentSection);
+    int32 TiNum = FMath::Min(BatchSize, CurrentSectionNum - CurrentSectionRead);
+
+    if (TiRecordSize == 0)
+    {
+        TiNum = ReadIkRecords(TiNum);
+        if (TiNum == 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        /** Buffer only grows to one batch of the largest record */
+        Buffer.SetNumUninitialized(TiNum * TiRecordSize, EAllowShrinking::No);
+        if (!ReadBytes(Buffer.GetData(), Buffer.Num()))
+        {
+            return false;
+        }
+    }
+
+    OutBatch.Section = CurrentSection;
+    OutBatch.FirstIndex = CurrentSectionRead;
+    OutBatch.SectionNum = CurrentSectionNum;
+    OutBatch.Num = TiNum;
+    OutBatch.Data = Buffer.GetData();
+
+    CurrentSectionRead += TiNum;
+    return true;
+}
+
+bool FVmdStreamReader::ForEachBatch(TFunctionRef<bool(const FVmdRecordBatch&)> InConsumer)
+{
+    FVmdRecordBatch TsBatch;
+    while (ReadNextBatch(TsBatch))
+    {
+        if (!InConsumer(TsBatch))
+        {
+            return false;
+        }
+    }
+
+    return !bError;
+}
+
+bool FVmdStreamReader::BeginNextSection()
+{
+    if (NextSectionIndex >= (int32)EVmdSection::Num)
+    {
+        CurrentSection = EVmdSection::Num;
+        return false;
+    }
+
+    CurrentSection = (EVmdSection)NextSectionIndex++;
+    CurrentSectionRead = 0;
+    CurrentSectionNum = 0;
+
+    /** Skipped sections are never read, the next one seeks over them, offset still moves past them for progress */
+    if (SkipSectionMask & (1u << (uint32)CurrentSection))
+    {
+        Offset = Validation.GetOffset(CurrentSection) + Validation.GetBytes(CurrentSection);
+        return true;
+    }
+
+    Offset = Validation.GetOffset(CurrentSection);
+    if (!FileHandle->Seek(Offset))
+    {
+        bError = true;
+        return false;
+    }
+
+    CurrentSectionNum = Validation.GetCount(CurrentSection);
+    return true;
+}
+
+int32 FVmdStreamReader::ReadIkRecords(int32 InMaxNum)
+{
+    const int64 TiBufferLimit = (int64)BatchSize * VmdMaxRecordSize;
+    Buffer.Reset();
+
+    int32 TiNum = 0;
+    while (TiNum < InMaxNum)
+    {
+        FVmdRawIkRecord TsRecord;
+        if (!ReadBytes(&TsRecord, sizeof(TsRecord)))
+        {
+            return 0;
+        }
+
+        /** Validation walked these counts already, checked again since the size is narrowed to the buffer index */
+        const int64 TiRecordSize = FVmdIkRecordIterator::GetRecordSize(TsRecord.IkCount);
+        if (TiRecordSize - (int64)sizeof(TsRecord) > FileSize - Offset || TiRecordSize > MAX_int32 - (int64)Buffer.Num())
+        {
+            UE_LOG(LogMmdHelper, Warning, TEXT("FVmdStreamReader::ReadIkRecords: Bad ik info count, offset=%lld count=%u size=%lld"), Offset, TsRecord.IkCount, FileSize);
+            bError = true;
+            return 0;
+        }
+
+        const int32 TiRecordOffset = Buffer.Num();
+        Buffer.AddUninitialized((int32)TiRecordSize);
+        FMemory::Memcpy(Buffer.GetData() + TiRecordOffset, &TsRecord, sizeof(TsRecord));
+        if (!ReadBytes(Buffer.GetData() + TiRecordOffset + sizeof(TsRecord), TiRecordSize - sizeof(TsRecord)))
+        {
+            return 0;
+        }
+
+        ++TiNum;
+
+        /** A single record may exceed the limit, it is still handed out whole */
+        if (Buffer.Num() >= TiBufferLimit)
+        {
+            break;
+        }
+    }
+
+    return TiNum;
+}
+
+bool FVmdStreamReader::ReadBytes(void* OutData, int64 InSize)
+{
+    if (InSize > FileSize - Offset || !FileHandle->Read(static_cast<uint8*>(OutData), InSize))
+    {
+        UE_LOG(LogMmdHelper, Warning, TEXT("FVmdStreamReader::ReadBytes: Unexpected end of file, offset=%lld read=%lld size=%lld"), Offset, InSize, FileSize);
+        bError = true;
+        return false;
+    }
+
+    Offset += InSize;
+    return true;
+}
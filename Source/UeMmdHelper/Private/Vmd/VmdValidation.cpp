@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Vmd/VmdValidation.h"
+
+#include "HAL/PlatformFileManager.h"
+
+
+FString FVmdValidationResult::ToString() const
+{
+    const FString TstrError = ANSI_TO_TCHAR(VmdCore::GetErrorName(Error));
+    if (ErrorSection == EVmdSection::Num)
+    {
+        return FString::Printf(TEXT("error=%s size=%lld"), *TstrError, FileSize);
+    }
+
+    const int32 TiSection = (int32)ErrorSection;
+    return FString::Printf(TEXT("error=%s section=%d offset=%lld count=%d size=%lld"),
+        *TstrError, TiSection, SectionOffsets[TiSection], SectionCounts[TiSection], FileSize);
+}
+
+FVmdValidationResult FVmdDataHelper::ValidateVmdLayout(int64 InFileSize, FVmdReadAt InReadAt)
+{
+    FVmdValidationResult TsResult;
+    VmdCore::ValidateLayout(InFileSize, [](void* InContext, int64 InOffset, void* OutData, int64 InSize)
+        {
+            return (*static_cast<FVmdReadAt*>(InContext))(InOffset, OutData, InSize);
+        }, &InReadAt, TsResult);
+    return TsResult;
+}
+
+FVmdValidationResult FVmdDataHelper::ValidateVmdMemory(const uint8* InData, int64 InSize)
+{
+    FVmdValidationResult TsResult;
+    VmdCore::ValidateMemory(InData, InSize, TsResult);
+    return TsResult;
+}
+
+FVmdValidationResult FVmdDataHelper::ValidateVmdFile(IFileHandle& InFileHandle)
+{
+    return ValidateVmdLayout(InFileHandle.Size(), [&InFileHandle](int64 InOffset, void* OutData, int64 InReadSize)
+        {
+            return InFileHandle.Seek(InOffset) && InFileHandle.Read(static_cast<uint8*>(OutData), InReadSize);
+        });
+}
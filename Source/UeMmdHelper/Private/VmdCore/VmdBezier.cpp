@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdBezier.h"
+
+#include <cmath>
+
+
+namespace VmdCore
+{
+    static constexpr int32_t MaxNewtonSteps = 8;
+    static constexpr int32_t MaxBisectionSteps = 32;
+
+    static float Clamp01(float InValue)
+    {
+        return InValue < 0.0f ? 0.0f : (InValue > 1.0f ? 1.0f : InValue);
+    }
+
+    FBezierCurve MakeBezierCurve(uint8_t InX1, uint8_t InY1, uint8_t InX2, uint8_t InY2)
+    {
+        /** Bytes above 127 are not written by MMD, they are clamped so x(t) stays monotonic */
+        const float TfX1 = Clamp01(InX1 / 127.0f);
+        const float TfY1 = Clamp01(InY1 / 127.0f);
+        const float TfX2 = Clamp01(InX2 / 127.0f);
+        const float TfY2 = Clamp01(InY2 / 127.0f);
+
+        FBezierCurve TsCurve;
+        TsCurve.Cx = 3.0f * TfX1;
+        TsCurve.Bx = 3.0f * TfX2 - 6.0f * TfX1;
+        TsCurve.Ax = 1.0f + 3.0f * TfX1 - 3.0f * TfX2;
+        TsCurve.Cy = 3.0f * TfY1;
+        TsCurve.By = 3.0f * TfY2 - 6.0f * TfY1;
+        TsCurve.Ay = 1.0f + 3.0f * TfY1 - 3.0f * TfY2;
+        TsCurve.bLinear = InX1 == InY1 && InX2 == InY2;
+        return TsCurve;
+    }
+
+    FBezierCurve MakeCameraCurve(const uint8_t* InInterpolation, ECameraCurve InChannel)
+    {
+        const uint8_t* TpBytes = InInterpolation + (int32_t)InChannel * 4;
+        return MakeBezierCurve(TpBytes[0], TpBytes[2], TpBytes[1], TpBytes[3]);
+    }
+
+    FBezierCurve MakeBoneCurve(const uint8_t* InInterpolation, int32_t InChannel)
+    {
+        return MakeBezierCurve(InInterpolation[InChannel], InInterpolation[4 + InChannel], InInterpolation[8 + InChannel], InInterpolation[12 + InChannel]);
+    }
+
+    /** Solve x(t) = InX from InT inside [InLow, InHigh], which must bracket the root */
+    static float SolveT(const FBezierCurve& InCurve, float InX, float InT, float InLow, float InHigh)
+    {
+        float TfT = InT;
+        for (int32_t Step = 0; Step < MaxNewtonSteps; ++Step)
+        {
+            const float TfError = InCurve.SampleX(TfT) - InX;
+            if (std::fabs(TfError) < BezierSolveTolerance)
+            {
+                return TfT;
+            }
+
+            (TfError > 0.0f ? InHigh : InLow) = TfT;
+
+            const float TfDeriv = InCurve.SampleDerivX(TfT);
+            const float TfNext = TfDeriv > 1.0e-6f ? TfT - TfError / TfDeriv : -1.0f;
+            TfT = TfNext > InLow && TfNext < InHigh ? TfNext : 0.5f * (InLow + InHigh);
+        }
+
+        /** Newton did not settle, bracket is still valid for bisection */
+        for (int32_t Step = 0; Step < MaxBisectionSteps; ++Step)
+        {
+            const float TfError = InCurve.SampleX(TfT) - InX;
+            if (std::fabs(TfError) < BezierSolveTolerance)
+            {
+                break;
+            }
+
+            (TfError > 0.0f ? InHigh : InLow) = TfT;
+            TfT = 0.5f * (InLow + InHigh);
+        }
+        return TfT;
+    }
+
+    float EvaluateBezier(const FBezierCurve& InCurve, float InX)
+    {
+        const float TfX = Clamp01(InX);
+        if (InCurve.bLinear)
+        {
+            return TfX;
+        }
+
+        return InCurve.SampleY(SolveT(InCurve, TfX, TfX, 0.0f, 1.0f));
+    }
+
+    double EvaluateBezierReference(const FBezierCurve& InCurve, double InX)
+    {
+        const double TfX = InX < 0.0 ? 0.0 : (InX > 1.0 ? 1.0 : InX);
+        double TfLow = 0.0;
+        double TfHigh = 1.0;
+        for (int32_t Step = 0; Step < 64; ++Step)
+        {
+            const double TfT = 0.5 * (TfLow + TfHigh);
+            const double TfSampleX = ((InCurve.Ax * TfT + InCurve.Bx) * TfT + InCurve.Cx) * TfT;
+            (TfSampleX > TfX ? TfHigh : TfLow) = TfT;
+        }
+
+        const double TfT = 0.5 * (TfLow + TfHigh);
+        return ((InCurve.Ay * TfT + InCurve.By) * TfT + InCurve.Cy) * TfT;
+    }
+
+    void FBezierTable::Build(const FBezierCurve& InCurve)
+    {
+        Curve = InCurve;
+        for (int32_t Idx = 0; Idx <= SampleNum; ++Idx)
+        {
+            const float TfX = (float)Idx / SampleNum;
+            T[Idx] = InCurve.bLinear ? TfX : SolveT(InCurve, TfX, TfX, 0.0f, 1.0f);
+        }
+    }
+
+    float FBezierTable::Evaluate(float InX) const
+    {
+        const float TfX = Clamp01(InX);
+        if (Curve.bLinear)
+        {
+            return TfX;
+        }
+
+        /** x(t) is monotonic, so the root stays between the two table entries around InX and the solve starts close to it */
+        const float TfPos = TfX * SampleNum;
+        const int32_t TiIndex = TfPos >= SampleNum ? SampleNum - 1 : (int32_t)TfPos;
+        const float TfLow = T[TiIndex];
+        const float TfHigh = T[TiIndex + 1];
+        const float TfGuess = TfLow + (TfHigh - TfLow) * (TfPos - TiIndex);
+
+        const float TfT = SolveT(Curve, TfX, TfGuess, TfLow, TfHigh);
+        return Curve.SampleY(TfT);
+    }
+}
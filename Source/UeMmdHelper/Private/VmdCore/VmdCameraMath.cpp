@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdCameraMath.h"
+
+#include <cmath>
+
+
+namespace VmdCore
+{
+    static constexpr double Pi = 3.1415926535897932384626433832795;
+
+    FQuat QuatFromRotator(double InPitch, double InYaw, double InRoll)
+    {
+        /** Remove winding first, so the sign of result matches the engine */
+        const double TfHalfRad = Pi / 360.0;
+        const double TfPitch = std::fmod(InPitch, 360.0) * TfHalfRad;
+        const double TfYaw = std::fmod(InYaw, 360.0) * TfHalfRad;
+        const double TfRoll = std::fmod(InRoll, 360.0) * TfHalfRad;
+
+        const double SP = std::sin(TfPitch), CP = std::cos(TfPitch);
+        const double SY = std::sin(TfYaw), CY = std::cos(TfYaw);
+        const double SR = std::sin(TfRoll), CR = std::cos(TfRoll);
+
+        FQuat TsQuat;
+        TsQuat.X = CR * SP * SY - SR * CP * CY;
+        TsQuat.Y = -CR * SP * CY - SR * CP * SY;
+        TsQuat.Z = CR * CP * SY - SR * SP * CY;
+        TsQuat.W = CR * CP * CY + SR * SP * SY;
+        return TsQuat;
+    }
+
+    FQuat Multiply(const FQuat& A, const FQuat& B)
+    {
+        FQuat TsQuat;
+        TsQuat.X = A.W * B.X + A.X * B.W + A.Y * B.Z - A.Z * B.Y;
+        TsQuat.Y = A.W * B.Y - A.X * B.Z + A.Y * B.W + A.Z * B.X;
+        TsQuat.Z = A.W * B.Z + A.X * B.Y - A.Y * B.X + A.Z * B.W;
+        TsQuat.W = A.W * B.W - A.X * B.X - A.Y * B.Y - A.Z * B.Z;
+        return TsQuat;
+    }
+
+    FVec3 RotateVector(const FQuat& InQuat, const FVec3& InVector)
+    {
+        /** V + 2W(Q x V) + 2Q x (Q x V) */
+        const FVec3 TsT = {
+            2.0 * (InQuat.Y * InVector.Z - InQuat.Z * InVector.Y),
+            2.0 * (InQuat.Z * InVector.X - InQuat.X * InVector.Z),
+            2.0 * (InQuat.X * InVector.Y - InQuat.Y * InVector.X),
+        };
+
+        return {
+            InVector.X + InQuat.W * TsT.X + (InQuat.Y * TsT.Z - InQuat.Z * TsT.Y),
+            InVector.Y + InQuat.W * TsT.Y + (InQuat.Z * TsT.X - InQuat.X * TsT.Z),
+            InVector.Z + InQuat.W * TsT.Z + (InQuat.X * TsT.Y - InQuat.Y * TsT.X),
+        };
+    }
+
+    FVec3 ConvertCameraRotation(float InRotateX, float InRotateY, float InRotateZ)
+    {
+        /** Computed in float like FMath::RadiansToDegrees, so converted data does not change */
+        const float TfRadToDeg = 180.0f / 3.1415926535897932f;
+        return { -(InRotateX * TfRadToDeg), InRotateY * TfRadToDeg, InRotateZ * TfRadToDeg };
+    }
+
+    FRigidTransform ConvertCameraTransform(const FRigidTransform& InBase, const FVec3& InOffset, const FVec3& InRotator, double InDistance)
+    {
+        /** Add relative transform on basic */
+        const FVec3 TsScaled = { InOffset.X * InBase.Scale.X, InOffset.Y * InBase.Scale.Y, InOffset.Z * InBase.Scale.Z };
+        const FVec3 TsRotated = RotateVector(InBase.Rotation, TsScaled);
+        const FVec3 TsLocation = {
+            TsRotated.X + InBase.Translation.X,
+            TsRotated.Y + InBase.Translation.Y,
+            TsRotated.Z + InBase.Translation.Z,
+        };
+
+        FRigidTransform TsResult;
+        TsResult.Rotation = Multiply(InBase.Rotation, QuatFromRotator(InRotator.X, InRotator.Y, InRotator.Z));
+
+        /** Move transform on direction */
+        const FVec3 TsDirection = RotateVector(TsResult.Rotation, { 1.0, 0.0, 0.0 });
+        TsResult.Translation = {
+            TsLocation.X + TsDirection.X * InDistance,
+            TsLocation.Y + TsDirection.Y * InDistance,
+            TsLocation.Z + TsDirection.Z * InDistance,
+        };
+        return TsResult;
+    }
+}
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdLayout.h"
+
+#include <cstddef>
+#include <cstring>
+
+
+namespace VmdCore
+{
+    static void SetError(FVmdLayout& OutLayout, EVmdValidationError InError, int32_t InSection)
+    {
+        OutLayout.Error = InError;
+        OutLayout.ErrorSection = (EVmdSection)InSection;
+    }
+
+    void ValidateLayout(int64 InFileSize, FReadAtFunc InReadAt, void* InContext, FVmdLayout& OutLayout)
+    {
+        OutLayout = FVmdLayout();
+        OutLayout.FileSize = InFileSize;
+
+        if (InFileSize < (int64)sizeof(FVmdRawHeader))
+        {
+            OutLayout.Error = EVmdValidationError::TooSmall;
+            return;
+        }
+
+        /** Compare the fixed field including terminator, the rest of the field is not guaranteed to be zero */
+        char TsMagic[sizeof(VmdMagicHeader)];
+        if (!InReadAt(InContext, 0, TsMagic, sizeof(TsMagic)))
+        {
+            OutLayout.Error = EVmdValidationError::ReadFailed;
+            return;
+        }
+
+        if (std::memcmp(TsMagic, VmdMagicHeader, sizeof(VmdMagicHeader)) != 0)
+        {
+            OutLayout.Error = EVmdValidationError::BadMagic;
+            return;
+        }
+
+        int64 TiOffset = sizeof(FVmdRawHeader);
+        for (int32_t TiSection = 0; TiSection < (int32_t)EVmdSection::Num; ++TiSection)
+        {
+            int32_t TiCount = 0;
+            OutLayout.SectionOffsets[TiSection] = TiOffset + sizeof(TiCount);
+
+            if (TiOffset + (int64)sizeof(TiCount) > InFileSize)
+            {
+                /** Older files simply end before optional sections */
+                if (TiSection >= VmdRequiredSectionNum)
+                {
+                    for (; TiSection < (int32_t)EVmdSection::Num; ++TiSection)
+                    {
+                        OutLayout.SectionOffsets[TiSection] = TiOffset;
+                    }
+                    break;
+                }
+
+                SetError(OutLayout, EVmdValidationError::MissingCount, TiSection);
+                return;
+            }
+
+            if (!InReadAt(InContext, TiOffset, &TiCount, sizeof(TiCount)))
+            {
+                SetError(OutLayout, EVmdValidationError::ReadFailed, TiSection);
+                return;
+            }
+
+            OutLayout.SectionCounts[TiSection] = TiCount;
+            TiOffset += sizeof(TiCount);
+
+            if (TiCount < 0)
+            {
+                SetError(OutLayout, EVmdValidationError::NegativeCount, TiSection);
+                return;
+            }
+
+            /** Variable length records are at least their header, reject hostile counts before walking them */
+            const int32_t TiRecordSize = GetVmdRecordSize((EVmdSection)TiSection);
+            const int64 TiMinBytes = (int64)TiCount * (TiRecordSize > 0 ? TiRecordSize : (int64)sizeof(FVmdRawIkRecord));
+            if (TiMinBytes > InFileSize - TiOffset)
+            {
+                SetError(OutLayout, EVmdValidationError::SectionOverflow, TiSection);
+                return;
+            }
+
+            int64 TiBytes = TiMinBytes;
+            if (TiRecordSize == 0)
+            {
+                TiBytes = 0;
+                for (int32_t Idx = 0; Idx < TiCount; ++Idx)
+                {
+                    uint32_t TiIkCount = 0;
+                    const int64 TiRecordOffset = TiOffset + TiBytes;
+                    if (TiRecordOffset + (int64)sizeof(FVmdRawIkRecord) > InFileSize
+                        || !InReadAt(InContext, TiRecordOffset + offsetof(FVmdRawIkRecord, IkCount), &TiIkCount, sizeof(TiIkCount)))
+                    {
+                        SetError(OutLayout, EVmdValidationError::SectionOverflow, TiSection);
+                        return;
+                    }
+
+                    TiBytes += GetVmdIkRecordSize(TiIkCount);
+                    if (TiBytes > InFileSize - TiOffset)
+                    {
+                        SetError(OutLayout, EVmdValidationError::SectionOverflow, TiSection);
+                        return;
+                    }
+                }
+            }
+
+            OutLayout.SectionBytes[TiSection] = TiBytes;
+            TiOffset += TiBytes;
+        }
+    }
+
+    void ValidateMemory(const uint8_t* InData, int64 InSize, FVmdLayout& OutLayout)
+    {
+        ValidateLayout(InSize, [](void* InContext, int64 InOffset, void* OutData, int64 InReadSize)
+            {
+                std::memcpy(OutData, static_cast<const uint8_t*>(InContext) + InOffset, (size_t)InReadSize);
+                return true;
+            }, const_cast<uint8_t*>(InData), OutLayout);
+    }
+
+    const char* GetErrorName(EVmdValidationError InError)
+    {
+        switch (InError)
+        {
+        case EVmdValidationError::None:
+            return "None";
+        case EVmdValidationError::ReadFailed:
+            return "ReadFailed";
+        case EVmdValidationError::TooSmall:
+            return "TooSmall";
+        case EVmdValidationError::BadMagic:
+            return "BadMagic";
+        case EVmdValidationError::MissingCount:
+            return "MissingCount";
+        case EVmdValidationError::NegativeCount:
+            return "NegativeCount";
+        case EVmdValidationError::SectionOverflow:
+            return "SectionOverflow";
+        }
+        return "Unknown";
+    }
+}
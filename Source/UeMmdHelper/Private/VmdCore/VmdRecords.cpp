@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdRecords.h"
+
+
+namespace VmdCore
+{
+    bool ParseRecords(const uint8_t* InData, int64 InSize, FRecordView& OutView)
+    {
+        OutView = FRecordView();
+        ValidateMemory(InData, InSize, OutView.Layout);
+        if (!OutView.Layout.IsValid())
+        {
+            return false;
+        }
+
+        OutView.Data = InData;
+        OutView.Header = reinterpret_cast<const FVmdRawHeader*>(InData);
+        return true;
+    }
+}
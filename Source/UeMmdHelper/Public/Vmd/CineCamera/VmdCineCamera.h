@@ -60,4 +60,19 @@ protected:
     UPROPERTY(EditAnywhere, Category="Sequencer")
     float ViewAngelBias = 1.666f;
 
+    /**
+     * Key every frame with MMD bezier easing of the motion data, instead of keying only vmd keys with auto cubic tangents
+     * Cuts, keys one frame apart, stay sharp either way
+     */
+    UPROPERTY(EditAnywhere, Category="Sequencer")
+    bool bBakeInterpolation = true;
+
+    /** Skip syncing when camera frames, config and level sequence are unchanged since the last sync */
+    UPROPERTY(EditAnywhere, Category="Sequencer")
+    bool bSkipUnchangedSync = true;
+
+    /** Key of the last sync, built from camera section hash, config and level sequence */
+    UPROPERTY()
+    uint64 SyncedCameraKey = 0;
+
 };
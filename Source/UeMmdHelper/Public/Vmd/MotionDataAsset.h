@@ -6,6 +6,9 @@
 #include "Engine/DataAsset.h"
 #include "MotionDataAsset.generated.h"
 
+struct FVmdMotionImportResult;
+struct FRichCurve;
+
 
 USTRUCT(BlueprintType)
 struct FVmdCameraFrameData
@@ -30,6 +33,77 @@ public:
 
     UPROPERTY(EditAnywhere)
     uint8 Perspective;
+
+    /**
+     * Easing of the segment ending at this frame, see VmdCore::MakeCameraCurve
+     * 4 bytes x1 x2 y1 y2 in [0, 127] for X, Y, Z, rotation, distance and view angle, all zero eases linearly
+     */
+    UPROPERTY(EditAnywhere)
+    uint8 Interpolation[24];
+};
+
+USTRUCT(BlueprintType)
+struct FVmdLightFrameData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere)
+    uint32	Frame;
+
+    UPROPERTY(EditAnywhere)
+    FLinearColor Color;
+
+    /** Light direction in MMD space */
+    UPROPERTY(EditAnywhere)
+    FVector	Position;
+};
+
+USTRUCT(BlueprintType)
+struct FVmdSelfShadowFrameData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere)
+    uint32	Frame;
+
+    /** 0: off, 1: mode1, 2: mode2 */
+    UPROPERTY(EditAnywhere)
+    uint8 Mode;
+
+    UPROPERTY(EditAnywhere)
+    float Distance;
+};
+
+USTRUCT(BlueprintType)
+struct FVmdIkStateData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere)
+    FString Name;
+
+    UPROPERTY(EditAnywhere)
+    bool bEnable = true;
+};
+
+USTRUCT(BlueprintType)
+struct FVmdIkFrameData
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere)
+    uint32	Frame;
+
+    /** Model visibility */
+    UPROPERTY(EditAnywhere)
+    bool bShow = true;
+
+    UPROPERTY(EditAnywhere)
+    TArray<FVmdIkStateData> IkStates;
 };
 
 USTRUCT(BlueprintType)
@@ -53,6 +127,75 @@ struct FVmdMorphTrackData
 public:
     UPROPERTY(EditAnywhere)
     TArray<FVmdMorphFrameData> Frames;
+
+public:
+    /**
+     * Drop keys that linear interpolation between the kept keys reproduces within tolerance
+     * First and last keys, and keys sharing a frame, are always kept
+     *
+     * @param InTolerance Largest allowed difference of factor at a dropped key
+     * @return Number of keys dropped
+     */
+    int32 ReduceKeys(float InTolerance);
+};
+
+/** Morph key reduction result of the last import */
+USTRUCT(BlueprintType)
+struct FVmdKeyReductionStats
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(VisibleAnywhere)
+    int32 KeysBefore = 0;
+
+    UPROPERTY(VisibleAnywhere)
+    int32 KeysAfter = 0;
+
+    /** Tracks that lost at least one key */
+    UPROPERTY(VisibleAnywhere)
+    int32 ReducedTracks = 0;
+};
+
+/** How a track present in several merged source files is combined */
+UENUM(BlueprintType)
+enum class EVmdMergePolicy : uint8
+{
+    /** Track of the first source in list that has it */
+    KeepFirst,
+
+    /** Track of the last source in list that has it */
+    KeepLast,
+
+    /** Keys of all sources interleaved by frame, the later source wins on a shared frame */
+    MergeKeys,
+};
+
+/**
+ * Content hashes of imported sections and morph tracks
+ * Re-import keeps data whose hash is unchanged, pushes skip targets already built from the same hash
+ */
+USTRUCT(BlueprintType)
+struct FVmdContentHashes
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(VisibleAnywhere)
+    uint64 Camera = 0;
+
+    UPROPERTY(VisibleAnywhere)
+    uint64 Light = 0;
+
+    UPROPERTY(VisibleAnywhere)
+    uint64 SelfShadow = 0;
+
+    UPROPERTY(VisibleAnywhere)
+    uint64 Ik = 0;
+
+    /** Hash of each source track combined with the reduction settings the stored track is built with */
+    UPROPERTY(VisibleAnywhere)
+    TMap<FString, uint64> MorphTracks;
 };
 
 USTRUCT(BlueprintType)
@@ -79,14 +222,46 @@ class UEMMDHELPER_API UMotionDataAsset : public UDataAsset
     GENERATED_BODY()
 
 public:
+    /** Import MotionPath and ExtraMotionPaths on a background task, each source is merged as soon as it is imported, result is applied on game thread when done */
     UFUNCTION(CallInEditor, Category = "Default")
     void LoadFromVmdFile();
+
+    bool IsImportRunning() const { return bImportRunning; }
      
     UFUNCTION(CallInEditor, Category = "MorphAnim")
     void PushMorphToAnimation();
 
+    /** Replace motion data with converted result, result is moved from */
+    void ApplyImportResult(FVmdMotionImportResult&& InResult);
+
+    /**
+     * Add linear keys of a morph track to curve, frames after InMaxTime are ignored
+     *
+     * @param InFrameRate Frames per second of motion data
+     * @param InCurveName Only used in log
+     */
+    static void BuildMorphCurve(const FVmdMorphTrackData& InTrack, float InFrameRate, float InMaxTime, bool bInNegative, const FName& InCurveName, FRichCurve& OutCurve);
+
+    /** Morph tracks, compact storage is decoded on first access after load */
+    const TMap<FString, FVmdMorphTrackData>& GetMorphTracks();
+
+    /** Camera frames, compact storage is decoded on first access after load */
+    const TArray<FVmdCameraFrameData>& GetCameraFrames();
+
+    /** Decode compact storage loaded with the asset into MorphTracks and CameraFrames, if it is not yet */
+    void DecodeCompactTracks();
+
+    void SetUseCompactStorage(bool bInUse) { bUseCompactStorage = bInUse; }
+
+    const FVmdContentHashes& GetContentHashes() const { return ContentHashes; }
+
+    const FString& GetMotionPath() const { return MotionPath.FilePath; }
+    void SetMotionPath(const FString& InFilePath) { MotionPath.FilePath = InFilePath; }
+
 protected:
     virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+    virtual void Serialize(FArchive& Ar) override;
+    virtual void PostLoad() override;
 
 public:
     float GetMorphAnimConvFrameRate() const {return MorphAnimConvFrameRate; }
@@ -95,9 +270,43 @@ protected:
     UPROPERTY(EditAnywhere, Category="Default")
     FFilePath MotionPath;
 
+    /** More vmd files merged after MotionPath, e.g. facial motion and camera shipped apart from body motion */
+    UPROPERTY(EditAnywhere, Category="Default|Merge")
+    TArray<FFilePath> ExtraMotionPaths;
+
+    /** Combining of tracks present in more than one source, an empty track never counts as present */
+    UPROPERTY(EditAnywhere, Category="Default|Merge")
+    EVmdMergePolicy MergePolicy = EVmdMergePolicy::KeepLast;
+
     UPROPERTY(VisibleAnywhere, Category="Default")
     FString TargetModelName;
 
+    /** Reuse converted data in Saved/VmdCache when the vmd file content is unchanged */
+    UPROPERTY(EditAnywhere, Category="Default")
+    bool bUseImportCache = true;
+
+    /** Drop morph keys that linear interpolation reproduces when loading from vmd file, cached data is kept unreduced */
+    UPROPERTY(EditAnywhere, Category="Default|Reduction")
+    bool bReduceMorphKeys = false;
+
+    /** Largest allowed difference of morph factor at a dropped key */
+    UPROPERTY(EditAnywhere, Category="Default|Reduction", meta=(EditCondition=bReduceMorphKeys, ClampMin=0))
+    float MorphReductionTolerance = 0.001f;
+
+    UPROPERTY(VisibleAnywhere, Category="Default|Reduction")
+    FVmdKeyReductionStats MorphReductionStats;
+
+    /** Hashes of data from the last import, unchanged sections and tracks are kept on re-import */
+    UPROPERTY(VisibleAnywhere, Category="Default|Hash")
+    FVmdContentHashes ContentHashes;
+
+    /**
+     * Save morph and camera tracks as one compact blob instead of tagged properties
+     * Frames are varint deltas, morph factors 16 bit quantized, camera channels float
+     */
+    UPROPERTY(EditAnywhere, Category="Default|Storage")
+    bool bUseCompactStorage = false;
+
     /** Frame rate used in morph target animation pushing */
     UPROPERTY(EditAnywhere, Category="MorphAnim")
     float MorphAnimConvFrameRate = 30.0f;
@@ -106,6 +315,14 @@ protected:
     UPROPERTY(EditAnywhere, Category="MorphAnim")
     TObjectPtr<class UAnimSequence> TargetAnim;
 
+    /** Skip curves whose track, mapping and target are unchanged since the last push */
+    UPROPERTY(EditAnywhere, Category="MorphAnim")
+    bool bSkipUnchangedMorphPush = true;
+
+    /** Key of every curve written by the last pushes, built from track hash, mapping and target */
+    UPROPERTY()
+    TMap<FName, uint64> PushedMorphKeys;
+
     /** Mapping to target mesh morph name before setting values */
     UPROPERTY(EditAnywhere, Category="MorphAnim|Mapping")
     bool bUseMorphMapping = false;
@@ -138,5 +355,25 @@ public:
     /** Morph target track data */
     UPROPERTY(VisibleAnywhere)
     TMap<FString, FVmdMorphTrackData> MorphTracks;
-    
+
+    /** Light frame data */
+    UPROPERTY(VisibleAnywhere)
+    TArray<FVmdLightFrameData> LightFrames;
+
+    /** Self shadow frame data */
+    UPROPERTY(VisibleAnywhere)
+    TArray<FVmdSelfShadowFrameData> SelfShadowFrames;
+
+    /** Model visibility and ik switch frame data */
+    UPROPERTY(VisibleAnywhere)
+    TArray<FVmdIkFrameData> IkFrames;
+
+private:
+    /** Compact storage loaded with the asset, not yet decoded into MorphTracks and CameraFrames */
+    TArray<uint8> PendingCompactBlob;
+    bool bCompactPending = false;
+
+    /** A background import started by LoadFromVmdFile has not yet been applied */
+    bool bImportRunning = false;
+
 };
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VmdCore/VmdBezier.h"
+
+
+/**
+ * Interpolation curves evaluated together at one progress, e.g. six channels of a camera segment, or four channels of every bone in a tick
+ * Curves sit in lanes of vector registers, and up to 4 registers (16 curves) are solved in one loop so their dependency chains overlap
+ * Registers are SSE or NEON by platform, or plain floats where vector intrinsics are disabled
+ *
+ * Usage:
+ *  FVmdBezierBatch TsBatch;
+ *  TsBatch.AddCameraCurves(Frame.Interpolation);
+ *  TsBatch.Evaluate(TfX, TsEased);
+ */
+class UEMMDHELPER_API FVmdBezierBatch
+{
+public:
+    static constexpr int32 LaneNum = 4;
+
+    /** Coefficients of LaneNum curves in structure of arrays, unused lanes hold y = x */
+    struct alignas(16) FLaneGroup
+    {
+        float Ax[LaneNum];
+        float Bx[LaneNum];
+        float Cx[LaneNum];
+
+        /** Derivative of x(t) is ((DAx * t + DBx) * t + Cx), DAx = 3 Ax and DBx = 2 Bx */
+        float DAx[LaneNum];
+        float DBx[LaneNum];
+
+        float Ay[LaneNum];
+        float By[LaneNum];
+        float Cy[LaneNum];
+    };
+
+public:
+    void Reset(int32 InExpectedNum = 0);
+
+    /** @return Index of the curve in evaluated values */
+    int32 Add(const VmdCore::FBezierCurve& InCurve);
+
+    /** All channels of a camera key, in ECameraCurve order */
+    void AddCameraCurves(const uint8* InInterpolation);
+
+    /** X, Y, Z and rotation channels of a bone key, from the first 16 interpolation bytes */
+    void AddBoneCurves(const uint8* InInterpolation);
+
+    int32 Num() const { return CurveNum; }
+
+    /**
+     * Eased progress of every curve at InX, in order of adding
+     * Each lane runs the bracketed Newton solve of VmdCore::EvaluateBezier, the loop ends when every lane has settled
+     *
+     * @param OutValues At least Num() values
+     */
+    void Evaluate(float InX, TArrayView<float> OutValues) const;
+
+private:
+    TArray<FLaneGroup> Groups;
+    int32 CurveNum = 0;
+};
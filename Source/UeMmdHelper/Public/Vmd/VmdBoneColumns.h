@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVmdRawBoneRecord;
+
+
+/**
+ * Bone frames stored as one contiguous array per channel
+ * Bake and evaluation stages only read one channel at a time, so they stream through these arrays instead of whole frames
+ */
+struct UEMMDHELPER_API FVmdBoneFrameColumns
+{
+public:
+    /** Bytes of interpolation parameters kept for each frame, the rest in file are shifted copies */
+    static constexpr int32 InterpolationStride = 16;
+
+    /** Index into Names for each frame */
+    TArray<int32> NameIds;
+    TArray<uint32> Frames;
+    TArray<FVector3f> Positions;
+    TArray<FQuat4f> Rotations;
+
+    /** InterpolationStride bytes for each frame, same layout as FVmdBoneFrame::Bezier */
+    TArray<uint8> Interpolations;
+
+    /** Decoded unique bone names */
+    TArray<FString> Names;
+
+public:
+    int32 Num() const { return Frames.Num(); }
+
+    TConstArrayView<uint8> GetInterpolation(int32 InIndex) const
+    {
+        return TConstArrayView<uint8>(Interpolations.GetData() + InIndex * InterpolationStride, InterpolationStride);
+    }
+
+    void Reset();
+
+    /**
+     * Bulk unpack raw file records, replaces current content
+     *
+     * @param bInParallel Unpack chunks of records concurrently on task graph
+     */
+    void UnpackFrom(TConstArrayView<FVmdRawBoneRecord> InRecords, bool bInParallel = true);
+};
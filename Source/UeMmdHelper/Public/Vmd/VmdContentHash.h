@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Hash/xxhash.h"
+
+
+/**
+ * Content hash of converted motion data and of the settings derived data is built with
+ * Values are fed field by field, so struct padding never reaches the hash
+ *
+ * Usage:
+ *  const uint64 TiKey = FVmdContentHash::Combine(TiTrackHash, bReduce, Tolerance);
+ */
+namespace FVmdContentHash
+{
+    /** Hash stored before any import, never equal to a computed one in practice */
+    constexpr uint64 None = 0;
+
+    template<typename ValueType>
+    void Append(FXxHash64Builder& InOutBuilder, const ValueType& InValue)
+    {
+        static_assert(TIsArithmetic<ValueType>::Value, "Append fields one by one, structs may have padding");
+        InOutBuilder.Update(&InValue, sizeof(ValueType));
+    }
+
+    inline void Append(FXxHash64Builder& InOutBuilder, FStringView InString)
+    {
+        const int32 TiLen = InString.Len();
+        InOutBuilder.Update(&TiLen, sizeof(TiLen));
+        InOutBuilder.Update(InString.GetData(), TiLen * sizeof(TCHAR));
+    }
+
+    inline void Append(FXxHash64Builder& InOutBuilder, const FString& InString)
+    {
+        Append(InOutBuilder, FStringView(InString));
+    }
+
+    template<typename... ValueTypes>
+    uint64 Combine(const ValueTypes&... InValues)
+    {
+        FXxHash64Builder TsBuilder;
+        (Append(TsBuilder, InValues), ...);
+        return TsBuilder.Finalize().Hash;
+    }
+}
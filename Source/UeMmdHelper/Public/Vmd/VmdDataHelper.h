@@ -3,9 +3,28 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Vmd/VmdRawRecords.h"
 
 
 struct FVmdData;
+class FVmdFileView;
+
+/** Result of encoding a name into a fixed width sjis field */
+struct FVmdNameEncodeResult
+{
+    /** Bytes of the field used by the name */
+    int32 Bytes = 0;
+
+    /** Chars without a sjis code, written as '?' */
+    int32 UnrepresentableNum = 0;
+
+    /** Name did not fit the field and was cut at a char boundary */
+    bool bTruncated = false;
+
+public:
+    bool IsLossless() const { return UnrepresentableNum == 0 && !bTruncated; }
+};
+
 namespace FVmdDataHelper
 {
     /** 
@@ -16,7 +35,39 @@ namespace FVmdDataHelper
      */
     void LoadVmdDataFromFile(const FString& InFilePath, FVmdData& OutData);
 
+    /** Names up to this many bytes are decoded without heap allocation, longest name field in vmd is 20 bytes */
+    constexpr int32 MaxInlineNameLen = 64;
+
+    /**
+     * Decode sjis name into caller storage, stops at terminator or after InMaxLen bytes
+     * Each byte decodes to at most one char, so InMaxLen chars of buffer is always enough
+     *
+     * @return Chars written, no terminator is written
+     */
+    int32 DecodeMmdName(const char* InName, int32 InMaxLen, TCHAR* OutBuffer, int32 InBufferLen);
+
+    /** Convert a terminated name */
     FString ConvertFromMmdName(const char* InName);
+
+    /** Convert a fixed width name field, the name is not terminated when it fills the whole field */
+    FString ConvertFromMmdName(const char* InName, int32 InMaxLen);
+
+    /** Same as ConvertFromMmdName, but to name table without a temporary string */
+    FName ConvertFromMmdNameToFName(const char* InName, int32 InMaxLen, EFindName InFindType = FNAME_Add);
+
+    /**
+     * Encode name into a fixed width sjis field, the rest of field is zero filled
+     * Like names read from vmd, a name that fills the whole field is not terminated
+     *
+     * @param InFieldSize Size of field, 15 for bone and morph names, 20 for model and ik names
+     */
+    FVmdNameEncodeResult ConvertToMmdName(FStringView InName, char* OutField, int32 InFieldSize);
+
+    template<int32 FieldSize>
+    FVmdNameEncodeResult ConvertToMmdName(FStringView InName, char (&OutField)[FieldSize])
+    {
+        return ConvertToMmdName(InName, OutField, FieldSize);
+    }
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -105,39 +156,130 @@ public:
 
 };
 
+struct FVmdLightFrame
+{
+    uint32	Frame;
+    float	Color[3];
+    float	Position[3];
+
+public:
+    friend FArchive& operator<<(FArchive& Ar, FVmdLightFrame& P)
+    {
+        Ar << P.Frame;
+        Ar.Serialize(P.Color, sizeof(P.Color));
+        Ar.Serialize(P.Position, sizeof(P.Position));
+        return Ar;
+    }
+};
+
+struct FVmdSelfShadowFrame
+{
+    uint32	Frame;
+    uint8	Mode;
+    float	Distance;
+
+public:
+    friend FArchive& operator<<(FArchive& Ar, FVmdSelfShadowFrame& P)
+    {
+        Ar << P.Frame;
+        Ar << P.Mode;
+        Ar << P.Distance;
+        return Ar;
+    }
+};
+
+struct FVmdIkInfo
+{
+    char	Name[20];
+    uint8	Enable;
+};
+
+struct FVmdIkFrame
+{
+    uint32	Frame;
+    uint8	Show;
+    TArray<FVmdIkInfo> IkInfos;
+
+public:
+    friend FArchive& operator<<(FArchive& Ar, FVmdIkFrame& P)
+    {
+        Ar << P.Frame;
+        Ar << P.Show;
+
+        uint32 IkCount = 0;
+        Ar << IkCount;
+        if (Ar.IsError() || (int64)IkCount * sizeof(FVmdRawIkInfo) > Ar.TotalSize() - Ar.Tell())
+        {
+            Ar.SetError();
+            return Ar;
+        }
+
+        P.IkInfos.SetNumZeroed(IkCount);
+        for (FVmdIkInfo& IterInfo : P.IkInfos)
+        {
+            Ar.Serialize(IterInfo.Name, sizeof(IterInfo.Name));
+            Ar << IterInfo.Enable;
+        }
+        return Ar;
+    }
+};
+
 struct FVmdBoneTracks
 {
     TArray<FVmdBoneFrame> BoneFrames;
     TArray<FVmdFaceFrame> FaceFrames;
     TArray<FVmdCameraFrame> CameraFrames;
+    TArray<FVmdLightFrame> LightFrames;
+    TArray<FVmdSelfShadowFrame> SelfShadowFrames;
+    TArray<FVmdIkFrame> IkFrames;
 
 public:
     friend FArchive& operator<<(FArchive& Ar, FVmdBoneTracks& P)
     {
-        int32 CountReadIn;
+        ReadSection(Ar, P.BoneFrames, sizeof(FVmdRawBoneRecord), false);
+        ReadSection(Ar, P.FaceFrames, sizeof(FVmdRawFaceRecord), false);
+        ReadSection(Ar, P.CameraFrames, sizeof(FVmdRawCameraRecord), false);
 
-        Ar << CountReadIn;
-        P.BoneFrames.SetNumZeroed(CountReadIn);
-        for (FVmdBoneFrame& IterFrame : P.BoneFrames)
+        /** Older files end before these */
+        ReadSection(Ar, P.LightFrames, sizeof(FVmdRawLightRecord), true);
+        ReadSection(Ar, P.SelfShadowFrames, sizeof(FVmdRawSelfShadowRecord), true);
+        ReadSection(Ar, P.IkFrames, sizeof(FVmdRawIkRecord), true);
+        return Ar;
+    }
+
+private:
+    /**
+     * Count is checked against the rest of archive before allocating
+     *
+     * @param InRecordSize Size of one record, or the minimum size of variable length records
+     * @param bOptional Leave frames empty instead of failing when archive ends before the count
+     */
+    template<typename FrameType>
+    static void ReadSection(FArchive& Ar, TArray<FrameType>& OutFrames, int64 InRecordSize, bool bOptional)
+    {
+        OutFrames.Reset();
+        if (Ar.IsError() || (bOptional && Ar.TotalSize() - Ar.Tell() < (int64)sizeof(int32)))
         {
-            Ar << IterFrame;
+            return;
         }
 
+        int32 CountReadIn = 0;
         Ar << CountReadIn;
-        P.FaceFrames.SetNumZeroed(CountReadIn);
-        for (FVmdFaceFrame& IterFrame : P.FaceFrames)
+
+        const int64 TiRemaining = Ar.TotalSize() - Ar.Tell();
+        if (Ar.IsError() || CountReadIn < 0 || (int64)CountReadIn * InRecordSize > TiRemaining)
         {
-            Ar << IterFrame;
+            UE_LOG(LogTemp, Warning, TEXT("FVmdBoneTracks::ReadSection: Bad count, count=%d remaining=%lld"), CountReadIn, TiRemaining);
+            Ar.SetError();
+            OutFrames.Reset();
+            return;
         }
 
-        Ar << CountReadIn;
-        P.CameraFrames.SetNumZeroed(CountReadIn);
-        for (FVmdCameraFrame& IterFrame : P.CameraFrames)
+        OutFrames.SetNumZeroed(CountReadIn);
+        for (FrameType& IterFrame : OutFrames)
         {
             Ar << IterFrame;
         }
-
-        return Ar;
     }
 };
 
@@ -149,13 +291,23 @@ struct FVmdData
 {
 public:
     void PrintOutData();
+
+    /**
+     * Copy records out of a mapped file, gives the same result as reading from FArchive
+     * Used by the bench commands and tests only, FVmdMotionImporter reads through FVmdStreamReader instead:
+     * it skips the bone section this decodes, converts each batch while later ones are read, and reports progress and cancel per batch
+     *
+     * @param bInParallel Decode sections and chunks of large sections concurrently on task graph
+     */
+    void ReadFromView(const FVmdFileView& InView, bool bInParallel = true);
+
     const FVmdBoneTracks& GetTrackData() const {return TrackData;}
     const FVmdHeader& GetVmdHeader() const {return VmdHeader;}
 
     friend FArchive& operator<<(FArchive& Ar, FVmdData& P)
     {
         Ar << P.VmdHeader;
-        if (strcmp(P.VmdHeader.MagicHeader, "Vocaloid Motion Data 0002"))
+        if (FMemory::Memcmp(P.VmdHeader.MagicHeader, VmdMagicHeader, sizeof(VmdMagicHeader)) != 0)
         {
             UE_LOG(LogTemp, Warning, TEXT("FVmdData::ReadFromFile: Header check failed"));
             Ar.SetError();
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Vmd/VmdRawRecords.h"
+#include "Vmd/VmdValidation.h"
+
+
+/**
+ * Read-only view of a vmd file
+ * The file is memory mapped when possible, records are exposed as spans over the mapped memory without copying
+ *
+ * @note: Spans are only valid while the view is alive
+ */
+class UEMMDHELPER_API FVmdFileView
+{
+public:
+    FVmdFileView();
+    ~FVmdFileView();
+
+    FVmdFileView(const FVmdFileView&) = delete;
+    FVmdFileView& operator=(const FVmdFileView&) = delete;
+
+    /**
+     * Map vmd file and locate all sections
+     *
+     * @param InFilePath Absolute path of vmd file
+     * @return False if file can not be read or is not a valid vmd file
+     */
+    bool Open(const FString& InFilePath);
+
+    /** Release mapped memory, all spans got before become invalid */
+    void Close();
+
+    bool IsValid() const { return Header != nullptr; }
+    bool IsMapped() const { return MappedRegion.IsValid(); }
+    int64 GetFileSize() const { return DataSize; }
+
+    /** Result of layout check done while opening */
+    const FVmdValidationResult& GetValidation() const { return Validation; }
+
+    const FVmdRawHeader& GetHeader() const { check(Header); return *Header; }
+    TConstArrayView<FVmdRawBoneRecord> GetBoneFrames() const { return BoneFrames; }
+    TConstArrayView<FVmdRawFaceRecord> GetFaceFrames() const { return FaceFrames; }
+    TConstArrayView<FVmdRawCameraRecord> GetCameraFrames() const { return CameraFrames; }
+    TConstArrayView<FVmdRawLightRecord> GetLightFrames() const { return LightFrames; }
+    TConstArrayView<FVmdRawSelfShadowRecord> GetSelfShadowFrames() const { return SelfShadowFrames; }
+
+    /** Ik records are variable length, walk them with the iterator */
+    int32 GetIkFrameNum() const { return IsValid() ? Validation.GetCount(EVmdSection::Ik) : 0; }
+    FVmdIkRecordIterator GetIkFrames() const { return FVmdIkRecordIterator(Data + Validation.GetOffset(EVmdSection::Ik), GetIkFrameNum()); }
+
+    void PrintOutData() const;
+
+private:
+    /** Locate header and sections inside Data */
+    bool ParseSections();
+
+private:
+    TUniquePtr<class IMappedFileHandle> MappedHandle;
+    TUniquePtr<class IMappedFileRegion> MappedRegion;
+
+    /** Used when the platform does not support file mapping */
+    TArray64<uint8> FallbackBuffer;
+
+    const uint8* Data = nullptr;
+    int64 DataSize = 0;
+
+    FVmdValidationResult Validation;
+
+    const FVmdRawHeader* Header = nullptr;
+    TConstArrayView<FVmdRawBoneRecord> BoneFrames;
+    TConstArrayView<FVmdRawFaceRecord> FaceFrames;
+    TConstArrayView<FVmdRawCameraRecord> CameraFrames;
+    TConstArrayView<FVmdRawLightRecord> LightFrames;
+    TConstArrayView<FVmdRawSelfShadowRecord> SelfShadowFrames;
+};
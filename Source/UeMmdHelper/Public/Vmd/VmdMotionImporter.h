@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Vmd/MotionDataAsset.h"
+
+
+/**
+ * Converted motion data of one vmd file, ready to be applied to UMotionDataAsset
+ * Holds no UObject, so it can be produced off game thread and cached
+ */
+struct UEMMDHELPER_API FVmdMotionImportResult
+{
+public:
+    FString TargetModelName;
+
+    TArray<FVmdCameraFrameData> CameraFrames;
+    TArray<FVmdLightFrameData> LightFrames;
+    TArray<FVmdSelfShadowFrameData> SelfShadowFrames;
+    TArray<FVmdIkFrameData> IkFrames;
+
+    /** Filtered and sorted morph tracks, MorphNames[i] is the name of MorphTracks[i] */
+    TArray<FString> MorphNames;
+    TArray<FVmdMorphTrackData> MorphTracks;
+
+    /** Content hash of each section, equal hashes mean equal frames */
+    uint64 CameraHash = 0;
+    uint64 LightHash = 0;
+    uint64 SelfShadowHash = 0;
+    uint64 IkHash = 0;
+
+    /** MorphHashes[i] is the content hash of MorphTracks[i] */
+    TArray<uint64> MorphHashes;
+
+public:
+    void Reset();
+
+    /** Fill section and track hashes from current frames, done by importer before returning a result */
+    void ComputeHashes();
+};
+
+namespace FVmdMotionImporter
+{
+    /** Called with progress in [0, 1], may be on a worker thread, return false to cancel the import */
+    using FProgressCallback = TFunctionRef<bool(float InProgress)>;
+
+    /**
+     * Read, convert, group and sort motion data of a vmd file
+     *
+     * @param InFilePath Absolute path of vmd file
+     * @param OutResult Result to fill
+     * @param bInUseCache Load from import cache when the file is unchanged, and write cache after import
+     * @return False if file can not be read or import is cancelled
+     */
+    bool ImportFromFile(const FString& InFilePath, FVmdMotionImportResult& OutResult, bool bInUseCache, FProgressCallback InProgress);
+
+    /** Import without cache or cached data */
+    bool ImportFromVmd(const FString& InFilePath, FVmdMotionImportResult& OutResult, FProgressCallback InProgress);
+}
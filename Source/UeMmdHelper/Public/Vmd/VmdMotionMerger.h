@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Vmd/MotionDataAsset.h"
+
+struct FVmdMotionImportResult;
+
+
+/**
+ * Merge import results of several vmd files into one, e.g. body, facial and camera motion of one distribution
+ * Every section and morph track of a result is already sorted by frame, so tracks are merged as sorted streams
+ */
+namespace FVmdMotionMerger
+{
+    /**
+     * Merge sources in list order, the first non empty model name is kept
+     * Tracks are released from sources as soon as they are merged, so peak memory stays near one copy of the data
+     *
+     * @param InOutSources Results to merge, left empty
+     * @param InPolicy Combining of tracks present in more than one source
+     */
+    UEMMDHELPER_API void Merge(TArrayView<FVmdMotionImportResult> InOutSources, EVmdMergePolicy InPolicy, FVmdMotionImportResult& OutResult);
+
+    /**
+     * Fold one more source into the results merged so far, folding sources one by one gives the same result as Merge
+     * Lets a caller merge each source right after it is imported, so only one source is held besides the merged result
+     * Empty tracks of a source are dropped, and hashes of InOutMerged are cleared, call ComputeHashes after the last source
+     *
+     * @param InOutMerged Result of the sources before InOutSource, empty for the first source
+     * @param InOutSource Result to fold in, left empty
+     * @return Number of morph tracks of the source already present in the merged result
+     */
+    UEMMDHELPER_API int32 MergeInto(FVmdMotionImportResult& InOutMerged, FVmdMotionImportResult& InOutSource, EVmdMergePolicy InPolicy);
+
+    /**
+     * K-way merge of frame streams sorted by frame, a frame shared by several streams keeps only the keys of the latest stream
+     * Repeated frames inside one stream are all kept, like a single source import keeps them
+     *
+     * @param InStreams Sorted frames of each source, in source order, emptied after merge
+     */
+    template<typename FrameType>
+    void MergeSortedFrames(TArrayView<TArray<FrameType>*> InStreams, TArray<FrameType>& OutFrames)
+    {
+        struct FCursor
+        {
+            uint32 Frame;
+            int32 Stream;
+            int32 Index;
+        };
+
+        /** Equal frames pop in stream order and a stream's repeats pop together, so a later stream's run replaces earlier runs */
+        auto CursorLess = [](const FCursor& A, const FCursor& B)
+            {
+                return A.Frame != B.Frame ? A.Frame < B.Frame : A.Stream < B.Stream;
+            };
+
+        int32 TiTotal = 0;
+        TArray<FCursor, TInlineAllocator<8>> TsHeap;
+        for (int32 StreamIdx = 0; StreamIdx < InStreams.Num(); ++StreamIdx)
+        {
+            const TArray<FrameType>& TrStream = *InStreams[StreamIdx];
+            TiTotal += TrStream.Num();
+            if (TrStream.Num() > 0)
+            {
+                TsHeap.HeapPush({ TrStream[0].Frame, StreamIdx, 0 }, CursorLess);
+            }
+        }
+
+        OutFrames.Reset(TiTotal);
+        int32 TiLastStream = INDEX_NONE;
+        int32 TiRunStart = 0;
+        FCursor TsCursor;
+        while (TsHeap.Num() > 0)
+        {
+            TsHeap.HeapPop(TsCursor, CursorLess, EAllowShrinking::No);
+            TArray<FrameType>& TrStream = *InStreams[TsCursor.Stream];
+
+            if (OutFrames.Num() == 0 || OutFrames.Last().Frame != TsCursor.Frame)
+            {
+                TiRunStart = OutFrames.Num();
+            }
+            else if (TiLastStream != TsCursor.Stream)
+            {
+                /** Drop every key earlier streams put on this frame */
+                OutFrames.SetNum(TiRunStart, EAllowShrinking::No);
+            }
+            OutFrames.Add(MoveTemp(TrStream[TsCursor.Index]));
+            TiLastStream = TsCursor.Stream;
+
+            if (++TsCursor.Index < TrStream.Num())
+            {
+                TsCursor.Frame = TrStream[TsCursor.Index].Frame;
+                TsHeap.HeapPush(TsCursor, CursorLess);
+            }
+        }
+
+        for (TArray<FrameType>* IterStream : InStreams)
+        {
+            IterStream->Empty();
+        }
+    }
+}
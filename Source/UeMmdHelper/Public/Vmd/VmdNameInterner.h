@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVmdRawBoneRecord;
+struct FVmdRawFaceRecord;
+
+/**
+ * Maps raw fixed width vmd name fields to dense ids
+ * Lookup hashes and compares the raw bytes, each distinct name is only decoded once
+ * Ids are given in order of first appearance
+ */
+class UEMMDHELPER_API FVmdNameInterner
+{
+public:
+    /** Widest name field in vmd, ik names */
+    static constexpr int32 MaxFieldSize = 20;
+
+    /**
+     * Get id of a name field, decode it if it is new
+     *
+     * @param InField Raw name bytes, not terminated when the name fills the field
+     * @param InFieldSize Width of the field, at most MaxFieldSize
+     */
+    int32 Intern(const char* InField, int32 InFieldSize);
+
+    /**
+     * Get ids of a strided column of name fields in one pass, such as the name at offset 0 of every record of a section
+     *
+     * @param InFields First name field
+     * @param InStride Bytes from one field to the next, the record size when fields are read in place
+     * @param InFieldSize Width of each field, at most MaxFieldSize
+     * @param OutIds Receives id of each field, its size is the number of fields
+     */
+    void InternColumn(const char* InFields, int64 InStride, int32 InFieldSize, TArrayView<int32> OutIds);
+
+    const FString& GetName(int32 InId) const { return Names[InId]; }
+    const TArray<FString>& GetNames() const { return Names; }
+    int32 Num() const { return Names.Num(); }
+
+    void Reset();
+
+private:
+    /** Field bytes up to terminator, zero padded so compare and hash are a few word operations */
+    struct FRawKey
+    {
+        uint64 Words[3] = {};
+
+        bool operator==(const FRawKey& Other) const
+        {
+            return Words[0] == Other.Words[0] && Words[1] == Other.Words[1] && Words[2] == Other.Words[2];
+        }
+
+        friend uint32 GetTypeHash(const FRawKey& InKey)
+        {
+            const uint64 TiHash = (InKey.Words[0] * 0x9E3779B97F4A7C15ull) ^ (InKey.Words[1] * 0xC2B2AE3D27D4EB4Full) ^ (InKey.Words[2] * 0x165667B19E3779F9ull);
+            return (uint32)(TiHash ^ (TiHash >> 32));
+        }
+    };
+    static_assert(sizeof(FRawKey) >= MaxFieldSize, "Raw key too small");
+
+private:
+    TMap<FRawKey, int32> RawIds;
+
+    /** Different raw bytes can decode to one name, keep ids unique by name */
+    TMap<FString, int32> NameIds;
+    TArray<FString> Names;
+
+    /** Consecutive records usually share a name */
+    FRawKey LastKey;
+    int32 LastId = INDEX_NONE;
+};
+
+/**
+ * Name column of a whole section, a dense id for each record and a table of unique decoded names
+ */
+struct UEMMDHELPER_API FVmdNameColumn
+{
+public:
+    /** Index into Names for each record */
+    TArray<int32> NameIds;
+
+    /** Decoded unique names, in order of first appearance */
+    TArray<FString> Names;
+
+public:
+    int32 Num() const { return NameIds.Num(); }
+    const FString& GetName(int32 InIndex) const { return Names[NameIds[InIndex]]; }
+
+    void Reset();
+
+    /** Decode the name column of a section, replaces current content */
+    void DecodeFrom(TConstArrayView<FVmdRawBoneRecord> InRecords);
+    void DecodeFrom(TConstArrayView<FVmdRawFaceRecord> InRecords);
+
+    /** Same as above for records of any layout, InStride bytes apart */
+    void DecodeFrom(const char* InFields, int64 InStride, int32 InFieldSize, int32 InNum);
+};
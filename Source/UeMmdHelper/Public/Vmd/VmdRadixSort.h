@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+
+
+/**
+ * Stable lsd radix sort of frame data on an unsigned integer key, 8 bits per pass
+ *
+ * Usage:
+ *  VmdRadixSort::SortByKey(Frames, [](const FVmdCameraFrameData& In) { return In.Frame; });
+ */
+namespace VmdRadixSort
+{
+    /** Inputs shorter than this are sorted on the calling thread */
+    constexpr int32 ParallelThreshold = 64 * 1024;
+
+    /** Items counted and scattered by one parallel task */
+    constexpr int32 ChunkSize = 16 * 1024;
+
+    constexpr int32 BucketNum = 256;
+
+    /**
+     * Check order of keys, and find digits shared by all keys in the same pass
+     *
+     * @param OutVaryingBits Bits that differ between some keys, a pass is only needed for digits with any of them
+     * @return True if keys are already in order
+     */
+    template<typename ItemType, typename KeyFuncType, typename KeyType>
+    bool ScanKeys(const TArray<ItemType>& InItems, KeyFuncType InKeyFunc, KeyType& OutVaryingBits)
+    {
+        OutVaryingBits = 0;
+        if (InItems.Num() == 0)
+        {
+            return true;
+        }
+
+        bool bSorted = true;
+        KeyType TiPrev = InKeyFunc(InItems[0]);
+        KeyType TiAnd = TiPrev;
+        KeyType TiOr = TiPrev;
+        for (int32 Idx = 1; Idx < InItems.Num(); ++Idx)
+        {
+            const KeyType TiKey = InKeyFunc(InItems[Idx]);
+            bSorted &= TiPrev <= TiKey;
+            TiAnd &= TiKey;
+            TiOr |= TiKey;
+            TiPrev = TiKey;
+        }
+
+        OutVaryingBits = TiAnd ^ TiOr;
+        return bSorted;
+    }
+
+    /**
+     * Sort items by key, items with equal keys keep their order
+     * Sorted input, which is what most exporters write, is detected in one pass and left untouched
+     *
+     * @param InKeyFunc Returns an unsigned integer key of an item
+     * @param bInParallel Count and scatter chunks of large inputs concurrently on task graph
+     * @return False if input was already sorted
+     */
+    template<typename ItemType, typename KeyFuncType>
+    bool SortByKey(TArray<ItemType>& InOutItems, KeyFuncType InKeyFunc, bool bInParallel = true)
+    {
+        using KeyType = decltype(InKeyFunc(DeclVal<const ItemType&>()));
+        static_assert(TIsIntegral<KeyType>::Value && KeyType(-1) > KeyType(0), "Key must be an unsigned integer");
+
+        KeyType TiVaryingBits = 0;
+        if (ScanKeys(InOutItems, InKeyFunc, TiVaryingBits))
+        {
+            return false;
+        }
+
+        const int32 TiNum = InOutItems.Num();
+        const int32 TiChunkNum = bInParallel && TiNum >= ParallelThreshold ? FMath::DivideAndRoundUp(TiNum, ChunkSize) : 1;
+        const int32 TiChunkSize = FMath::DivideAndRoundUp(TiNum, TiChunkNum);
+        const EParallelForFlags TeFlags = TiChunkNum > 1 ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+
+        /** Bucket counts of each chunk, turned into the first output slot of each bucket and chunk */
+        TArray<int32> TsOffsets;
+        TsOffsets.SetNumUninitialized(TiChunkNum * BucketNum);
+
+        TArray<ItemType> TsScratch;
+        TsScratch.SetNum(TiNum);
+
+        for (int32 TiShift = 0; TiShift < (int32)sizeof(KeyType) * 8; TiShift += 8)
+        {
+            if (((TiVaryingBits >> TiShift) & 0xFF) == 0)
+            {
+                continue;
+            }
+
+            ParallelFor(TiChunkNum, [&](int32 InChunkIndex)
+                {
+                    int32* TpCounts = TsOffsets.GetData() + InChunkIndex * BucketNum;
+                    FMemory::Memzero(TpCounts, BucketNum * sizeof(int32));
+
+                    const int32 TiEnd = FMath::Min(TiNum, (InChunkIndex + 1) * TiChunkSize);
+                    for (int32 Idx = InChunkIndex * TiChunkSize; Idx < TiEnd; ++Idx)
+                    {
+                        ++TpCounts[(InKeyFunc(InOutItems[Idx]) >> TiShift) & 0xFF];
+                    }
+                }, TeFlags);
+
+            /** Earlier chunks go first inside each bucket, which keeps the sort stable */
+            int32 TiOffset = 0;
+            for (int32 Bucket = 0; Bucket < BucketNum; ++Bucket)
+            {
+                for (int32 Chunk = 0; Chunk < TiChunkNum; ++Chunk)
+                {
+                    int32& TrSlot = TsOffsets[Chunk * BucketNum + Bucket];
+                    const int32 TiCount = TrSlot;
+                    TrSlot = TiOffset;
+                    TiOffset += TiCount;
+                }
+            }
+
+            ParallelFor(TiChunkNum, [&](int32 InChunkIndex)
+                {
+                    int32* TpSlots = TsOffsets.GetData() + InChunkIndex * BucketNum;
+
+                    const int32 TiEnd = FMath::Min(TiNum, (InChunkIndex + 1) * TiChunkSize);
+                    for (int32 Idx = InChunkIndex * TiChunkSize; Idx < TiEnd; ++Idx)
+                    {
+                        TsScratch[TpSlots[(InKeyFunc(InOutItems[Idx]) >> TiShift) & 0xFF]++] = MoveTemp(InOutItems[Idx]);
+                    }
+                }, TeFlags);
+
+            Swap(InOutItems, TsScratch);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VmdCore/VmdFormat.h"
+#include "VmdCore/VmdRecords.h"
+
+
+/**
+ * Walks variable length ik records in contiguous memory
+ * Memory must be validated before, records are not bounds checked here
+ */
+struct FVmdIkRecordIterator : public VmdCore::FIkRecordIterator
+{
+public:
+    using VmdCore::FIkRecordIterator::FIkRecordIterator;
+
+    FVmdIkRecordIterator(const VmdCore::FIkRecordIterator& InIterator)
+        : VmdCore::FIkRecordIterator(InIterator)
+    {
+    }
+
+    TConstArrayView<FVmdRawIkInfo> GetInfos() const
+    {
+        return TConstArrayView<FVmdRawIkInfo>(GetInfoData(), (int32)GetInfoNum());
+    }
+
+    FVmdIkRecordIterator& operator++()
+    {
+        VmdCore::FIkRecordIterator::operator++();
+        return *this;
+    }
+
+    static int64 GetRecordSize(uint32 InIkCount) { return GetVmdIkRecordSize(InIkCount); }
+};
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Vmd/VmdFileView.h"
+
+
+/**
+ * A batch of records handed out by FVmdStreamReader
+ * Records point into the reader's buffer, they are only valid until the next read
+ */
+struct FVmdRecordBatch
+{
+public:
+    EVmdSection Section = EVmdSection::Num;
+
+    /** Index of the first record in its section */
+    int32 FirstIndex = 0;
+
+    /** Total records of the section this batch belongs to */
+    int32 SectionNum = 0;
+
+    /** Records in this batch */
+    int32 Num = 0;
+
+    const uint8* Data = nullptr;
+
+public:
+    TConstArrayView<FVmdRawBoneRecord> GetBoneRecords() const { return GetRecords<FVmdRawBoneRecord>(EVmdSection::Bone); }
+    TConstArrayView<FVmdRawFaceRecord> GetFaceRecords() const { return GetRecords<FVmdRawFaceRecord>(EVmdSection::Face); }
+    TConstArrayView<FVmdRawCameraRecord> GetCameraRecords() const { return GetRecords<FVmdRawCameraRecord>(EVmdSection::Camera); }
+    TConstArrayView<FVmdRawLightRecord> GetLightRecords() const { return GetRecords<FVmdRawLightRecord>(EVmdSection::Light); }
+    TConstArrayView<FVmdRawSelfShadowRecord> GetSelfShadowRecords() const { return GetRecords<FVmdRawSelfShadowRecord>(EVmdSection::SelfShadow); }
+
+    FVmdIkRecordIterator GetIkRecords() const
+    {
+        check(Section == EVmdSection::Ik);
+        return FVmdIkRecordIterator(Data, Num);
+    }
+
+private:
+    template<typename RecordType>
+    TConstArrayView<RecordType> GetRecords(EVmdSection InExpected) const
+    {
+        check(Section == InExpected);
+        return TConstArrayView<RecordType>(reinterpret_cast<const RecordType*>(Data), Num);
+    }
+};
+
+/**
+ * Pull based vmd reader
+ * Reads records in fixed size batches through a reused buffer, memory usage does not grow with file size
+ *
+ * Usage:
+ *  FVmdStreamReader Reader;
+ *  Reader.Open(Path);
+ *  FVmdRecordBatch Batch;
+ *  while (Reader.ReadNextBatch(Batch)) { ... }
+ *  if (Reader.HasError()) { ... }
+ */
+class UEMMDHELPER_API FVmdStreamReader
+{
+public:
+    static constexpr int32 DefaultBatchSize = 64 * 1024;
+
+    explicit FVmdStreamReader(int32 InBatchSize = DefaultBatchSize);
+    ~FVmdStreamReader();
+
+    FVmdStreamReader(const FVmdStreamReader&) = delete;
+    FVmdStreamReader& operator=(const FVmdStreamReader&) = delete;
+
+    /**
+     * Open file and read header
+     *
+     * @param InFilePath Absolute path of vmd file
+     * @return False if file can not be opened or header check failed
+     */
+    bool Open(const FString& InFilePath);
+
+    /** Records of a skipped section are seeked over instead of read */
+    void SetSkipSection(EVmdSection InSection, bool bInSkip);
+
+    /**
+     * Read next batch of records
+     *
+     * @return False when all sections are read or an error happened
+     */
+    bool ReadNextBatch(FVmdRecordBatch& OutBatch);
+
+    /** Pump all remaining batches into consumer, consumer returns false to stop */
+    bool ForEachBatch(TFunctionRef<bool(const FVmdRecordBatch&)> InConsumer);
+
+    /** Result of layout check done while opening */
+    const FVmdValidationResult& GetValidation() const { return Validation; }
+
+    const FVmdRawHeader& GetHeader() const { return Header; }
+    bool HasError() const { return bError; }
+    int64 GetFileSize() const { return FileSize; }
+
+    /** Bytes consumed so far, can be used as progress */
+    int64 GetOffset() const { return Offset; }
+
+private:
+    /** Move to next section, skip it if requested */
+    bool BeginNextSection();
+
+    /** Read whole variable length ik records until batch size or buffer size is reached */
+    int32 ReadIkRecords(int32 InMaxNum);
+
+    bool ReadBytes(void* OutData, int64 InSize);
+
+private:
+    TUniquePtr<class IFileHandle> FileHandle;
+    int64 FileSize = 0;
+    int64 Offset = 0;
+
+    FVmdRawHeader Header;
+    FVmdValidationResult Validation;
+
+    int32 BatchSize = DefaultBatchSize;
+    TArray<uint8> Buffer;
+
+    EVmdSection CurrentSection = EVmdSection::Num;
+    int32 NextSectionIndex = 0;
+    int32 CurrentSectionNum = 0;
+    int32 CurrentSectionRead = 0;
+
+    uint32 SkipSectionMask = 0;
+    bool bError = false;
+};
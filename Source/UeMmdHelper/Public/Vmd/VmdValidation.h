@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Vmd/VmdRawRecords.h"
+#include "VmdCore/VmdLayout.h"
+
+class IFileHandle;
+
+/**
+ * Result of checking vmd layout before reading records
+ * Also holds where each section is when the file is valid
+ */
+struct UEMMDHELPER_API FVmdValidationResult : public VmdCore::FVmdLayout
+{
+public:
+    FString ToString() const;
+};
+
+namespace FVmdDataHelper
+{
+    /** Read InSize bytes at InOffset, returns false on failure */
+    using FVmdReadAt = TFunctionRef<bool(int64 InOffset, void* OutData, int64 InSize)>;
+
+    /**
+     * Check header and every section count against file size without reading records
+     * Engine side entry of VmdCore::ValidateLayout
+     */
+    FVmdValidationResult ValidateVmdLayout(int64 InFileSize, FVmdReadAt InReadAt);
+
+    FVmdValidationResult ValidateVmdMemory(const uint8* InData, int64 InSize);
+
+    /** Seeks around in file, position of handle is undefined afterwards */
+    FVmdValidationResult ValidateVmdFile(IFileHandle& InFileHandle);
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Interpolation curves of vmd keys
+ * A cubic bezier from (0, 0) to (1, 1) with two control points stored as bytes in [0, 127]
+ * It maps progress x in [0, 1] between two keys to eased progress y, the curve on a key eases the segment ending at it
+ */
+
+namespace VmdCore
+{
+    /** Channels of camera interpolation, in file order */
+    enum class ECameraCurve : int32_t
+    {
+        X,
+        Y,
+        Z,
+        Rotation,
+        Distance,
+        ViewAngle,
+
+        Num
+    };
+
+    /** Bytes of camera interpolation, 4 bytes x1 x2 y1 y2 for each channel */
+    static constexpr int32_t CameraInterpolationSize = (int32_t)ECameraCurve::Num * 4;
+
+    struct FBezierCurve
+    {
+        /** Coefficients of x(t) = ((Ax * t + Bx) * t + Cx) * t, and the same for y */
+        float Ax = 0.0f;
+        float Bx = 0.0f;
+        float Cx = 0.0f;
+        float Ay = 0.0f;
+        float By = 0.0f;
+        float Cy = 0.0f;
+
+        /** Control points on the diagonal, y equals x */
+        bool bLinear = true;
+
+        float SampleX(float InT) const { return ((Ax * InT + Bx) * InT + Cx) * InT; }
+        float SampleY(float InT) const { return ((Ay * InT + By) * InT + Cy) * InT; }
+        float SampleDerivX(float InT) const { return (3.0f * Ax * InT + 2.0f * Bx) * InT + Cx; }
+    };
+
+    FBezierCurve MakeBezierCurve(uint8_t InX1, uint8_t InY1, uint8_t InX2, uint8_t InY2);
+
+    /** Curve of a camera channel from the interpolation bytes of a camera key */
+    FBezierCurve MakeCameraCurve(const uint8_t* InInterpolation, ECameraCurve InChannel);
+
+    /** Curve of a bone channel, X, Y, Z or rotation, from the first 16 interpolation bytes of a bone key */
+    FBezierCurve MakeBoneCurve(const uint8_t* InInterpolation, int32_t InChannel);
+
+    /** Largest error of x(t) accepted by the solvers */
+    static constexpr float BezierSolveTolerance = 1.0e-6f;
+
+    /**
+     * Eased progress at InX, x(t) = InX is solved by Newton steps kept inside a shrinking bracket
+     * A step leaving the bracket or a flat derivative falls back to bisection, so iterations are bounded
+     */
+    float EvaluateBezier(const FBezierCurve& InCurve, float InX);
+
+    /** Bisection in double to full precision, reference for accuracy checks */
+    double EvaluateBezierReference(const FBezierCurve& InCurve, double InX);
+
+    /**
+     * Curve with t precomputed at uniform steps of x, for a segment sampled many times
+     * Evaluation starts the solve from t interpolated in the table, inside the bracket of its two entries, so it settles in a step or two
+     */
+    struct FBezierTable
+    {
+        static constexpr int32_t SampleNum = 16;
+
+        FBezierCurve Curve;
+        float T[SampleNum + 1] = {};
+
+        void Build(const FBezierCurve& InCurve);
+        float Evaluate(float InX) const;
+    };
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Camera conversion kernels on plain values
+ * Conventions follow the engine: rotator in degrees as pitch/yaw/roll, quaternions are hamilton with W last
+ */
+
+namespace VmdCore
+{
+    struct FVec3
+    {
+        double X = 0.0;
+        double Y = 0.0;
+        double Z = 0.0;
+    };
+
+    struct FQuat
+    {
+        double X = 0.0;
+        double Y = 0.0;
+        double Z = 0.0;
+        double W = 1.0;
+    };
+
+    struct FRigidTransform
+    {
+        FQuat Rotation;
+        FVec3 Translation;
+        FVec3 Scale = { 1.0, 1.0, 1.0 };
+    };
+
+    /** Same as FRotator::Quaternion */
+    FQuat QuatFromRotator(double InPitch, double InYaw, double InRoll);
+
+    FQuat Multiply(const FQuat& A, const FQuat& B);
+
+    FVec3 RotateVector(const FQuat& InQuat, const FVec3& InVector);
+
+    /** Vmd camera rotation in radians to engine rotator degrees, pitch axis is flipped */
+    FVec3 ConvertCameraRotation(float InRotateX, float InRotateY, float InRotateZ);
+
+    /**
+     * Camera transform of a vmd frame
+     * Offset and rotation are relative to base, camera is then moved along its forward by distance
+     */
+    FRigidTransform ConvertCameraTransform(const FRigidTransform& InBase, const FVec3& InOffset, const FVec3& InRotator, double InDistance);
+}
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Vmd file format, shared by the engine module and the engine independent core
+ * Only standard headers are allowed in VmdCore, it is built and profiled outside of the engine
+ */
+
+#include <cstdint>
+
+namespace VmdCore
+{
+    /** Same type as engine int64 on every platform, int64_t is long on LP64 linux */
+    using int64 = long long;
+}
+
+
+/** Sections of vmd file, in file order */
+enum class EVmdSection : uint8_t
+{
+    Bone,
+    Face,
+    Camera,
+
+    /** Trailing sections below are optional, older files end before them */
+    Light,
+    SelfShadow,
+    Ik,
+
+    Num
+};
+
+/** Sections before this are always present */
+static constexpr int32_t VmdRequiredSectionNum = (int32_t)EVmdSection::Light;
+
+
+//////////////////////////////////////////////////////////////////////////
+/**
+ * On-disk record layouts, used to read mapped file memory in place
+ * Members are unaligned, read them by value instead of taking their address
+ */
+
+#pragma pack(push, 1)
+struct FVmdRawHeader
+{
+    char MagicHeader[30];
+    char TargetModelName[20];
+};
+
+struct FVmdRawBoneRecord
+{
+    char Name[15];
+    uint32_t Frame;
+    float Position[3];
+    float Quaternion[4];
+
+    /** Only the first 16 bytes are meaningful, the rest are shifted copies */
+    uint8_t Interpolation[64];
+};
+
+struct FVmdRawFaceRecord
+{
+    char Name[15];
+    uint32_t Frame;
+    float Factor;
+};
+
+struct FVmdRawCameraRecord
+{
+    uint32_t Frame;
+    float Length;
+    float Location[3];
+    float Rotate[3];
+    uint8_t Interpolation[24];
+    uint32_t ViewingAngle;
+    uint8_t Perspective;
+};
+
+struct FVmdRawLightRecord
+{
+    uint32_t Frame;
+    float Color[3];
+    float Position[3];
+};
+
+struct FVmdRawSelfShadowRecord
+{
+    uint32_t Frame;
+    uint8_t Mode;
+    float Distance;
+};
+
+/** Ik records are variable length, this header is followed by IkCount FVmdRawIkInfo */
+struct FVmdRawIkRecord
+{
+    uint32_t Frame;
+    uint8_t Show;
+    uint32_t IkCount;
+};
+
+struct FVmdRawIkInfo
+{
+    char Name[20];
+    uint8_t Enable;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FVmdRawHeader) == 50, "Bad vmd header layout");
+static_assert(sizeof(FVmdRawBoneRecord) == 111, "Bad vmd bone record layout");
+static_assert(sizeof(FVmdRawFaceRecord) == 23, "Bad vmd face record layout");
+static_assert(sizeof(FVmdRawCameraRecord) == 61, "Bad vmd camera record layout");
+static_assert(sizeof(FVmdRawLightRecord) == 28, "Bad vmd light record layout");
+static_assert(sizeof(FVmdRawSelfShadowRecord) == 9, "Bad vmd self shadow record layout");
+static_assert(sizeof(FVmdRawIkRecord) == 9, "Bad vmd ik record layout");
+static_assert(sizeof(FVmdRawIkInfo) == 21, "Bad vmd ik info layout");
+
+
+/** Magic text at the start of vmd file, including its terminator */
+static constexpr char VmdMagicHeader[] = "Vocaloid Motion Data 0002";
+
+/** Bytes of one record in a section, 0 for variable length ik records */
+constexpr int32_t GetVmdRecordSize(EVmdSection InSection)
+{
+    return InSection == EVmdSection::Bone ? (int32_t)sizeof(FVmdRawBoneRecord)
+        : InSection == EVmdSection::Face ? (int32_t)sizeof(FVmdRawFaceRecord)
+        : InSection == EVmdSection::Camera ? (int32_t)sizeof(FVmdRawCameraRecord)
+        : InSection == EVmdSection::Light ? (int32_t)sizeof(FVmdRawLightRecord)
+        : InSection == EVmdSection::SelfShadow ? (int32_t)sizeof(FVmdRawSelfShadowRecord)
+        : 0;
+}
+
+/** Bytes of one ik record with its infos */
+constexpr VmdCore::int64 GetVmdIkRecordSize(uint32_t InIkCount)
+{
+    return sizeof(FVmdRawIkRecord) + (VmdCore::int64)InIkCount * sizeof(FVmdRawIkInfo);
+}
+
+/** Largest fixed record size, used to size batch buffers */
+static constexpr int32_t VmdMaxRecordSize = sizeof(FVmdRawBoneRecord);
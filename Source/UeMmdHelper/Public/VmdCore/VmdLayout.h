@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VmdCore/VmdFormat.h"
+
+
+enum class EVmdValidationError : uint8_t
+{
+    None,
+
+    /** File could not be read */
+    ReadFailed,
+
+    /** File is smaller than header */
+    TooSmall,
+
+    /** Magic header does not match */
+    BadMagic,
+
+    /** File ends before the count of a section */
+    MissingCount,
+
+    /** Count of a section is negative */
+    NegativeCount,
+
+    /** Records of a section run past the end of file */
+    SectionOverflow,
+};
+
+namespace VmdCore
+{
+    /**
+     * Where each section of a vmd file is
+     * Only meaningful when Error is None
+     */
+    struct FVmdLayout
+    {
+    public:
+        EVmdValidationError Error = EVmdValidationError::None;
+
+        /** Section the error happened in */
+        EVmdSection ErrorSection = EVmdSection::Num;
+
+        int64 FileSize = 0;
+
+        /** Offset of the first record of each section */
+        int64 SectionOffsets[(int32_t)EVmdSection::Num] = {};
+
+        /** Record count of each section, can be trusted after validation */
+        int32_t SectionCounts[(int32_t)EVmdSection::Num] = {};
+
+        /** Bytes of records of each section, not including the count */
+        int64 SectionBytes[(int32_t)EVmdSection::Num] = {};
+
+    public:
+        bool IsValid() const { return Error == EVmdValidationError::None; }
+        int32_t GetCount(EVmdSection InSection) const { return SectionCounts[(int32_t)InSection]; }
+        int64 GetOffset(EVmdSection InSection) const { return SectionOffsets[(int32_t)InSection]; }
+        int64 GetBytes(EVmdSection InSection) const { return SectionBytes[(int32_t)InSection]; }
+    };
+
+    /** Read InSize bytes at InOffset, returns false on failure */
+    using FReadAtFunc = bool(*)(void* InContext, int64 InOffset, void* OutData, int64 InSize);
+
+    /**
+     * Check header and every section count against file size without reading records
+     * Only header and counts are read, so broken files are rejected before anything is allocated
+     * Variable length ik records are walked by their own counts
+     */
+    void ValidateLayout(int64 InFileSize, FReadAtFunc InReadAt, void* InContext, FVmdLayout& OutLayout);
+
+    void ValidateMemory(const uint8_t* InData, int64 InSize, FVmdLayout& OutLayout);
+
+    /** Name of error for logging */
+    const char* GetErrorName(EVmdValidationError InError);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VmdCore/VmdLayout.h"
+
+#include <cassert>
+
+/**
+ * Records of a vmd file in memory, located from a validated layout
+ * Nothing is copied, pointers stay valid while the memory does
+ */
+
+namespace VmdCore
+{
+    /**
+     * Walks variable length ik records in contiguous memory
+     * Memory must be validated before, records are not bounds checked here
+     */
+    class FIkRecordIterator
+    {
+    public:
+        FIkRecordIterator(const uint8_t* InData, int32_t InNum)
+            : Data(InData)
+            , Remaining(InNum)
+        {
+        }
+
+        explicit operator bool() const { return Remaining > 0; }
+
+        const FVmdRawIkRecord& GetRecord() const { return *reinterpret_cast<const FVmdRawIkRecord*>(Data); }
+
+        uint32_t GetInfoNum() const { return GetRecord().IkCount; }
+        const FVmdRawIkInfo* GetInfoData() const { return reinterpret_cast<const FVmdRawIkInfo*>(Data + sizeof(FVmdRawIkRecord)); }
+
+        FIkRecordIterator& operator++()
+        {
+            Data += GetVmdIkRecordSize(GetInfoNum());
+            --Remaining;
+            return *this;
+        }
+
+    private:
+        const uint8_t* Data;
+        int32_t Remaining;
+    };
+
+    struct FRecordView
+    {
+    public:
+        FVmdLayout Layout;
+        const uint8_t* Data = nullptr;
+        const FVmdRawHeader* Header = nullptr;
+
+    public:
+        int32_t GetCount(EVmdSection InSection) const { return Layout.GetCount(InSection); }
+
+        /** First record of a fixed size section, GetCount records follow it */
+        template<typename RecordType>
+        const RecordType* GetRecords(EVmdSection InSection) const
+        {
+            assert(GetVmdRecordSize(InSection) == (int32_t)sizeof(RecordType));
+            return reinterpret_cast<const RecordType*>(Data + Layout.GetOffset(InSection));
+        }
+
+        FIkRecordIterator GetIkRecords() const { return FIkRecordIterator(Data + Layout.GetOffset(EVmdSection::Ik), GetCount(EVmdSection::Ik)); }
+    };
+
+    /**
+     * Validate layout of a whole file in memory and locate its sections
+     *
+     * @return False when layout check failed, OutView.Layout holds the error
+     */
+    bool ParseRecords(const uint8_t* InData, int64 InSize, FRecordView& OutView);
+}
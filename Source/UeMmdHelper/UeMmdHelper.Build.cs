@@ -41,6 +41,7 @@ public class UeMmdHelper : ModuleRules
                 "SlateCore",
                 "CinematicCamera",
                 "LevelSequence",
+                "Json",
                 // ... add private dependencies that you statically link with here ...	
             }
             );
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/**
+ * Microbenchmarks of VmdCore kernels outside of the engine
+ *
+ *  VmdCoreBench [Iterations] [Records]
+ */
+
+#include "VmdCore/VmdBezier.h"
+#include "VmdCore/VmdCameraMath.h"
+#include "VmdCore/VmdLayout.h"
+#include "VmdCore/VmdRecords.h"
+#include "SjisToUnicode.h"
+#include "VmdTestFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+    /** Average seconds of one run */
+    template<typename FuncType>
+    double TimeRuns(int32_t InIterations, FuncType&& InFunc)
+    {
+        InFunc();
+
+        const auto TsStart = std::chrono::steady_clock::now();
+        for (int32_t Idx = 0; Idx < InIterations; ++Idx)
+        {
+            InFunc();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - TsStart).count() / InIterations;
+    }
+
+    void Report(const char* InName, double InSeconds, double InItemNum, const char* InItemName)
+    {
+        std::printf("  %-24s %10.3f ms %10.2f ns/%s\n", InName, InSeconds * 1.0e3, InSeconds * 1.0e9 / InItemNum, InItemName);
+    }
+
+    /** Face names like a real motion in sjis, mostly double byte with some ascii and hankaku */
+    const char* const SampleNames[] = {
+        "\x82\xDC\x82\xCE\x82\xBD\x82\xAB", "\x8F\xCE\x82\xA2", "\x83\x45\x83\x42\x83\x93\x83\x4E",
+        "\x82\xA0", "\x82\xA2", "\x82\xA4", "\x82\xA6", "\x82\xA8", "\x82\xC9\x82\xE2\x82\xE8",
+        "\xB3\xA8\xDD\xB8\x82\x51", "\x94\xFB\x8F\xE3", "Blink_L",
+    };
+}
+
+int main(int InArgc, char** InArgv)
+{
+    const int32_t TiIterations = InArgc > 1 ? std::max(1, std::atoi(InArgv[1])) : 20;
+    const int32_t TiRecordNum = InArgc > 2 ? std::max(1, std::atoi(InArgv[2])) : 200000;
+
+    std::mt19937 TsRandom(1);
+    std::uniform_real_distribution<float> TsUnit(0.0f, 1.0f);
+
+    /** Synthetic file with face and ik records, validation walks every ik record */
+    FVmdTestFile TsFile;
+    TsFile.Faces.resize(TiRecordNum);
+    for (int32_t Idx = 0; Idx < TiRecordNum; ++Idx)
+    {
+        FVmdTestFile::SetName(TsFile.Faces[Idx].Name, SampleNames[Idx % (sizeof(SampleNames) / sizeof(SampleNames[0]))]);
+        TsFile.Faces[Idx].Frame = (uint32_t)Idx;
+        TsFile.Faces[Idx].Factor = TsUnit(TsRandom);
+    }
+    TsFile.Iks.resize(TiRecordNum / 10);
+    for (FVmdTestFile::FIkFrame& IterFrame : TsFile.Iks)
+    {
+        IterFrame.Infos.resize(4);
+    }
+    const std::vector<uint8_t> TsBytes = TsFile.Build();
+
+    std::printf("VmdCoreBench: iterations=%d records=%d bytes=%zu\n", TiIterations, TiRecordNum, TsBytes.size());
+
+    /** Sum of results keeps work from being optimized away */
+    double TfSink = 0.0;
+
+    const double TfValidateTime = TimeRuns(TiIterations, [&]()
+        {
+            VmdCore::FVmdLayout TsLayout;
+            VmdCore::ValidateMemory(TsBytes.data(), (VmdCore::int64)TsBytes.size(), TsLayout);
+            TfSink += (double)TsLayout.GetBytes(EVmdSection::Ik);
+        });
+    Report("ValidateMemory", TfValidateTime, (double)TsBytes.size(), "byte");
+
+    VmdCore::FRecordView TsView;
+    VmdCore::ParseRecords(TsBytes.data(), (VmdCore::int64)TsBytes.size(), TsView);
+    const FVmdRawFaceRecord* TpFaces = TsView.GetRecords<FVmdRawFaceRecord>(EVmdSection::Face);
+
+    std::vector<char16_t> TsNameBuffer(sizeof(FVmdRawFaceRecord::Name));
+    const double TfDecodeTime = TimeRuns(TiIterations, [&]()
+        {
+            for (int32_t Idx = 0; Idx < TiRecordNum; ++Idx)
+            {
+                TfSink += (double)saba::ConvertSjisToU16Buffer(TpFaces[Idx].Name, sizeof(FVmdRawFaceRecord::Name), TsNameBuffer.data(), TsNameBuffer.size());
+            }
+        });
+    Report("SjisDecode", TfDecodeTime, TiRecordNum, "name");
+
+    const double TfReferenceTime = TimeRuns(TiIterations, [&]()
+        {
+            char TsTerminated[sizeof(FVmdRawFaceRecord::Name) + 1] = {};
+            for (int32_t Idx = 0; Idx < TiRecordNum; ++Idx)
+            {
+                std::memcpy(TsTerminated, TpFaces[Idx].Name, sizeof(FVmdRawFaceRecord::Name));
+                TfSink += (double)saba::ConvertSjisToU16StringReference(TsTerminated).size();
+            }
+        });
+    Report("SjisDecodeReference", TfReferenceTime, TiRecordNum, "name");
+
+    std::vector<std::u16string> TsDecodedNames;
+    for (const char* IterName : SampleNames)
+    {
+        TsDecodedNames.push_back(saba::ConvertSjisToU16String(IterName));
+    }
+    const double TfEncodeTime = TimeRuns(TiIterations, [&]()
+        {
+            char TsField[sizeof(FVmdRawFaceRecord::Name)];
+            for (int32_t Idx = 0; Idx < TiRecordNum; ++Idx)
+            {
+                const std::u16string& TrName = TsDecodedNames[Idx % TsDecodedNames.size()];
+                TfSink += (double)saba::ConvertU16ToSjisBuffer(TrName.data(), TrName.size(), TsField, sizeof(TsField)).written;
+            }
+        });
+    Report("SjisEncode", TfEncodeTime, TiRecordNum, "name");
+
+    /** Camera keys of a long motion */
+    std::vector<VmdCore::FVec3> TsRotators(TiRecordNum);
+    for (VmdCore::FVec3& IterRotator : TsRotators)
+    {
+        IterRotator = VmdCore::ConvertCameraRotation(TsUnit(TsRandom) * 6.0f, TsUnit(TsRandom) * 6.0f, TsUnit(TsRandom) * 6.0f);
+    }
+    const VmdCore::FRigidTransform TsBase;
+    const double TfCameraTime = TimeRuns(TiIterations, [&]()
+        {
+            for (const VmdCore::FVec3& IterRotator : TsRotators)
+            {
+                TfSink += VmdCore::ConvertCameraTransform(TsBase, { 1.0, 2.0, 3.0 }, IterRotator, -45.0).Translation.X;
+            }
+        });
+    Report("ConvertCameraTransform", TfCameraTime, TiRecordNum, "frame");
+
+    /** Random curves at random progress, like baking many segments */
+    constexpr int32_t CurveNum = 1024;
+    std::uniform_int_distribution<int32_t> TsByte(0, 127);
+    std::vector<VmdCore::FBezierCurve> TsCurves;
+    std::vector<VmdCore::FBezierTable> TsTables(CurveNum);
+    for (int32_t Idx = 0; Idx < CurveNum; ++Idx)
+    {
+        TsCurves.push_back(VmdCore::MakeBezierCurve((uint8_t)TsByte(TsRandom), (uint8_t)TsByte(TsRandom), (uint8_t)TsByte(TsRandom), (uint8_t)TsByte(TsRandom)));
+        TsTables[Idx].Build(TsCurves.back());
+    }
+    std::vector<float> TsXs(TiRecordNum / CurveNum + 1);
+    for (float& IterX : TsXs)
+    {
+        IterX = TsUnit(TsRandom);
+    }
+
+    const double TfEvalNum = (double)CurveNum * TsXs.size();
+    const double TfBezierTime = TimeRuns(TiIterations, [&]()
+        {
+            for (const VmdCore::FBezierCurve& IterCurve : TsCurves)
+            {
+                for (const float IterX : TsXs)
+                {
+                    TfSink += VmdCore::EvaluateBezier(IterCurve, IterX);
+                }
+            }
+        });
+    Report("EvaluateBezier", TfBezierTime, TfEvalNum, "eval");
+
+    const double TfTableTime = TimeRuns(TiIterations, [&]()
+        {
+            for (const VmdCore::FBezierTable& IterTable : TsTables)
+            {
+                for (const float IterX : TsXs)
+                {
+                    TfSink += IterTable.Evaluate(IterX);
+                }
+            }
+        });
+    Report("FBezierTable::Evaluate", TfTableTime, TfEvalNum, "eval");
+
+    std::printf("  sink=%f\n", TfSink);
+    return 0;
+}
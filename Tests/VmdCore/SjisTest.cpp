@@ -0,0 +1,331 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SjisToUnicode.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+TEST(Sjis, DecodeNames)
+{
+    struct FCase
+    {
+        const char* Sjis;
+        const char16_t* Expected;
+    };
+
+    /** Bytes as written by MMD, double byte, hankaku and ascii */
+    const FCase TsCases[] = {
+        { "\x83\x5A\x83\x93\x83\x5E\x81\x5B", u"センター" },
+        { "\x8D\xB6\x91\xAB\x82\x68\x82\x6A", u"左足ＩＫ" },
+        { "\x82\xDC\x82\xCE\x82\xBD\x82\xAB", u"まばたき" },
+        { "\xB3\xA8\xDD\xB8", u"ｳｨﾝｸ" },
+        { "\x8F\x89\x89\xB9\x83\x7E\x83\x4E", u"初音ミク" },
+        { "Camera 01", u"Camera 01" },
+    };
+
+    for (const FCase& IterCase : TsCases)
+    {
+        EXPECT_EQ(saba::ConvertSjisToU16String(IterCase.Sjis), std::u16string(IterCase.Expected));
+    }
+}
+
+TEST(Sjis, DecodeFixedWidthField)
+{
+    /** A name filling a vmd field has no terminator, decode stops at the field width */
+    const char TsField[] = "\x89\x45\x98\x72\x9D\x80\x82\xEA\x90\xE6\x83\x7B\x81\x5B";
+    char16_t TsDecoded[16] = {};
+    size_t TiDecodedNum = saba::ConvertSjisToU16Buffer(TsField, sizeof(TsField) - 1, TsDecoded, 16);
+    EXPECT_EQ(std::u16string(TsDecoded, TiDecodedNum), u"右腕捩れ先ボー");
+
+    /** A shorter name ends at its terminator, padding after it is ignored */
+    const char TsPadded[15] = { 'B', 'o', 'n', 'e', '\0', 'x', 'y', 'z' };
+    TiDecodedNum = saba::ConvertSjisToU16Buffer(TsPadded, sizeof(TsPadded), TsDecoded, 16);
+    EXPECT_EQ(std::u16string(TsDecoded, TiDecodedNum), u"Bone");
+}
+
+namespace
+{
+    /** Encode then decode back, every char must have a code */
+    std::u16string RoundTrip(const std::u16string& InText)
+    {
+        size_t TiUnrepresentable = 0;
+        const std::string TstrSjis = saba::ConvertU16ToSjisString(InText, &TiUnrepresentable);
+        EXPECT_EQ(TiUnrepresentable, 0u);
+        return saba::ConvertSjisToU16String(TstrSjis.c_str());
+    }
+}
+
+TEST(Sjis, RoundTripNames)
+{
+    const std::u16string TsNames[] = {
+        u"センター",
+        u"左足ＩＫ",
+        u"まばたき",
+        u"あ",
+        u"ｳｨﾝｸ",
+        u"Camera 01",
+        u"上半身2",
+        u"初音ミク",
+    };
+
+    for (const std::u16string& IterName : TsNames)
+    {
+        EXPECT_EQ(RoundTrip(IterName), IterName);
+    }
+}
+
+TEST(Sjis, RoundTripEveryDoubleByteCode)
+{
+    /** A char reached by several codes encodes to one of them, which must decode to the same char */
+    int32_t TiCheckedNum = 0;
+    for (int32_t Lead = 0x81; Lead <= 0xEF; ++Lead)
+    {
+        for (int32_t Trail = 0x40; Trail <= 0xFC; ++Trail)
+        {
+            const char16_t TiChar = saba::ConvertSjisToU16Char((Lead << 8) | Trail);
+            if (TiChar == 0xFFFF || TiChar == 0)
+            {
+                continue;
+            }
+
+            const uint16_t TiCode = saba::ConvertU16ToSjisChar(TiChar);
+            ASSERT_NE(TiCode, 0) << "lead=" << Lead << " trail=" << Trail;
+            EXPECT_EQ(saba::ConvertSjisToU16Char(TiCode), TiChar) << "lead=" << Lead << " trail=" << Trail;
+            ++TiCheckedNum;
+        }
+    }
+    EXPECT_GT(TiCheckedNum, 7000);
+}
+
+TEST(Sjis, RoundTripFixedWidthField)
+{
+    /** Encoding a name longer than the 15 byte field truncates on a whole char */
+    char TsField[15];
+    const saba::SjisEncodeResult TsResult = saba::ConvertU16ToSjisBuffer(u"右腕捩れ先ボーン", 8, TsField, sizeof(TsField));
+    EXPECT_TRUE(TsResult.truncated);
+    EXPECT_EQ(TsResult.written, 14u);
+
+    char16_t TsDecoded[16] = {};
+    const size_t TiDecodedNum = saba::ConvertSjisToU16Buffer(TsField, TsResult.written, TsDecoded, 16);
+    EXPECT_EQ(std::u16string(TsDecoded, TiDecodedNum), u"右腕捩れ先ボー");
+}
+
+namespace
+{
+    /** Reference two pass decode of the first InLength bytes, stopping at a terminator like the buffer decode */
+    std::u16string DecodeReference(const std::vector<uint8_t>& InBytes, size_t InLength)
+    {
+        std::string TstrTerminated(reinterpret_cast<const char*>(InBytes.data()), InLength);
+        return saba::ConvertSjisToU16StringReference(TstrTerminated.c_str());
+    }
+
+    std::u16string DecodeBuffer(const std::vector<uint8_t>& InBytes, size_t InLength, size_t InOutLength)
+    {
+        std::u16string TsDecoded(InOutLength, u'\0');
+        TsDecoded.resize(saba::ConvertSjisToU16Buffer(reinterpret_cast<const char*>(InBytes.data()), InLength, TsDecoded.data(), InOutLength));
+        return TsDecoded;
+    }
+}
+
+TEST(SjisDecode, SingleByteRunsMatchReference)
+{
+    /** Every non zero single byte value at every position of the 16 and 8 byte vector paths and the scalar tail */
+    for (size_t Length = 1; Length <= 40; ++Length)
+    {
+        for (int32_t Value = 1; Value < 256; ++Value)
+        {
+            for (size_t Position = 0; Position < Length; ++Position)
+            {
+                std::vector<uint8_t> TsBytes(Length, 'a');
+                TsBytes[Position] = (uint8_t)Value;
+                ASSERT_EQ(DecodeBuffer(TsBytes, Length, Length), DecodeReference(TsBytes, Length))
+                    << "length=" << Length << " value=" << Value << " position=" << Position;
+            }
+        }
+    }
+}
+
+TEST(SjisDecode, RandomMixedTextMatchesReference)
+{
+    /** Ascii, hankaku, lead and trail bytes and invalid bytes mixed at random, no terminator inside */
+    const uint8_t TsPool[] = { 'A', 'z', '0', ' ', 0x7E, 0x7F, 0x80, 0xA0, 0xA1, 0xB1, 0xDF, 0xE0, 0x81, 0x82, 0x88, 0x9F, 0xEF, 0xF0, 0xFC, 0xFD, 0x40, 0x5C, 0xA0, 0x9F };
+    std::mt19937 TsRandom(7);
+    for (int32_t Round = 0; Round < 20000; ++Round)
+    {
+        const size_t TiLength = 1 + TsRandom() % 48;
+        std::vector<uint8_t> TsBytes(TiLength);
+        for (uint8_t& IterByte : TsBytes)
+        {
+            IterByte = TsPool[TsRandom() % sizeof(TsPool)];
+        }
+        ASSERT_EQ(DecodeBuffer(TsBytes, TiLength, TiLength), DecodeReference(TsBytes, TiLength)) << "round=" << Round;
+    }
+}
+
+TEST(SjisDecode, StopsAtTerminatorAndBounds)
+{
+    const std::vector<uint8_t> TsBytes = { 'a', 'b', 'c', 0, 'd', 'e' };
+    EXPECT_EQ(DecodeBuffer(TsBytes, TsBytes.size(), 16), u"abc");
+
+    /** Output shorter than input keeps a prefix, nothing is written past it */
+    std::vector<uint8_t> TsLong(32, 'x');
+    std::u16string TsDecoded(40, u'#');
+    const size_t TiDecodedNum = saba::ConvertSjisToU16Buffer(reinterpret_cast<const char*>(TsLong.data()), TsLong.size(), TsDecoded.data(), 20);
+    EXPECT_EQ(TiDecodedNum, 20u);
+    EXPECT_EQ(TsDecoded.substr(0, 20), std::u16string(20, u'x'));
+    EXPECT_EQ(TsDecoded.substr(20), std::u16string(20, u'#'));
+
+    /** Lead byte on the last byte has no trail inside the field */
+    const std::vector<uint8_t> TsCut = { 'a', 0x82 };
+    EXPECT_EQ(DecodeBuffer(TsCut, TsCut.size(), 16), DecodeReference(TsCut, TsCut.size()));
+}
+
+namespace
+{
+    /**
+     * Checksums of the decoder in the baseline tree, before the tables were paged
+     * Computed by building that SjisToUnicode.cpp alone and running the same loops as below
+     */
+    constexpr uint32_t BaselineCharChecksum = 0xFC850AA6;
+    constexpr uint32_t BaselinePairChecksum = 0x0A3360D7;
+
+    /** FNV-1a over both bytes of a char */
+    uint32_t MixChar(uint32_t InValue, char16_t InChar)
+    {
+        InValue = (InValue ^ uint8_t(InChar & 0xFF)) * 0x01000193u;
+        return (InValue ^ uint8_t(InChar >> 8)) * 0x01000193u;
+    }
+
+    uint32_t MixDecoded(uint32_t InValue, const char16_t* InChars, size_t InNum)
+    {
+        InValue = MixChar(InValue, char16_t(InNum));
+        for (size_t Idx = 0; Idx < InNum; ++Idx)
+        {
+            InValue = MixChar(InValue, InChars[Idx]);
+        }
+        return InValue;
+    }
+}
+
+TEST(SjisTable, ChecksumMatchesGenerator)
+{
+    /** Pages and checksum both come from SjisTableGen.py, this only catches one edited without the other */
+    EXPECT_TRUE(saba::VerifySjisTable());
+}
+
+TEST(SjisTable, MatchesBaselineDecoder)
+{
+    uint32_t TiCharChecksum = 0x811C9DC5;
+    for (int32_t Code = 0; Code < 0x10000; ++Code)
+    {
+        TiCharChecksum = MixChar(TiCharChecksum, saba::ConvertSjisToU16Char(Code));
+    }
+    EXPECT_EQ(TiCharChecksum, BaselineCharChecksum);
+
+    /** Every byte pair as a string, which also covers how many bytes each lead byte takes */
+    uint32_t TiStringChecksum = 0x811C9DC5;
+    uint32_t TiBufferChecksum = 0x811C9DC5;
+    for (int32_t First = 0; First < 256; ++First)
+    {
+        for (int32_t Second = 0; Second < 256; ++Second)
+        {
+            const char TsBytes[3] = { char(First), char(Second), 0 };
+            const std::u16string TsDecoded = saba::ConvertSjisToU16String(TsBytes);
+            TiStringChecksum = MixDecoded(TiStringChecksum, TsDecoded.data(), TsDecoded.size());
+
+            char16_t TsBuffer[4] = {};
+            const size_t TiDecodedNum = saba::ConvertSjisToU16Buffer(TsBytes, 2, TsBuffer, 4);
+            TiBufferChecksum = MixDecoded(TiBufferChecksum, TsBuffer, TiDecodedNum);
+        }
+    }
+    EXPECT_EQ(TiStringChecksum, BaselinePairChecksum);
+    EXPECT_EQ(TiBufferChecksum, BaselinePairChecksum);
+}
+
+TEST(SjisTable, KnownCodes)
+{
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x8140), u'　');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x82A0), u'あ');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x889F), u'亜');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0xEAA4), u'熙');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x8740), u'①');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0xE040), u'漾');
+
+    EXPECT_EQ(saba::ConvertSjisToU16Char('A'), u'A');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0xA1), u'｡');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0xDF), u'ﾟ');
+}
+
+TEST(SjisTable, PageBoundaries)
+{
+    /** Pages hold 32 trail bytes, codes on both sides of a page edge and the last trail of a lead */
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x815F), u'＼');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x8160), u'～');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x81FC), u'◯');
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x9FFC), u'滌');
+}
+
+TEST(SjisTable, UnassignedCodes)
+{
+    /** Empty rows share one page, bytes outside the lead and trail ranges have no char */
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x8240), char16_t(0xFFFF));
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0xFA40), char16_t(0xFFFF));
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x8100), char16_t(0xFFFF));
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0x80), char16_t(0xFFFF));
+    EXPECT_EQ(saba::ConvertSjisToU16Char(0xA0), char16_t(0xFFFF));
+}
+
+TEST(SjisEncode, CharCodes)
+{
+    EXPECT_EQ(saba::ConvertU16ToSjisChar(u'A'), 0x41);
+    EXPECT_EQ(saba::ConvertU16ToSjisChar(u'あ'), 0x82A0);
+    EXPECT_EQ(saba::ConvertU16ToSjisChar(u'｡'), 0xA1);
+    EXPECT_EQ(saba::ConvertU16ToSjisChar(u'熙'), 0xEAA4);
+
+    /** No code outside sjis, lone surrogates included */
+    EXPECT_EQ(saba::ConvertU16ToSjisChar(u'Ā'), 0);
+    EXPECT_EQ(saba::ConvertU16ToSjisChar(char16_t(0xD800)), 0);
+}
+
+TEST(SjisEncode, DoubleByteOrder)
+{
+    EXPECT_EQ(saba::ConvertU16ToSjisString(u"aあ"), std::string("a\x82\xA0"));
+}
+
+TEST(SjisEncode, Replacement)
+{
+    size_t TiUnrepresentable = 0;
+    EXPECT_EQ(saba::ConvertU16ToSjisString(u"aĀb", &TiUnrepresentable), "a?b");
+    EXPECT_EQ(TiUnrepresentable, 1u);
+
+    /** A surrogate pair is one char, written as one replacement */
+    char TsOut[8];
+    const saba::SjisEncodeResult TsResult = saba::ConvertU16ToSjisBuffer(u"x\U0001F600y", 4, TsOut, sizeof(TsOut), '_');
+    EXPECT_EQ(std::string(TsOut, TsResult.written), "x_y");
+    EXPECT_EQ(TsResult.consumed, 4u);
+    EXPECT_EQ(TsResult.unrepresentable, 1u);
+    EXPECT_FALSE(TsResult.truncated);
+}
+
+TEST(SjisEncode, DoubleByteNeverSplit)
+{
+    char TsOut[4] = { '#', '#', '#', '#' };
+    const saba::SjisEncodeResult TsResult = saba::ConvertU16ToSjisBuffer(u"aあい", 3, TsOut, 2);
+    EXPECT_TRUE(TsResult.truncated);
+    EXPECT_EQ(TsResult.written, 1u);
+    EXPECT_EQ(TsResult.consumed, 1u);
+    EXPECT_EQ(TsOut[1], '#');
+}
+
+TEST(SjisEncode, StopsAtTerminator)
+{
+    char TsOut[8];
+    const saba::SjisEncodeResult TsResult = saba::ConvertU16ToSjisBuffer(u"ab\0cd", 5, TsOut, sizeof(TsOut));
+    EXPECT_EQ(std::string(TsOut, TsResult.written), "ab");
+    EXPECT_EQ(TsResult.consumed, 2u);
+    EXPECT_FALSE(TsResult.truncated);
+}
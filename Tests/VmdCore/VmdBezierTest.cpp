@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdBezier.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+
+namespace
+{
+    /** Control bytes mixing both ends of the range with interior values */
+    const uint8_t ControlBytes[] = { 0, 1, 20, 64, 107, 126, 127 };
+
+    /** Error bound with x control points inside (0, 127), x(t) has no flat end there */
+    constexpr double InteriorTolerance = 5.0e-5;
+
+    /**
+     * Error bound with x control points at 0 or 127
+     * x(t) flattens at an end while y(t) does not, so the solver tolerance on x turns into a larger error on y
+     */
+    constexpr double ExtremeTolerance = 5.0e-4;
+
+    constexpr int32_t SampleNum = 256;
+
+    bool IsInterior(uint8_t InByte)
+    {
+        return InByte > 0 && InByte < 127;
+    }
+
+    void ExpectSameCurve(const VmdCore::FBezierCurve& InActual, const VmdCore::FBezierCurve& InExpected)
+    {
+        EXPECT_EQ(InActual.Ax, InExpected.Ax);
+        EXPECT_EQ(InActual.Bx, InExpected.Bx);
+        EXPECT_EQ(InActual.Cx, InExpected.Cx);
+        EXPECT_EQ(InActual.Ay, InExpected.Ay);
+        EXPECT_EQ(InActual.By, InExpected.By);
+        EXPECT_EQ(InActual.Cy, InExpected.Cy);
+        EXPECT_EQ(InActual.bLinear, InExpected.bLinear);
+    }
+}
+
+TEST(VmdBezier, EndpointsAreFixed)
+{
+    for (const uint8_t X1 : ControlBytes)
+    {
+        for (const uint8_t Y1 : ControlBytes)
+        {
+            for (const uint8_t X2 : ControlBytes)
+            {
+                for (const uint8_t Y2 : ControlBytes)
+                {
+                    const VmdCore::FBezierCurve TsCurve = VmdCore::MakeBezierCurve(X1, Y1, X2, Y2);
+                    VmdCore::FBezierTable TsTable;
+                    TsTable.Build(TsCurve);
+
+                    EXPECT_NEAR(VmdCore::EvaluateBezier(TsCurve, 0.0f), 0.0f, ExtremeTolerance);
+                    EXPECT_NEAR(VmdCore::EvaluateBezier(TsCurve, 1.0f), 1.0f, ExtremeTolerance);
+                    EXPECT_NEAR(TsTable.Evaluate(0.0f), 0.0f, ExtremeTolerance);
+                    EXPECT_NEAR(TsTable.Evaluate(1.0f), 1.0f, ExtremeTolerance);
+
+                    /** Progress outside the segment is clamped */
+                    EXPECT_EQ(VmdCore::EvaluateBezier(TsCurve, -0.5f), VmdCore::EvaluateBezier(TsCurve, 0.0f));
+                    EXPECT_EQ(VmdCore::EvaluateBezier(TsCurve, 1.5f), VmdCore::EvaluateBezier(TsCurve, 1.0f));
+                }
+            }
+        }
+    }
+}
+
+TEST(VmdBezier, LinearCurves)
+{
+    /** Control points on the diagonal, including the all zero bytes of keys without interpolation */
+    for (const uint8_t P1 : ControlBytes)
+    {
+        for (const uint8_t P2 : ControlBytes)
+        {
+            const VmdCore::FBezierCurve TsCurve = VmdCore::MakeBezierCurve(P1, P1, P2, P2);
+            ASSERT_TRUE(TsCurve.bLinear);
+
+            VmdCore::FBezierTable TsTable;
+            TsTable.Build(TsCurve);
+            for (int32_t Idx = 0; Idx <= SampleNum; ++Idx)
+            {
+                const float TfX = (float)Idx / SampleNum;
+                EXPECT_EQ(VmdCore::EvaluateBezier(TsCurve, TfX), TfX);
+                EXPECT_EQ(TsTable.Evaluate(TfX), TfX);
+                EXPECT_NEAR(VmdCore::EvaluateBezierReference(TsCurve, TfX), TfX, 1.0e-6);
+            }
+        }
+    }
+
+    EXPECT_FALSE(VmdCore::MakeBezierCurve(20, 0, 107, 127).bLinear);
+}
+
+TEST(VmdBezier, ControlPointGridMatchesReference)
+{
+    for (const uint8_t X1 : ControlBytes)
+    {
+        for (const uint8_t Y1 : ControlBytes)
+        {
+            for (const uint8_t X2 : ControlBytes)
+            {
+                for (const uint8_t Y2 : ControlBytes)
+                {
+                    const VmdCore::FBezierCurve TsCurve = VmdCore::MakeBezierCurve(X1, Y1, X2, Y2);
+                    VmdCore::FBezierTable TsTable;
+                    TsTable.Build(TsCurve);
+
+                    const double TfTolerance = IsInterior(X1) && IsInterior(X2) ? InteriorTolerance : ExtremeTolerance;
+                    for (int32_t Idx = 0; Idx <= SampleNum; ++Idx)
+                    {
+                        const float TfX = (float)Idx / SampleNum;
+                        const double TfExpected = VmdCore::EvaluateBezierReference(TsCurve, TfX);
+                        ASSERT_NEAR(VmdCore::EvaluateBezier(TsCurve, TfX), TfExpected, TfTolerance)
+                            << "curve=" << (int32_t)X1 << "," << (int32_t)Y1 << "," << (int32_t)X2 << "," << (int32_t)Y2 << " x=" << TfX;
+                        ASSERT_NEAR(TsTable.Evaluate(TfX), TfExpected, TfTolerance)
+                            << "curve=" << (int32_t)X1 << "," << (int32_t)Y1 << "," << (int32_t)X2 << "," << (int32_t)Y2 << " x=" << TfX;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(VmdBezier, RandomCurvesMatchReference)
+{
+    std::mt19937 TsRandom(7);
+    std::uniform_int_distribution<int32_t> TsByte(0, 127);
+    std::uniform_real_distribution<float> TsUnit(0.0f, 1.0f);
+
+    for (int32_t Round = 0; Round < 2000; ++Round)
+    {
+        const uint8_t TsBytes[4] = { (uint8_t)TsByte(TsRandom), (uint8_t)TsByte(TsRandom), (uint8_t)TsByte(TsRandom), (uint8_t)TsByte(TsRandom) };
+        const VmdCore::FBezierCurve TsCurve = VmdCore::MakeBezierCurve(TsBytes[0], TsBytes[1], TsBytes[2], TsBytes[3]);
+        VmdCore::FBezierTable TsTable;
+        TsTable.Build(TsCurve);
+
+        const double TfTolerance = IsInterior(TsBytes[0]) && IsInterior(TsBytes[2]) ? InteriorTolerance : ExtremeTolerance;
+        for (int32_t Sample = 0; Sample < 16; ++Sample)
+        {
+            const float TfX = TsUnit(TsRandom);
+            const double TfExpected = VmdCore::EvaluateBezierReference(TsCurve, TfX);
+            ASSERT_NEAR(VmdCore::EvaluateBezier(TsCurve, TfX), TfExpected, TfTolerance) << "round=" << Round << " x=" << TfX;
+            ASSERT_NEAR(TsTable.Evaluate(TfX), TfExpected, TfTolerance) << "round=" << Round << " x=" << TfX;
+        }
+    }
+}
+
+TEST(VmdBezier, CameraCurveByteOrder)
+{
+    /** Each camera channel is 4 bytes x1 x2 y1 y2 */
+    uint8_t TsBytes[VmdCore::CameraInterpolationSize];
+    for (int32_t Idx = 0; Idx < VmdCore::CameraInterpolationSize; ++Idx)
+    {
+        TsBytes[Idx] = (uint8_t)(Idx * 5 + 3);
+    }
+
+    for (int32_t Channel = 0; Channel < (int32_t)VmdCore::ECameraCurve::Num; ++Channel)
+    {
+        const uint8_t* TpBytes = TsBytes + Channel * 4;
+        ExpectSameCurve(VmdCore::MakeCameraCurve(TsBytes, (VmdCore::ECameraCurve)Channel),
+            VmdCore::MakeBezierCurve(TpBytes[0], TpBytes[2], TpBytes[1], TpBytes[3]));
+    }
+
+    /** Only the distance channel is eased here, the others stay linear */
+    uint8_t TsDistance[VmdCore::CameraInterpolationSize] = {};
+    const int32_t TiDistance = (int32_t)VmdCore::ECameraCurve::Distance * 4;
+    TsDistance[TiDistance + 0] = 100;
+    TsDistance[TiDistance + 1] = 27;
+    TsDistance[TiDistance + 2] = 10;
+    TsDistance[TiDistance + 3] = 117;
+    ExpectSameCurve(VmdCore::MakeCameraCurve(TsDistance, VmdCore::ECameraCurve::Distance), VmdCore::MakeBezierCurve(100, 10, 27, 117));
+    EXPECT_TRUE(VmdCore::MakeCameraCurve(TsDistance, VmdCore::ECameraCurve::X).bLinear);
+    EXPECT_TRUE(VmdCore::MakeCameraCurve(TsDistance, VmdCore::ECameraCurve::ViewAngle).bLinear);
+}
+
+TEST(VmdBezier, BoneCurveByteOrder)
+{
+    /** The first 16 bone bytes are x1 of X Y Z R, then y1, x2 and y2 of the same channels */
+    uint8_t TsBytes[16];
+    for (int32_t Idx = 0; Idx < 16; ++Idx)
+    {
+        TsBytes[Idx] = (uint8_t)(Idx * 7 + 2);
+    }
+
+    for (int32_t Channel = 0; Channel < 4; ++Channel)
+    {
+        ExpectSameCurve(VmdCore::MakeBoneCurve(TsBytes, Channel),
+            VmdCore::MakeBezierCurve(TsBytes[Channel], TsBytes[4 + Channel], TsBytes[8 + Channel], TsBytes[12 + Channel]));
+    }
+}
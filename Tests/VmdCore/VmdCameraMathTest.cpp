@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdCameraMath.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+
+namespace
+{
+    constexpr double Tolerance = 1.0e-9;
+
+    void ExpectVector(const VmdCore::FVec3& InActual, double InX, double InY, double InZ)
+    {
+        EXPECT_NEAR(InActual.X, InX, Tolerance);
+        EXPECT_NEAR(InActual.Y, InY, Tolerance);
+        EXPECT_NEAR(InActual.Z, InZ, Tolerance);
+    }
+
+    /** Same rotation, q and -q included */
+    void ExpectSameRotation(const VmdCore::FQuat& A, const VmdCore::FQuat& B)
+    {
+        const double TfDot = A.X * B.X + A.Y * B.Y + A.Z * B.Z + A.W * B.W;
+        EXPECT_NEAR(std::fabs(TfDot), 1.0, Tolerance);
+    }
+}
+
+TEST(VmdCameraMath, ZeroRotatorIsIdentity)
+{
+    const VmdCore::FQuat TsQuat = VmdCore::QuatFromRotator(0.0, 0.0, 0.0);
+    EXPECT_NEAR(TsQuat.W, 1.0, Tolerance);
+    ExpectVector(VmdCore::RotateVector(TsQuat, { 1.0, 2.0, 3.0 }), 1.0, 2.0, 3.0);
+}
+
+TEST(VmdCameraMath, RotatorAxesFollowEngine)
+{
+    /** Yaw turns forward towards +Y and pitch towards +Z, roll turns right towards -Z like FRotationMatrix */
+    ExpectVector(VmdCore::RotateVector(VmdCore::QuatFromRotator(0.0, 90.0, 0.0), { 1.0, 0.0, 0.0 }), 0.0, 1.0, 0.0);
+    ExpectVector(VmdCore::RotateVector(VmdCore::QuatFromRotator(90.0, 0.0, 0.0), { 1.0, 0.0, 0.0 }), 0.0, 0.0, 1.0);
+    ExpectVector(VmdCore::RotateVector(VmdCore::QuatFromRotator(0.0, 0.0, 90.0), { 0.0, 1.0, 0.0 }), 0.0, 0.0, -1.0);
+}
+
+TEST(VmdCameraMath, WindingIsRemoved)
+{
+    ExpectSameRotation(VmdCore::QuatFromRotator(0.0, 450.0, 0.0), VmdCore::QuatFromRotator(0.0, 90.0, 0.0));
+    ExpectSameRotation(VmdCore::QuatFromRotator(-720.0, 30.0, 370.0), VmdCore::QuatFromRotator(0.0, 30.0, 10.0));
+}
+
+TEST(VmdCameraMath, MultiplyComposes)
+{
+    const VmdCore::FQuat TsComposed = VmdCore::Multiply(VmdCore::QuatFromRotator(0.0, 30.0, 0.0), VmdCore::QuatFromRotator(0.0, 60.0, 0.0));
+    ExpectSameRotation(TsComposed, VmdCore::QuatFromRotator(0.0, 90.0, 0.0));
+
+    /** B is applied first, like FQuat operator* */
+    const VmdCore::FQuat TsYaw = VmdCore::QuatFromRotator(0.0, 90.0, 0.0);
+    const VmdCore::FQuat TsPitch = VmdCore::QuatFromRotator(90.0, 0.0, 0.0);
+    ExpectVector(VmdCore::RotateVector(VmdCore::Multiply(TsYaw, TsPitch), { 1.0, 0.0, 0.0 }), 0.0, 0.0, 1.0);
+    ExpectVector(VmdCore::RotateVector(VmdCore::Multiply(TsPitch, TsYaw), { 1.0, 0.0, 0.0 }), 0.0, 1.0, 0.0);
+}
+
+TEST(VmdCameraMath, RotateKeepsLength)
+{
+    const VmdCore::FQuat TsQuat = VmdCore::QuatFromRotator(12.0, -73.0, 151.0);
+    const VmdCore::FVec3 TsRotated = VmdCore::RotateVector(TsQuat, { 3.0, -4.0, 12.0 });
+    EXPECT_NEAR(std::sqrt(TsRotated.X * TsRotated.X + TsRotated.Y * TsRotated.Y + TsRotated.Z * TsRotated.Z), 13.0, Tolerance);
+}
+
+TEST(VmdCameraMath, CameraRotationFlipsPitch)
+{
+    const float TfHalfPi = 1.5707963267948966f;
+    const VmdCore::FVec3 TsRotator = VmdCore::ConvertCameraRotation(TfHalfPi, -TfHalfPi, 2.0f * TfHalfPi);
+    EXPECT_NEAR(TsRotator.X, -90.0, 1.0e-4);
+    EXPECT_NEAR(TsRotator.Y, -90.0, 1.0e-4);
+    EXPECT_NEAR(TsRotator.Z, 180.0, 1.0e-4);
+}
+
+TEST(VmdCameraMath, CameraTransformMovesAlongForward)
+{
+    const VmdCore::FRigidTransform TsBase;
+    const VmdCore::FRigidTransform TsCamera = VmdCore::ConvertCameraTransform(TsBase, { 1.0, 2.0, 3.0 }, { 0.0, 0.0, 0.0 }, 10.0);
+    ExpectVector(TsCamera.Translation, 11.0, 2.0, 3.0);
+
+    const VmdCore::FRigidTransform TsTurned = VmdCore::ConvertCameraTransform(TsBase, { 0.0, 0.0, 0.0 }, { 0.0, 90.0, 0.0 }, -5.0);
+    ExpectVector(TsTurned.Translation, 0.0, -5.0, 0.0);
+}
+
+TEST(VmdCameraMath, CameraTransformIsRelativeToBase)
+{
+    VmdCore::FRigidTransform TsBase;
+    TsBase.Rotation = VmdCore::QuatFromRotator(0.0, 90.0, 0.0);
+    TsBase.Translation = { 100.0, 0.0, 50.0 };
+    TsBase.Scale = { 2.0, 2.0, 2.0 };
+
+    /** Offset is scaled and turned by base, then forward of the combined rotation is base forward */
+    const VmdCore::FRigidTransform TsCamera = VmdCore::ConvertCameraTransform(TsBase, { 1.0, 0.0, 0.0 }, { 0.0, 0.0, 0.0 }, 10.0);
+    ExpectVector(TsCamera.Translation, 100.0, 12.0, 50.0);
+    ExpectSameRotation(TsCamera.Rotation, TsBase.Rotation);
+}
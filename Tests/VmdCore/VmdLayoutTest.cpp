@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VmdCore/VmdLayout.h"
+#include "VmdCore/VmdRecords.h"
+#include "VmdTestFile.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+
+namespace
+{
+    FVmdTestFile MakeFullFile()
+    {
+        FVmdTestFile TsFile;
+
+        TsFile.Bones.resize(3);
+        for (size_t Idx = 0; Idx < TsFile.Bones.size(); ++Idx)
+        {
+            FVmdTestFile::SetName(TsFile.Bones[Idx].Name, "Bone");
+            TsFile.Bones[Idx].Frame = (uint32_t)Idx * 10;
+        }
+
+        TsFile.Faces.resize(2);
+        FVmdTestFile::SetName(TsFile.Faces[0].Name, "Face");
+        TsFile.Faces[0].Factor = 0.25f;
+        TsFile.Faces[1].Frame = 7;
+
+        TsFile.Cameras.resize(1);
+        TsFile.Cameras[0].Length = -45.0f;
+        TsFile.Lights.resize(2);
+        TsFile.SelfShadows.resize(1);
+
+        TsFile.Iks.resize(3);
+        TsFile.Iks[0].Record.Frame = 1;
+        TsFile.Iks[0].Infos.resize(2);
+        FVmdTestFile::SetName(TsFile.Iks[0].Infos[1].Name, "LegIK");
+        TsFile.Iks[0].Infos[1].Enable = 1;
+        TsFile.Iks[1].Record.Frame = 2;
+        TsFile.Iks[2].Record.Frame = 3;
+        TsFile.Iks[2].Infos.resize(1);
+        return TsFile;
+    }
+
+    VmdCore::FVmdLayout Validate(const std::vector<uint8_t>& InBytes)
+    {
+        VmdCore::FVmdLayout TsLayout;
+        VmdCore::ValidateMemory(InBytes.data(), (VmdCore::int64)InBytes.size(), TsLayout);
+        return TsLayout;
+    }
+
+    /** Offset of the count of a section in a file built from MakeFullFile */
+    VmdCore::int64 GetCountOffset(const std::vector<uint8_t>& InBytes, EVmdSection InSection)
+    {
+        return Validate(InBytes).GetOffset(InSection) - (VmdCore::int64)sizeof(int32_t);
+    }
+
+    void WriteCount(std::vector<uint8_t>& InOutBytes, VmdCore::int64 InOffset, int32_t InCount)
+    {
+        std::memcpy(InOutBytes.data() + InOffset, &InCount, sizeof(InCount));
+    }
+}
+
+TEST(VmdLayout, FullFile)
+{
+    const FVmdTestFile TsFile = MakeFullFile();
+    const std::vector<uint8_t> TsBytes = TsFile.Build();
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+
+    ASSERT_TRUE(TsLayout.IsValid()) << VmdCore::GetErrorName(TsLayout.Error);
+    EXPECT_EQ(TsLayout.FileSize, (VmdCore::int64)TsBytes.size());
+
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::Bone), 3);
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::Face), 2);
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::Camera), 1);
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::Light), 2);
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::SelfShadow), 1);
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::Ik), 3);
+
+    EXPECT_EQ(TsLayout.GetOffset(EVmdSection::Bone), (VmdCore::int64)(sizeof(FVmdRawHeader) + sizeof(int32_t)));
+    EXPECT_EQ(TsLayout.GetBytes(EVmdSection::Bone), 3 * (VmdCore::int64)sizeof(FVmdRawBoneRecord));
+    EXPECT_EQ(TsLayout.GetOffset(EVmdSection::Face), TsLayout.GetOffset(EVmdSection::Bone) + TsLayout.GetBytes(EVmdSection::Bone) + (VmdCore::int64)sizeof(int32_t));
+    EXPECT_EQ(TsLayout.GetBytes(EVmdSection::Ik), GetVmdIkRecordSize(2) + GetVmdIkRecordSize(0) + GetVmdIkRecordSize(1));
+    EXPECT_EQ(TsLayout.GetOffset(EVmdSection::Ik) + TsLayout.GetBytes(EVmdSection::Ik), (VmdCore::int64)TsBytes.size());
+}
+
+TEST(VmdLayout, OlderFileWithoutOptionalSections)
+{
+    const std::vector<uint8_t> TsBytes = MakeFullFile().Build(VmdRequiredSectionNum);
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+
+    ASSERT_TRUE(TsLayout.IsValid()) << VmdCore::GetErrorName(TsLayout.Error);
+    EXPECT_EQ(TsLayout.GetCount(EVmdSection::Camera), 1);
+    for (int32_t Section = VmdRequiredSectionNum; Section < (int32_t)EVmdSection::Num; ++Section)
+    {
+        EXPECT_EQ(TsLayout.GetCount((EVmdSection)Section), 0);
+        EXPECT_EQ(TsLayout.GetBytes((EVmdSection)Section), 0);
+        EXPECT_EQ(TsLayout.GetOffset((EVmdSection)Section), (VmdCore::int64)TsBytes.size());
+    }
+}
+
+TEST(VmdLayout, TooSmall)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    TsBytes.resize(sizeof(FVmdRawHeader) - 1);
+    EXPECT_EQ(Validate(TsBytes).Error, EVmdValidationError::TooSmall);
+}
+
+TEST(VmdLayout, BadMagic)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    TsBytes[21] = '1';
+    EXPECT_EQ(Validate(TsBytes).Error, EVmdValidationError::BadMagic);
+}
+
+TEST(VmdLayout, MissingRequiredCount)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    TsBytes.resize((size_t)GetCountOffset(TsBytes, EVmdSection::Face) + 2);
+
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+    EXPECT_EQ(TsLayout.Error, EVmdValidationError::MissingCount);
+    EXPECT_EQ(TsLayout.ErrorSection, EVmdSection::Face);
+}
+
+TEST(VmdLayout, NegativeCount)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    WriteCount(TsBytes, GetCountOffset(TsBytes, EVmdSection::Camera), -1);
+
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+    EXPECT_EQ(TsLayout.Error, EVmdValidationError::NegativeCount);
+    EXPECT_EQ(TsLayout.ErrorSection, EVmdSection::Camera);
+}
+
+TEST(VmdLayout, CountPastEndOfFile)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    WriteCount(TsBytes, GetCountOffset(TsBytes, EVmdSection::Bone), 0x7FFFFFFF);
+
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+    EXPECT_EQ(TsLayout.Error, EVmdValidationError::SectionOverflow);
+    EXPECT_EQ(TsLayout.ErrorSection, EVmdSection::Bone);
+}
+
+TEST(VmdLayout, HostileIkInfoCount)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    const VmdCore::int64 TiIkOffset = Validate(TsBytes).GetOffset(EVmdSection::Ik);
+    const uint32_t TiIkCount = 0xFFFFFFFFu;
+    std::memcpy(TsBytes.data() + TiIkOffset + offsetof(FVmdRawIkRecord, IkCount), &TiIkCount, sizeof(TiIkCount));
+
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+    EXPECT_EQ(TsLayout.Error, EVmdValidationError::SectionOverflow);
+    EXPECT_EQ(TsLayout.ErrorSection, EVmdSection::Ik);
+}
+
+TEST(VmdLayout, TruncatedIkRecord)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    TsBytes.pop_back();
+
+    const VmdCore::FVmdLayout TsLayout = Validate(TsBytes);
+    EXPECT_EQ(TsLayout.Error, EVmdValidationError::SectionOverflow);
+    EXPECT_EQ(TsLayout.ErrorSection, EVmdSection::Ik);
+}
+
+TEST(VmdLayout, ReadFailed)
+{
+    const std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+
+    VmdCore::FVmdLayout TsLayout;
+    VmdCore::ValidateLayout((VmdCore::int64)TsBytes.size(), [](void*, VmdCore::int64, void*, VmdCore::int64) { return false; }, nullptr, TsLayout);
+    EXPECT_EQ(TsLayout.Error, EVmdValidationError::ReadFailed);
+}
+
+TEST(VmdRecords, ParseLocatesRecords)
+{
+    const FVmdTestFile TsFile = MakeFullFile();
+    const std::vector<uint8_t> TsBytes = TsFile.Build();
+
+    VmdCore::FRecordView TsView;
+    ASSERT_TRUE(VmdCore::ParseRecords(TsBytes.data(), (VmdCore::int64)TsBytes.size(), TsView));
+    EXPECT_STREQ(TsView.Header->TargetModelName, "TestModel");
+
+    const FVmdRawBoneRecord* TpBones = TsView.GetRecords<FVmdRawBoneRecord>(EVmdSection::Bone);
+    ASSERT_EQ(TsView.GetCount(EVmdSection::Bone), 3);
+    EXPECT_EQ((uint32_t)TpBones[2].Frame, 20u);
+    EXPECT_STREQ(TpBones[0].Name, "Bone");
+
+    const FVmdRawFaceRecord* TpFaces = TsView.GetRecords<FVmdRawFaceRecord>(EVmdSection::Face);
+    EXPECT_EQ((float)TpFaces[0].Factor, 0.25f);
+    EXPECT_EQ((uint32_t)TpFaces[1].Frame, 7u);
+
+    const FVmdRawCameraRecord* TpCameras = TsView.GetRecords<FVmdRawCameraRecord>(EVmdSection::Camera);
+    EXPECT_EQ((float)TpCameras[0].Length, -45.0f);
+}
+
+TEST(VmdRecords, IkIteratorWalksVariableRecords)
+{
+    const FVmdTestFile TsFile = MakeFullFile();
+    const std::vector<uint8_t> TsBytes = TsFile.Build();
+
+    VmdCore::FRecordView TsView;
+    ASSERT_TRUE(VmdCore::ParseRecords(TsBytes.data(), (VmdCore::int64)TsBytes.size(), TsView));
+
+    size_t TiIndex = 0;
+    for (VmdCore::FIkRecordIterator IterRecord = TsView.GetIkRecords(); IterRecord; ++IterRecord, ++TiIndex)
+    {
+        ASSERT_LT(TiIndex, TsFile.Iks.size());
+        EXPECT_EQ((uint32_t)IterRecord.GetRecord().Frame, (uint32_t)TsFile.Iks[TiIndex].Record.Frame);
+        EXPECT_EQ(IterRecord.GetInfoNum(), (uint32_t)TsFile.Iks[TiIndex].Infos.size());
+    }
+    EXPECT_EQ(TiIndex, TsFile.Iks.size());
+
+    const VmdCore::FIkRecordIterator TsFirst = TsView.GetIkRecords();
+    EXPECT_STREQ(TsFirst.GetInfoData()[1].Name, "LegIK");
+    EXPECT_EQ((int32_t)TsFirst.GetInfoData()[1].Enable, 1);
+}
+
+TEST(VmdRecords, ParseRejectsBrokenFile)
+{
+    std::vector<uint8_t> TsBytes = MakeFullFile().Build();
+    TsBytes[0] = 'X';
+
+    VmdCore::FRecordView TsView;
+    EXPECT_FALSE(VmdCore::ParseRecords(TsBytes.data(), (VmdCore::int64)TsBytes.size(), TsView));
+    EXPECT_EQ(TsView.Layout.Error, EVmdValidationError::BadMagic);
+    EXPECT_EQ(TsView.Header, nullptr);
+}
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "VmdCore/VmdFormat.h"
+
+#include <cstring>
+#include <vector>
+
+/**
+ * Vmd files written in memory for tests and benchmarks
+ * Sections are written in file order, InSectionNum below EVmdSection::Num writes an older file without the trailing sections
+ */
+struct FVmdTestFile
+{
+public:
+    struct FIkFrame
+    {
+        FVmdRawIkRecord Record = {};
+        std::vector<FVmdRawIkInfo> Infos;
+    };
+
+    std::vector<FVmdRawBoneRecord> Bones;
+    std::vector<FVmdRawFaceRecord> Faces;
+    std::vector<FVmdRawCameraRecord> Cameras;
+    std::vector<FVmdRawLightRecord> Lights;
+    std::vector<FVmdRawSelfShadowRecord> SelfShadows;
+    std::vector<FIkFrame> Iks;
+
+public:
+    std::vector<uint8_t> Build(int32_t InSectionNum = (int32_t)EVmdSection::Num) const
+    {
+        std::vector<uint8_t> TsBytes;
+
+        FVmdRawHeader TsHeader = {};
+        std::memcpy(TsHeader.MagicHeader, VmdMagicHeader, sizeof(VmdMagicHeader));
+        std::memcpy(TsHeader.TargetModelName, "TestModel", sizeof("TestModel"));
+        Append(TsBytes, TsHeader);
+
+        const int32_t TiSectionNum = InSectionNum < (int32_t)EVmdSection::Num ? InSectionNum : (int32_t)EVmdSection::Num;
+        for (int32_t Section = 0; Section < TiSectionNum; ++Section)
+        {
+            switch ((EVmdSection)Section)
+            {
+            case EVmdSection::Bone: AppendSection(TsBytes, Bones); break;
+            case EVmdSection::Face: AppendSection(TsBytes, Faces); break;
+            case EVmdSection::Camera: AppendSection(TsBytes, Cameras); break;
+            case EVmdSection::Light: AppendSection(TsBytes, Lights); break;
+            case EVmdSection::SelfShadow: AppendSection(TsBytes, SelfShadows); break;
+            default:
+                Append(TsBytes, (int32_t)Iks.size());
+                for (const FIkFrame& IterFrame : Iks)
+                {
+                    FVmdRawIkRecord TsRecord = IterFrame.Record;
+                    TsRecord.IkCount = (uint32_t)IterFrame.Infos.size();
+                    Append(TsBytes, TsRecord);
+                    for (const FVmdRawIkInfo& IterInfo : IterFrame.Infos)
+                    {
+                        Append(TsBytes, IterInfo);
+                    }
+                }
+                break;
+            }
+        }
+        return TsBytes;
+    }
+
+    template<typename ValueType>
+    static void Append(std::vector<uint8_t>& OutBytes, const ValueType& InValue)
+    {
+        const uint8_t* TpValue = reinterpret_cast<const uint8_t*>(&InValue);
+        OutBytes.insert(OutBytes.end(), TpValue, TpValue + sizeof(ValueType));
+    }
+
+    template<typename RecordType>
+    static void AppendSection(std::vector<uint8_t>& OutBytes, const std::vector<RecordType>& InRecords)
+    {
+        Append(OutBytes, (int32_t)InRecords.size());
+        for (const RecordType& IterRecord : InRecords)
+        {
+            Append(OutBytes, IterRecord);
+        }
+    }
+
+    /** Name field terminated and padded with zeros, a name of the full field width has no terminator */
+    template<size_t Size>
+    static void SetName(char (&OutName)[Size], const char* InName)
+    {
+        std::memset(OutName, 0, Size);
+        std::strncpy(OutName, InName, Size);
+    }
+};